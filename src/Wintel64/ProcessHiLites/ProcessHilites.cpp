@@ -1,279 +1,563 @@
-//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
-//                                     All rights reserved.
-
-//                                     License Agreement
-//                                For VideoSpeedTracker (VST)
-//                                 (3 - clause BSD License)
-
-// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
-// conditions are met :
-
-// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
-// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
-//      in the documentation and / or other materials provided with the distribution.
-// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-
-// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
-// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
-// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
-// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
-// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
-// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
-//
-
-//  Run this code on output highlights file of VideoSpeedTracker.  The program produces highlights of highlights as edited by the user.
-// Output is placed in subdirectory "forPosting"  with the prefix "for_post" prepended to the input file name.
-
-
-#include <opencv\cv.h>
-#include "opencv2\highgui\highgui.hpp"
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-
-#define CVBlack 0,0,0
-#define CVCyan 255,255,153
-
-using namespace std;
-using namespace cv;
-
-VideoCapture hiLiteVideoIn;  //Input hiLites video
-VideoWriter hiLiteVideoOut; // For writing highlights...the edited Scofflaws
-Mat frames[200];
-const int maxFramePtr = 199;
-int framePTR = 0;
-ifstream filesList;
-string fileName;  // Name of avi file currently being processed.
-int leftSide = 320;  // These values are very specific to the setup used in program trafficReports.   ***********************************
-int top = 120;  // It woould be better to have these passed in as parameters from the trafficReports program.   **********************
-
-string inLine, lhs, rhs;
-string dataPathPrefix;
-
-
-bool getSides(string inLine){
-	string tempLHS, tempRHS;
-	istringstream configLine(inLine);
-	getline(configLine, tempLHS, '=');
-	getline(configLine, tempRHS, '#');
-	lhs = tempLHS;
-	rhs = tempRHS;
-	return true;
-}
-
-string trim(string toBeTrimmed){
-	int first = 0;
-	while (toBeTrimmed.substr(first, 1) == " ") first++;
-	int last = toBeTrimmed.length() - 1;
-	while (toBeTrimmed.substr(last, 1) == " ") last--;
-	return toBeTrimmed.substr(first, (last - first) + 1);
-}
-
-void replay(int inFramePTR, int inDelay){
-	for (int i = 0; i < inFramePTR; i++){
-		imshow("Next Frame", frames[i]);
-		switch (waitKey(inDelay));
-	}
-}
-
-bool blackFrame(Mat inFrame){
-	string lineIn;
-	Scalar res = mean(inFrame);
-	return (res[0] < 0.1 && res[1] < 0.1 && res[2] < 0.1);
-}
-
-int main(){
-// Get data path prefix from ProcessHiLites.cfg
-
-	string lhsString[23] = {
-		"dataPathPrefix",
-		"CropLeft",
-		"CropTop"
-	};
-
-
-	ifstream configIn("ProcessHiLites.cfg");
-	if (!configIn.good()){
-		cout << "Can't open ProcessHiLites.cfg.  Spinning for ctrl-c." << endl;
-		while (1){}
-	}
-	int lineNo = 0;
-	while (!configIn.eof()){
-		getline(configIn, inLine);
-		if (!configIn){
-			cout << "Unexpected error in config file.  Spinning for ctrl-c." << endl;
-			while (1){}
-		}
-		if (getSides(inLine)){
-			lhs = trim(lhs);
-			rhs = trim(rhs);
-			if (lhs != lhsString[lineNo]){
-				cout << "Just read LHS doesn't match anything: <" << lhs << ">.  Spinning for ctrl-c." << endl;
-				while (1){}
-			}
-			switch (lineNo){
-			case 0:
-				dataPathPrefix = rhs;
-				cout << "dataPathPrefix = " << dataPathPrefix << endl;
-				break;
-			case 1:
-				leftSide = stoi(rhs);
-				cout << "leftSide = " << leftSide << endl;
-				break;
-			case 2:
-				top = stoi(rhs);
-				cout << "top = " << top << endl << endl;
-				break;
-			default:
-				if (lineNo > 2){
-					cout << "Too many lines in config file.  Spinning for ctrl-c." << endl;
-					while (1){}
-				}
-			} // switch
-			lineNo++;
-		}
-		else{
-			cout << "getSides() failed in config reader.  Check VST.cfg syntax.   Spinning for ctrl-c. " << endl;
-			configIn.close();
-			while (1){}
-		}
-
-	} // while not eof in config file
-
-	string dirPath = dataPathPrefix + "\\HiLites";
-	string sysString = "dir " + dirPath + "\\*.avi /b > " + dirPath + "\\files.txt";
-	const char * c = sysString.c_str();
-	system(c); // copy the file names from the chosen directory to file "files.txt" in the same directory.
-	string yesNo = "n";
-	// Get file user wants
-	while (yesNo == "n"){
-		filesList.open(dirPath + "\\files.txt");
-		while (getline(filesList, fileName)){
-			cout << "Want the file " << fileName << "  (y/n) [n]: ";
-			getline(cin, yesNo);
-			if (yesNo == "y") break;  // User has chosen the file
-			else yesNo = "n";
-		}
-		filesList.close();
-	}
-
-	string fullName = dirPath + "\\" + fileName;
-	cout << "Fullname is: <" << fullName << "> " << endl;
-	hiLiteVideoIn.open(fullName);
-	
-	if (!hiLiteVideoIn.isOpened()){
-		cout << "ERROR ACQUIRING VIDEO FEED\n";
-		getchar();
-		return 0;
-	}
-
-	if (hiLiteVideoIn.get(CV_CAP_PROP_POS_FRAMES) <= hiLiteVideoIn.get(CV_CAP_PROP_FRAME_COUNT)){
-		hiLiteVideoIn.read(frames[0]);
-// NOTE: the following operation crops a 640 x 360 rectangle out of the middlle of input frame.  Dependng on the width of your
-// speed zone, this may not work for you...parts of your speed zone may be cropped off the ends.
-		rectangle(frames[0], Rect(Point(leftSide, top), Point(leftSide + 639, top + 359)), Scalar(CVCyan), 4);
-		imshow("Next Frame", frames[0]);
-		switch (waitKey(20));
-		yesNo = "n";
-		cout << "Is this cropping OK for saved captures? (y/n) [y]: ";
-		getline(cin, yesNo);
-		if (yesNo == "n") return -1; // Coould modify this to move cropping rectangle around until user happy.
-	}
-
-	hiLiteVideoIn.release();
-	switch (waitKey(20));
-	hiLiteVideoIn.open(fullName);
-	if (!hiLiteVideoIn.isOpened()){
-		cout << "ERROR ACQUIRING VIDEO FEED\n";
-		getchar();
-		return 0;
-	}
-
-	fullName = dirPath + "\\forPosting\\forPost_" + fileName;
-	hiLiteVideoOut.open(fullName, -1, hiLiteVideoIn.get(CV_CAP_PROP_FPS), Size(640, 360), true);
-	if (!hiLiteVideoOut.isOpened()){
-		cout << "ERROR Opening output file\n";
-		getchar();
-		return 0;
-	}
-
-
-	bool atVideoEnd = false;
-	string response;
-
-	while (hiLiteVideoIn.get(CV_CAP_PROP_POS_FRAMES) < hiLiteVideoIn.get(CV_CAP_PROP_FRAME_COUNT)){
-
-		framePTR = 0;
-		bool atVehicleClipEnd = false;
-		while (!atVehicleClipEnd){
-			if (hiLiteVideoIn.get(CV_CAP_PROP_POS_FRAMES) <= hiLiteVideoIn.get(CV_CAP_PROP_FRAME_COUNT)){
-				hiLiteVideoIn.read(frames[framePTR]);
-				if (!blackFrame(frames[framePTR])){  //  If this is a black frame, keep it but don't show it
-					imshow("Next Frame", frames[framePTR]);
-					switch (waitKey(20));
-				}
-				else {
-					atVehicleClipEnd = true;
-				}
-				framePTR++;
-			}
-			else{
-				atVehicleClipEnd = true;
-				atVideoEnd = true;
-			}
-		} // while reading frames for current vehicle
-
-
-		if (!atVideoEnd){
-			bool noAction = true;
-			while (noAction){
-				cout << "[K]eep vehicle,  [D]elete vehicle,  [R]eplay,  [S]low replay,  [Q]uit: ";
-				getline(cin, response);
-				if (response == "d"){  // "d"   delete up to and including last frame read.
-					framePTR = 0;
-					noAction = false;
-				}
-				else if (response == "k"){  // "k" keep vehicle in hiLites
-					for (int i = 0; i < 15; i++)
-						hiLiteVideoOut.write(frames[0](Rect(leftSide, top, 640, 360)));
-					for (int i = 0; i < framePTR-1; i++)
-						hiLiteVideoOut.write(frames[i](Rect(leftSide,top,640,360)));
-					for (int i = 0; i < 20; i++)
-						hiLiteVideoOut.write(frames[framePTR-2](Rect(leftSide, top, 640, 360)));
-					hiLiteVideoOut.write(frames[framePTR - 1](Rect(leftSide, top, 640, 360)));
-					framePTR = 0;
-					noAction = false;
-				}
-				else if (response == "r"){  // "r"  replay normal speed
-					replay(framePTR-1, 20);
-				}
-				else if (response == "s"){  // "s"  replay slow speed
-					replay(framePTR-1, 250);
-				}
-				else if (response == "q"){  // "q"  quit.
-					cout << "quitting" << endl;
-					noAction = false;
-				}
-			} // while no action
-		}  // If not at video end
-
-		if (response == "q")
-			break;          //  Stop reading any frames and finish up.
-	} // while frames remain to be read
-
-	if (framePTR > 0){
-		cout << "There are " << framePTR << " frames left in buffer.  Write them out? [y|n] <y>: ";
-		getline(cin, response);
-		if (!response.empty() && response == "y")
-			for (int i = 0; i < framePTR; i++)
-				hiLiteVideoOut.write(frames[i](Rect(leftSide, top, 640, 360)));
-	}
-
-	hiLiteVideoIn.release();
-	hiLiteVideoOut.release();
-
-	return 0;
-}
-
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+//
+
+//  Run this code on output highlights file of VideoSpeedTracker.  The program produces highlights of highlights as edited by the user.
+// Output is placed in subdirectory "forPosting"  with the prefix "for_post" prepended to the input file name.
+//
+//  ProcessHiLites -batch <rules file>  does the same without asking anything, for any number of highlights files at once, keeping
+// the clips the rules file picks out (see readRules() for its syntax).  Clips are found from the index VST writes beside each
+// highlights file, and are decoded and cropped in parallel, one clip per worker thread at a time.  Output is
+// forPosting\forPost_<rules file name>.avi.
+
+
+#include <opencv\cv.h>
+#include "opencv2\highgui\highgui.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <climits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "..\VideoSpeedTracker\VideoFile.h"  // Build with VideoFile.cpp, FFmpegDecoder.cpp and HiLiteIndex.cpp from VideoSpeedTracker.
+#include "..\VideoSpeedTracker\HiLiteIndex.h"
+
+#define CVBlack 0,0,0
+#define CVCyan 255,255,153
+
+using namespace std;
+using namespace cv;
+
+VideoFile hiLiteVideoIn;  //Input hiLites video.  Decoded by FFmpeg, on several threads, when built with it.
+VideoWriter hiLiteVideoOut; // For writing highlights...the edited Scofflaws
+vector<Mat> clipFrames;  // Cropped frames of the clip under review.  Grows as a clip needs;  its Mats are reused from clip to clip.
+int framePTR = 0;  // Frames of clipFrames in use
+Mat inFrame;  // Whole frame, as read
+ifstream filesList;
+string fileName;  // Name of avi file currently being processed.
+int leftSide = 320;  // These values are very specific to the setup used in program trafficReports.   ***********************************
+int top = 120;  // It woould be better to have these passed in as parameters from the trafficReports program.   **********************
+				// Both are in pixels of a 1280 x 720 frame, and are scaled to the highlights' actual frame size.
+Rect crop(320, 120, 640, 360);  // Half the width and height of the highlights frame, at leftSide, top.
+bool wholeFrames = false;  // Post whole highlights frames, uncropped:  for compact highlights, which are already just the analysis box.
+
+string inLine, lhs, rhs;
+string dataPathPrefix;
+
+const int BATCH_CLIPS_AHEAD_PER_THREAD = 4;  // Cropped clips waiting to be written, at most, per worker thread.
+
+// A clip picked for posting, and its cropped frames once a worker has read them.
+struct ClipJob
+{
+	string hiLitePath;
+	HiLiteClip clip;
+	vector<Mat> cropped;
+	bool done = false;
+};
+
+// What -batch keeps.  A clip is kept if it is listed in keepClips, or if there are rules and it passes them all.
+struct BatchRules
+{
+	string files = "*.avi";			// Highlights files, in HiLites
+	bool haveRules = false;			// Any of the following given
+	int minSpeed = 0;
+	int maxSpeed = 1000;
+	string direction = "*";
+	int minArea = 0;
+	int maxArea = INT_MAX;
+	set<pair<string, int> > keepClips;	// (highlights file name, clip number)
+	int fourcc = CV_FOURCC('M', 'J', 'P', 'G');
+};
+
+vector<ClipJob> jobs;
+int nextJob = 0;  // Next job for a worker to take
+int nextToWrite = 0;  // Next job for the writer to write, in order
+mutex jobLock;
+condition_variable jobDone;  // A worker has finished a clip, or the writer one.
+
+
+bool getSides(string inLine){
+	string tempLHS, tempRHS;
+	istringstream configLine(inLine);
+	getline(configLine, tempLHS, '=');
+	getline(configLine, tempRHS, '#');
+	lhs = tempLHS;
+	rhs = tempRHS;
+	return true;
+}
+
+string trim(string toBeTrimmed){
+	size_t first = toBeTrimmed.find_first_not_of(" \t\r");
+	if (first == string::npos) return "";
+	size_t last = toBeTrimmed.find_last_not_of(" \t\r");
+	return toBeTrimmed.substr(first, (last - first) + 1);
+}
+
+void replay(int inFramePTR, int inDelay){
+	for (int i = 0; i < inFramePTR; i++){
+		imshow("Next Frame", clipFrames[i]);
+		switch (waitKey(inDelay));
+	}
+}
+
+Rect cropFor(int frameWidth, int frameHeight){
+// Half the frame's width and height, at leftSide, top (scaled from 1280 x 720).  Or all of it.
+	Rect cropped = Rect(leftSide * frameWidth / 1280, top * frameHeight / 720, frameWidth / 2, frameHeight / 2) & Rect(0, 0, frameWidth, frameHeight);
+	if (wholeFrames) cropped = Rect(0, 0, frameWidth, frameHeight);
+	cropped.width -= cropped.width % 2;  // Encoders want even dimensions.
+	cropped.height -= cropped.height % 2;
+	return cropped;
+}
+
+void bufferFrame(const Mat &wholeFrame){
+// Keep just the crop of a frame read, in the next buffer slot, in the memory that slot already has.
+	if (framePTR == clipFrames.size()) clipFrames.push_back(Mat());
+	wholeFrame(crop).copyTo(clipFrames[framePTR++]);
+}
+
+bool blackFrame(Mat inFrame){
+	string lineIn;
+	Scalar res = mean(inFrame);
+	return (res[0] < 0.1 && res[1] < 0.1 && res[2] < 0.1);
+}
+
+void writeKept(vector<Mat> &keptFrames, int numFrames, Size outSize){
+// A kept clip, keptFrames[0 .. numFrames-1], as posted:  its first frame held, the clip, its last frame held, then its black partition frame.
+	if (numFrames < 2) return;  // Not in the highlights file after all
+	for (int i = 0; i < numFrames; i++){
+		if (keptFrames[i].size() != outSize) resize(keptFrames[i], keptFrames[i], outSize, 0, 0, INTER_AREA);  // From highlights of another size
+	}
+	for (int i = 0; i < 15; i++)
+		hiLiteVideoOut.write(keptFrames[0]);
+	for (int i = 0; i < numFrames - 1; i++)
+		hiLiteVideoOut.write(keptFrames[i]);
+	for (int i = 0; i < 20; i++)
+		hiLiteVideoOut.write(keptFrames[numFrames - 2]);
+	hiLiteVideoOut.write(keptFrames[numFrames - 1]);
+}
+
+string reviewClip(){
+// Ask what to do with the vehicle clip in clipFrames[0 .. framePTR-1], the last being its black partition frame, and do it.
+// Returns the answer;  "q" to stop reviewing.
+	string response;
+	bool noAction = true;
+	while (noAction){
+		cout << "[K]eep vehicle,  [D]elete vehicle,  [R]eplay,  [S]low replay,  [Q]uit: ";
+		getline(cin, response);
+		if (response == "d"){  // "d"   delete up to and including last frame read.
+			framePTR = 0;
+			noAction = false;
+		}
+		else if (response == "k"){  // "k" keep vehicle in hiLites
+			writeKept(clipFrames, framePTR, crop.size());
+			framePTR = 0;
+			noAction = false;
+		}
+		else if (response == "r"){  // "r"  replay normal speed
+			replay(framePTR-1, 20);
+		}
+		else if (response == "s"){  // "s"  replay slow speed
+			replay(framePTR-1, 250);
+		}
+		else if (response == "q"){  // "q"  quit.
+			cout << "quitting" << endl;
+			noAction = false;
+		}
+	} // while no action
+	return response;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * B a t c h   M o d e * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool readRules(string rulesPath, BatchRules &rules){
+// Rules file syntax, one item per line, all optional;  anything after a # is ignored:
+//      files = Hilites_201601*.avi					Highlights files to post from, in HiLites  [*.avi]
+//      speed = 35 - 100							Keep clips at these speeds...
+//      direction = SE								...heading this way (* for both)...
+//      area = 0 - 50000							...with vehicle areas in this range.
+//      keep = Hilites_20160114.avi: 3, 7, 12		Keep these clips too, whatever the rules say.  May be repeated.
+//      fourcc = MJPG								Output codec  [MJPG]
+//      crop = whole								Post whole frames, for compact highlights  [half frame, at CropLeft, CropTop]
+	ifstream rulesIn(rulesPath);
+	if (!rulesIn.good()){
+		cout << "Can't open rules file " << rulesPath << endl;
+		return false;
+	}
+	while (getline(rulesIn, inLine)){
+		if (inLine.find('=') == string::npos || trim(inLine)[0] == '#') continue;  // Blank or comment line
+		getSides(inLine);
+		lhs = trim(lhs);
+		rhs = trim(rhs);
+		int low, high;
+		if (lhs == "files") rules.files = rhs;
+		else if (lhs == "speed" && sscanf(rhs.c_str(), "%d - %d", &low, &high) == 2){
+			rules.minSpeed = low;
+			rules.maxSpeed = high;
+			rules.haveRules = true;
+		}
+		else if (lhs == "direction"){
+			rules.direction = rhs;
+			rules.haveRules = true;
+		}
+		else if (lhs == "area" && sscanf(rhs.c_str(), "%d - %d", &low, &high) == 2){
+			rules.minArea = low;
+			rules.maxArea = high;
+			rules.haveRules = true;
+		}
+		else if (lhs == "keep" && rhs.find(':') != string::npos){
+			string keepFile = trim(rhs.substr(0, rhs.find(':')));
+			istringstream clipNumbers(rhs.substr(rhs.find(':') + 1));
+			string clipNumber;
+			while (getline(clipNumbers, clipNumber, ',')) rules.keepClips.insert(make_pair(keepFile, stoi(clipNumber)));
+		}
+		else if (lhs == "fourcc" && rhs.length() == 4) rules.fourcc = CV_FOURCC(rhs[0], rhs[1], rhs[2], rhs[3]);
+		else if (lhs == "crop" && rhs == "whole") wholeFrames = true;
+		else{
+			cout << "Don't understand rule <" << inLine << ">" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool keeps(BatchRules &rules, string hiLiteName, HiLiteClip &clip){
+	if (rules.keepClips.count(make_pair(hiLiteName, clip.clip))) return true;
+	return rules.haveRules && clip.speed >= rules.minSpeed && clip.speed <= rules.maxSpeed
+		&& (rules.direction == "*" || clip.direction == rules.direction) && clip.area >= rules.minArea && clip.area <= rules.maxArea;
+}
+
+void cropClips(int maxAhead){
+// One worker thread:  read and crop the next clip no other worker has taken, unless the writer is maxAhead clips behind.
+	VideoFile clipIn;  // Each worker decodes on its own.
+	string openPath;
+	while (true){
+		int j;
+		{
+			unique_lock<mutex> lock(jobLock);
+			while (nextJob < jobs.size() && nextJob >= nextToWrite + maxAhead) jobDone.wait(lock);
+			if (nextJob >= jobs.size()) return;
+			j = nextJob++;
+		}
+		ClipJob &job = jobs[j];
+		vector<Mat> cropped;
+		if (job.hiLitePath != openPath){
+			clipIn.release();
+			clipIn.open(job.hiLitePath);
+			openPath = job.hiLitePath;
+		}
+		if (clipIn.isOpened() && clipIn.seek(job.clip.firstFrame)){  // Straight there, via the keyframe index.
+			Rect clipCrop = cropFor(int(clipIn.getFrameWidth()), int(clipIn.getFrameHeight()));
+			Mat frame;
+			while (clipIn.getPosition() <= job.clip.lastFrame && clipIn.read(frame)) cropped.push_back(frame(clipCrop).clone());
+		}
+		{
+			lock_guard<mutex> lock(jobLock);
+			job.cropped.swap(cropped);
+			job.done = true;
+		}
+		jobDone.notify_all();
+	}
+}
+
+int runBatch(string rulesPath){
+// Post the clips the rules pick out of every highlights file they name, in file and clip order, with no questions.
+	BatchRules rules;
+	if (!readRules(rulesPath, rules)) return -1;
+	string dirPath = dataPathPrefix + "\\HiLites";
+	string sysString = "dir " + dirPath + "\\" + rules.files + " /b > " + dirPath + "\\files.txt";
+	system(sysString.c_str());
+	filesList.open(dirPath + "\\files.txt");
+	while (getline(filesList, fileName)){
+		string hiLitePath = dirPath + "\\" + fileName;
+		vector<HiLiteClip> clips;
+		if (!HiLiteIndex::read(HiLiteIndex::pathFor(hiLitePath), clips)){
+			cout << fileName << " has no clip index.  Skipped." << endl;
+			continue;
+		}
+		int numKept = 0;
+		for (int c = 0; c < clips.size(); c++){
+			if (!keeps(rules, fileName, clips[c])) continue;  // Never decoded
+			ClipJob job;
+			job.hiLitePath = hiLitePath;
+			job.clip = clips[c];
+			jobs.push_back(job);
+			numKept++;
+		}
+		cout << fileName << ":  keeping " << numKept << " of " << clips.size() << " clips." << endl;
+	}
+	filesList.close();
+	if (jobs.empty()){
+		cout << "No clips to post." << endl;
+		return 0;
+	}
+
+// Output is at the first highlights file's crop size and frame rate.
+	VideoFile firstIn;
+	if (!firstIn.open(jobs[0].hiLitePath)){
+		cout << "ERROR ACQUIRING VIDEO FEED\n";
+		return -1;
+	}
+	Size outSize = cropFor(int(firstIn.getFrameWidth()), int(firstIn.getFrameHeight())).size();
+	double outFPS = firstIn.getFPS();
+	firstIn.release();
+	string rulesName = rulesPath.substr(rulesPath.find_last_of('\\') + 1);
+	string outPath = dirPath + "\\forPosting\\forPost_" + rulesName.substr(0, rulesName.find_last_of('.')) + ".avi";
+	hiLiteVideoOut.open(outPath, rules.fourcc, outFPS, outSize, true);
+	if (!hiLiteVideoOut.isOpened()){
+		cout << "ERROR Opening output file " << outPath << endl;
+		return -1;
+	}
+
+// Workers decode and crop clips out of order;  they are written in order as they are ready.
+	int numThreads = max(int(thread::hardware_concurrency()), 1);
+	cv::setNumThreads(0);  // The workers are all the threads there should be.
+	FFmpegDecoder::decodeThreads = 1;
+	vector<thread> workers;
+	for (int i = 0; i < numThreads; i++) workers.push_back(thread(cropClips, numThreads * BATCH_CLIPS_AHEAD_PER_THREAD));
+	for (int j = 0; j < jobs.size(); j++){
+		{
+			unique_lock<mutex> lock(jobLock);
+			while (!jobs[j].done) jobDone.wait(lock);
+		}
+		writeKept(jobs[j].cropped, jobs[j].cropped.size(), outSize);
+		{
+			lock_guard<mutex> lock(jobLock);
+			jobs[j].cropped.clear();
+			nextToWrite = j + 1;
+		}
+		jobDone.notify_all();
+	}
+	for (int i = 0; i < numThreads; i++) workers[i].join();
+	hiLiteVideoOut.release();
+	cout << "Posted " << jobs.size() << " clips to " << outPath << endl;
+	return 0;
+}
+
+
+int main(int argc, char* argv[]){
+// Get data path prefix from ProcessHiLites.cfg
+
+	string lhsString[23] = {
+		"dataPathPrefix",
+		"CropLeft",
+		"CropTop"
+	};
+
+
+	ifstream configIn("ProcessHiLites.cfg");
+	if (!configIn.good()){
+		cout << "Can't open ProcessHiLites.cfg.  Spinning for ctrl-c." << endl;
+		while (1){}
+	}
+	int lineNo = 0;
+	while (!configIn.eof()){
+		getline(configIn, inLine);
+		if (!configIn){
+			cout << "Unexpected error in config file.  Spinning for ctrl-c." << endl;
+			while (1){}
+		}
+		if (getSides(inLine)){
+			lhs = trim(lhs);
+			rhs = trim(rhs);
+			if (lhs != lhsString[lineNo]){
+				cout << "Just read LHS doesn't match anything: <" << lhs << ">.  Spinning for ctrl-c." << endl;
+				while (1){}
+			}
+			switch (lineNo){
+			case 0:
+				dataPathPrefix = rhs;
+				cout << "dataPathPrefix = " << dataPathPrefix << endl;
+				break;
+			case 1:
+				leftSide = stoi(rhs);
+				cout << "leftSide = " << leftSide << endl;
+				break;
+			case 2:
+				top = stoi(rhs);
+				cout << "top = " << top << endl << endl;
+				break;
+			default:
+				if (lineNo > 2){
+					cout << "Too many lines in config file.  Spinning for ctrl-c." << endl;
+					while (1){}
+				}
+			} // switch
+			lineNo++;
+		}
+		else{
+			cout << "getSides() failed in config reader.  Check VST.cfg syntax.   Spinning for ctrl-c. " << endl;
+			configIn.close();
+			while (1){}
+		}
+
+	} // while not eof in config file
+
+	if (argc > 2 && string(argv[1]) == "-batch") return runBatch(argv[2]);
+
+	string dirPath = dataPathPrefix + "\\HiLites";
+	string sysString = "dir " + dirPath + "\\*.avi /b > " + dirPath + "\\files.txt";
+	const char * c = sysString.c_str();
+	system(c); // copy the file names from the chosen directory to file "files.txt" in the same directory.
+	string yesNo = "n";
+	// Get file user wants
+	while (yesNo == "n"){
+		filesList.open(dirPath + "\\files.txt");
+		while (getline(filesList, fileName)){
+			cout << "Want the file " << fileName << "  (y/n) [n]: ";
+			getline(cin, yesNo);
+			if (yesNo == "y") break;  // User has chosen the file
+			else yesNo = "n";
+		}
+		filesList.close();
+	}
+
+	string fullName = dirPath + "\\" + fileName;
+	cout << "Fullname is: <" << fullName << "> " << endl;
+	vector<HiLiteClip> clips;  // From the index VST writes beside the highlights file
+	bool indexed = HiLiteIndex::read(HiLiteIndex::pathFor(fullName), clips);
+	hiLiteVideoIn.open(fullName);
+	
+	if (!hiLiteVideoIn.isOpened()){
+		cout << "ERROR ACQUIRING VIDEO FEED\n";
+		getchar();
+		return 0;
+	}
+
+	int frameWidth = int(hiLiteVideoIn.getFrameWidth());
+	int frameHeight = int(hiLiteVideoIn.getFrameHeight());
+	crop = cropFor(frameWidth, frameHeight);
+
+	if (hiLiteVideoIn.getPosition() <= hiLiteVideoIn.getFrameCount()){
+		hiLiteVideoIn.read(inFrame);
+// NOTE: the following operation crops a rectangle half the frame's width and height (640 x 360 of a 1280 x 720 frame) out of the middlle
+// of input frame.  Dependng on the width of your speed zone, this may not work for you...parts of your speed zone may be cropped off the ends.
+		rectangle(inFrame, crop, Scalar(CVCyan), 4);
+		imshow("Next Frame", inFrame);
+		switch (waitKey(20));
+		yesNo = "n";
+		cout << "Is this cropping OK for saved captures? (y/n, or w for whole frames of compact highlights) [y]: ";
+		getline(cin, yesNo);
+		if (yesNo == "n") return -1; // Coould modify this to move cropping rectangle around until user happy.
+		wholeFrames = (yesNo == "w");
+		crop = cropFor(frameWidth, frameHeight);
+	}
+
+	switch (waitKey(20));
+	hiLiteVideoIn.seek(0);
+
+	fullName = dirPath + "\\forPosting\\forPost_" + fileName;
+	hiLiteVideoOut.open(fullName, -1, hiLiteVideoIn.getFPS(), crop.size(), true);
+	if (!hiLiteVideoOut.isOpened()){
+		cout << "ERROR Opening output file\n";
+		getchar();
+		return 0;
+	}
+
+
+	bool atVideoEnd = false;
+	string response;
+
+// With an index, list the clips, and review just those wanted:  the rest are never decoded.
+	if (indexed){
+		for (int c = 0; c < clips.size(); c++)
+			cout << "Clip " << clips[c].clip << ":  " << clips[c].direction << "  " << clips[c].speed << " MPH,  area " << clips[c].area
+			<< ",  " << clips[c].date << " " << clips[c].time << endl;
+		int lowestSpeed = 0;
+		string direction = "*";
+		cout << "Lowest speed to review (int) [0]: ";
+		getline(cin, response);
+		if (!response.empty()) lowestSpeed = stoi(response);
+		cout << "Direction to review (* for both) [*]: ";
+		getline(cin, response);
+		if (!response.empty()) direction = response;
+		set<int> skipClips;  // Clips to delete unseen
+		cout << "Clips to delete without review, e.g. 3, 7 []: ";
+		getline(cin, response);
+		istringstream clipNumbers(response);
+		string clipNumber;
+		while (getline(clipNumbers, clipNumber, ',')) if (!trim(clipNumber).empty()) skipClips.insert(stoi(clipNumber));
+		response.clear();
+
+		for (int c = 0; c < clips.size() && response != "q"; c++){
+			if (clips[c].speed < lowestSpeed || (direction != "*" && clips[c].direction != direction) || skipClips.count(clips[c].clip)) continue;
+			cout << "Clip " << clips[c].clip << ":  " << clips[c].direction << "  " << clips[c].speed << " MPH" << endl;
+			hiLiteVideoIn.seek(clips[c].firstFrame);  // Skipped clips in between are grabbed, not converted or buffered.
+			framePTR = 0;
+			while (hiLiteVideoIn.getPosition() <= clips[c].lastFrame && hiLiteVideoIn.read(inFrame)){
+				if (hiLiteVideoIn.getPosition() <= clips[c].lastFrame){  // Don't show the partition frame
+					imshow("Next Frame", inFrame);
+					switch (waitKey(20));
+				}
+				bufferFrame(inFrame);
+			}
+			if (framePTR < 2) break;  // Highlights file is shorter than its index says.
+			response = reviewClip();
+		}
+	}
+
+	while (!indexed && hiLiteVideoIn.getPosition() < hiLiteVideoIn.getFrameCount()){  // Highlights from before indexes:  find clips by their black partition frames.
+
+		framePTR = 0;
+		bool atVehicleClipEnd = false;
+		while (!atVehicleClipEnd){
+			if (hiLiteVideoIn.getPosition() <= hiLiteVideoIn.getFrameCount() && hiLiteVideoIn.read(inFrame)){
+				if (!blackFrame(inFrame)){  //  If this is a black frame, keep it but don't show it
+					imshow("Next Frame", inFrame);
+					switch (waitKey(20));
+				}
+				else {
+					atVehicleClipEnd = true;
+				}
+				bufferFrame(inFrame);
+			}
+			else{
+				atVehicleClipEnd = true;
+				atVideoEnd = true;
+			}
+		} // while reading frames for current vehicle
+
+
+		if (!atVideoEnd) response = reviewClip();
+
+		if (response == "q")
+			break;          //  Stop reading any frames and finish up.
+	} // while frames remain to be read
+
+	if (framePTR > 0){
+		cout << "There are " << framePTR << " frames left in buffer.  Write them out? [y|n] <y>: ";
+		getline(cin, response);
+		if (!response.empty() && response == "y")
+			for (int i = 0; i < framePTR; i++)
+				hiLiteVideoOut.write(clipFrames[i]);
+	}
+
+	hiLiteVideoIn.release();
+	hiLiteVideoOut.release();
+
+	return 0;
+}
+
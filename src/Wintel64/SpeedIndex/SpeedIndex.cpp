@@ -0,0 +1,450 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+//  Run this code to answer questions about speeds over many days of VideoSpeedTracker results, e.g. the 85th percentile speed of
+// vehicles heading SE between 7 and 9 am over the last 90 days, without opening every stats file.
+//
+//  SpeedIndex                                             Bring the index up to date with the stats files.
+//  SpeedIndex -query <from> <to> [<hh[:mm]> <hh[:mm]> [<direction> [<speed>]]]
+//                                                         Count, mean, median and 85th percentile speed of vehicles in the
+//                                                         days and time of day given, and how many went faster than speed.
+//  <from> and <to> are days, yyyymmdd, or -n for n days before today.  Direction is as in the stats files (e.g. SE), or * for both.
+//  e.g.  SpeedIndex -query -90 -1 7 9 SE 35
+//
+//  The index lives in <dataPathPrefix>\Index.  It holds one file per day and direction, yyyymmdd_<direction>.vsi, of the vehicles
+// seen that day heading that way, in time order.  Each is laid out in columns (time of day, speed, area, ...), with the first
+// vehicle of each hour noted in its header, and is read through a file mapping:  a query touches only the days, hours and
+// columns it needs, and nothing is parsed.  Stats files are ingested as they grow;  Index\ingested.txt says how much of each has
+// been read.  Vehicles are keyed by camera file and start frame, so one analyzed twice (e.g. stats_yyyymmdd.csv from a camera
+// watch, and stats_yyyymmdd_hhmmss.csv from a run over a single file) is counted once.  Speeds flagged ***** are left out.
+
+
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+const int INDEX_VERSION = 1;
+const int MAX_INDEX_SPEED = 255;  // Speeds are histogrammed to 1 mph;  faster ones count as this.
+
+struct IndexHeader
+{
+	char magic[4];			// "VSTI"
+	int32_t version;
+	int32_t rows;			// Vehicles
+	int32_t hourStart[25];	// Row of the first vehicle in each hour;  hourStart[24] == rows
+};
+// Columns follow the header, rows long each:  uint32 second of day, int32 area, uint32 camera file hhmmss, int32 start frame, int16 speed.
+
+struct IndexRow
+{
+	uint32_t second;		// Seconds since midnight the vehicle entered the scene
+	int32_t area;			// Profile area, in processing pixels
+	uint32_t fileTime;		// hhmmss of the camera file it was seen in
+	int32_t startFrame;		// Frame it was first tracked in, in that file
+	int16_t speed;
+};
+
+bool operator<(const IndexRow& a, const IndexRow& b){
+	return (a.second != b.second) ? a.second < b.second : (a.fileTime != b.fileTime) ? a.fileTime < b.fileTime : a.startFrame < b.startFrame;
+}
+
+string inLine, lhs, rhs;
+string dataPathPrefix;
+double FPS = 30.0;  // Frame rate of the camera files:  start frames are turned into times of day with it.
+string indexPath;  // <dataPathPrefix>\Index\
+
+
+// A MappedPartition is one day and direction's index file, mapped read only.
+class MappedPartition
+{
+public:
+	~MappedPartition(){ close(); }
+
+	bool open(string path){
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (file == INVALID_HANDLE_VALUE){  // No vehicles that day, that way
+			file = NULL;
+			return false;
+		}
+		LARGE_INTEGER size;
+		GetFileSizeEx(file, &size);
+		mapping = (size.QuadPart >= (long long)sizeof(IndexHeader)) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+		view = (mapping != NULL) ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+		header = (const IndexHeader*)view;
+		if (view == NULL || memcmp(header->magic, "VSTI", 4) != 0 || header->version != INDEX_VERSION
+			|| size.QuadPart < (long long)sizeof(IndexHeader) + (long long)header->rows * 18){
+			cout << path << " is not an index file of this version.  Delete it, and ingested.txt, to rebuild the index." << endl;
+			close();
+			return false;
+		}
+		int rows = header->rows;
+		second = (const uint32_t*)(view + sizeof(IndexHeader));
+		area = (const int32_t*)(second + rows);
+		fileTime = (const uint32_t*)(area + rows);
+		startFrame = (const int32_t*)(fileTime + rows);
+		speed = (const int16_t*)(startFrame + rows);
+		return true;
+	}
+
+	void close(){
+		if (view != NULL) UnmapViewOfFile(view);
+		if (mapping != NULL) CloseHandle(mapping);
+		if (file != NULL) CloseHandle(file);
+		view = NULL;
+		mapping = NULL;
+		file = NULL;
+	}
+
+	int rows(){
+		return (view != NULL) ? header->rows : 0;
+	}
+
+	int firstAtOrAfter(uint32_t inSecond){
+	// The hour index narrows the search to one hour's vehicles.
+		int hour = min(int(inSecond / 3600), 24);
+		if (hour == 24) return header->rows;
+		return int(lower_bound(second + header->hourStart[hour], second + header->hourStart[hour + 1], inSecond) - second);
+	}
+
+	IndexRow row(int i){
+		IndexRow r;
+		r.second = second[i];
+		r.area = area[i];
+		r.fileTime = fileTime[i];
+		r.startFrame = startFrame[i];
+		r.speed = speed[i];
+		return r;
+	}
+
+	const uint32_t* second = NULL;	// Columns, in the mapping
+	const int32_t* area = NULL;
+	const uint32_t* fileTime = NULL;
+	const int32_t* startFrame = NULL;
+	const int16_t* speed = NULL;
+
+private:
+	HANDLE file = NULL;
+	HANDLE mapping = NULL;
+	const char* view = NULL;
+	const IndexHeader* header = NULL;
+};
+
+
+bool getSides(string inLine){
+	string tempLHS, tempRHS;
+	istringstream configLine(inLine);
+	getline(configLine, tempLHS, '=');
+	getline(configLine, tempRHS, '#');
+	lhs = tempLHS;
+	rhs = tempRHS;
+	return true;
+}
+
+string trim(string toBeTrimmed){
+	size_t first = toBeTrimmed.find_first_not_of(" \t\"");
+	if (first == string::npos) return "";
+	size_t last = toBeTrimmed.find_last_not_of(" \t\"\r");
+	return toBeTrimmed.substr(first, (last - first) + 1);
+}
+
+bool readConfig(){
+// SpeedIndex.cfg:  dataPathPrefix, then FPS.
+	string lhsString[2] = {
+		"dataPathPrefix",
+		"FPS"
+	};
+	ifstream configIn("SpeedIndex.cfg");
+	if (!configIn.good()){
+		cout << "Can't open SpeedIndex.cfg." << endl;
+		return false;
+	}
+	int lineNo = 0;
+	while (getline(configIn, inLine) && lineNo < 2){
+		getSides(inLine);
+		lhs = trim(lhs);
+		rhs = trim(rhs);
+		if (lhs.empty()) continue;
+		if (lhs != lhsString[lineNo]){
+			cout << "Just read LHS doesn't match anything: <" << lhs << ">." << endl;
+			return false;
+		}
+		if (lineNo == 0) dataPathPrefix = rhs;
+		else FPS = stod(rhs);
+		lineNo++;
+	}
+	return lineNo == 2;
+}
+
+
+string dayAfter(string day){
+	tm when = {};
+	when.tm_year = stoi(day.substr(0, 4)) - 1900;
+	when.tm_mon = stoi(day.substr(4, 2)) - 1;
+	when.tm_mday = stoi(day.substr(6, 2)) + 1;
+	when.tm_hour = 12;  // Clear of daylight saving changes
+	mktime(&when);  // Normalizes the day of the month
+	char name[9];
+	strftime(name, sizeof(name), "%Y%m%d", &when);
+	return name;
+}
+
+string dayArgument(string arg){
+// yyyymmdd, or -n:  n days before today.
+	if (arg.empty() || arg[0] != '-') return arg;
+	time_t then = time(0) - time_t(stoi(arg.substr(1))) * 24 * 3600;
+	char name[9];
+	strftime(name, sizeof(name), "%Y%m%d", localtime(&then));
+	return name;
+}
+
+uint32_t secondArgument(string arg){
+// hh or hh:mm
+	size_t colon = arg.find(':');
+	return uint32_t(stoi(arg.substr(0, colon)) * 3600 + ((colon != string::npos) ? stoi(arg.substr(colon + 1)) * 60 : 0));
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * I n g e s t i n g * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool parseStatsRow(string line, string& day, string& direction, IndexRow& r){
+// A stats file row:  yyyymmdd, hhmmss, Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed[, *****]
+	vector<string> fields;
+	istringstream row(line);
+	string field;
+	while (getline(row, field, ',')) fields.push_back(trim(field));
+	if (fields.size() < 13 || fields[0].length() != 8 || fields[1].length() != 6) return false;  // Header, or not a vehicle
+	if (fields.size() > 13 && fields[13] == "*****") return false;  // Speed not believed
+	day = fields[0];
+	direction = fields[3];
+	r.fileTime = uint32_t(stoi(fields[1]));
+	r.startFrame = stoi(fields[4]);
+	r.area = stoi(fields[10]);
+	r.speed = int16_t(stoi(fields[12]));
+	uint32_t fileSecond = (r.fileTime / 10000) * 3600 + ((r.fileTime / 100) % 100) * 60 + r.fileTime % 100;
+	r.second = fileSecond + uint32_t(r.startFrame / FPS);
+	if (r.second >= 24 * 3600){  // Camera file ran past midnight
+		r.second -= 24 * 3600;
+		day = dayAfter(day);
+	}
+	return true;
+}
+
+
+bool writePartition(string path, vector<IndexRow>& rows){
+// Rows are sorted and unique.  Written beside the old file, then swapped for it.
+	IndexHeader header;
+	memcpy(header.magic, "VSTI", 4);
+	header.version = INDEX_VERSION;
+	header.rows = int32_t(rows.size());
+	int r = 0;
+	for (int hour = 0; hour < 25; hour++){
+		while (r < int(rows.size()) && rows[r].second < uint32_t(hour) * 3600) r++;
+		header.hourStart[hour] = r;
+	}
+	header.hourStart[24] = header.rows;
+	string newPath = path + ".new";
+	ofstream out(newPath, ios::out | ios::binary | ios::trunc);
+	if (!out.is_open()) return false;
+	out.write((const char*)&header, sizeof(header));
+	for (size_t i = 0; i < rows.size(); i++) out.write((const char*)&rows[i].second, sizeof(uint32_t));
+	for (size_t i = 0; i < rows.size(); i++) out.write((const char*)&rows[i].area, sizeof(int32_t));
+	for (size_t i = 0; i < rows.size(); i++) out.write((const char*)&rows[i].fileTime, sizeof(uint32_t));
+	for (size_t i = 0; i < rows.size(); i++) out.write((const char*)&rows[i].startFrame, sizeof(int32_t));
+	for (size_t i = 0; i < rows.size(); i++) out.write((const char*)&rows[i].speed, sizeof(int16_t));
+	out.close();
+	if (out.fail()) return false;
+	return MoveFileExA(newPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+
+bool mergeIntoPartition(string path, vector<IndexRow>& newRows){
+// The partition's vehicles plus newRows, in time order.  A vehicle already indexed (same camera file and start frame) is replaced.
+	vector<IndexRow> rows;
+	MappedPartition old;
+	if (old.open(path)){
+		rows.reserve(old.rows() + newRows.size());
+		for (int i = 0; i < old.rows(); i++) rows.push_back(old.row(i));
+		old.close();
+	}
+	map<pair<uint32_t, int32_t>, size_t> where;  // (fileTime, startFrame) -> row
+	for (size_t i = 0; i < rows.size(); i++) where[make_pair(rows[i].fileTime, rows[i].startFrame)] = i;
+	for (size_t i = 0; i < newRows.size(); i++){
+		pair<uint32_t, int32_t> key(newRows[i].fileTime, newRows[i].startFrame);
+		if (where.count(key)) rows[where[key]] = newRows[i];
+		else{
+			where[key] = rows.size();
+			rows.push_back(newRows[i]);
+		}
+	}
+	sort(rows.begin(), rows.end());
+	return writePartition(path, rows);
+}
+
+
+bool update(){
+// Read whatever the stats files have gained since the last update into the index.
+	map<string, long long> ingested;  // Stats file name -> bytes read
+	ifstream ingestedIn(indexPath + "ingested.txt");
+	while (getline(ingestedIn, inLine)){
+		getSides(inLine);
+		if (!trim(rhs).empty()) ingested[trim(lhs)] = stoll(trim(rhs));
+	}
+	ingestedIn.close();
+
+	map<string, vector<IndexRow> > newRows;  // Partition file name -> vehicles to add
+	int filesRead = 0;
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA((dataPathPrefix + "\\stats\\stats_*.csv").c_str(), &found);
+	if (search != INVALID_HANDLE_VALUE){
+		do{
+			string name = found.cFileName;
+			ifstream stats(dataPathPrefix + "\\stats\\" + name, ios::in | ios::binary);
+			stats.seekg(0, ios::end);
+			long long size = stats.tellg();
+			long long from = ingested.count(name) ? ingested[name] : 0;
+			if (size == from) continue;
+			if (size < from) from = 0;  // Rewritten since (e.g. the run was repeated).  Its vehicles replace those indexed.
+			stats.seekg(from);
+			string line;
+			while (getline(stats, line)){
+				if (stats.eof()) break;  // No newline yet:  the row is still being written.
+				from = stats.tellg();
+				string day, direction;
+				IndexRow r;
+				if (parseStatsRow(line, day, direction, r)) newRows[day + "_" + direction + ".vsi"].push_back(r);
+			}
+			ingested[name] = from;
+			filesRead++;
+		} while (FindNextFileA(search, &found));
+		FindClose(search);
+	}
+	if (filesRead == 0) return true;
+
+	for (map<string, vector<IndexRow> >::iterator p = newRows.begin(); p != newRows.end(); p++){
+		if (!mergeIntoPartition(indexPath + p->first, p->second)){
+			cout << "Can't write " << indexPath + p->first << endl;
+			return false;
+		}
+	}
+	ofstream ingestedOut(indexPath + "ingested.txt", ios::out | ios::trunc);  // Only once the partitions are safely written.
+	for (map<string, long long>::iterator i = ingested.begin(); i != ingested.end(); i++) ingestedOut << i->first << " = " << i->second << endl;
+	cout << "Indexed new rows of " << filesRead << " stats files into " << newRows.size() << " day/direction files." << endl;
+	return true;
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * Q u e r y i n g * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+int percentile(vector<int>& histogram, int count, double fraction){
+// Lowest speed at or below which fraction of the vehicles went.
+	int target = max(int(fraction * count + 0.999999), 1);
+	int seen = 0;
+	for (int speed = 0; speed <= MAX_INDEX_SPEED; speed++){
+		seen += histogram[speed];
+		if (seen >= target) return speed;
+	}
+	return MAX_INDEX_SPEED;
+}
+
+
+int query(string fromDay, string toDay, uint32_t fromSecond, uint32_t toSecond, string direction, int overSpeed){
+	vector<int> histogram(MAX_INDEX_SPEED + 1, 0);  // Vehicles at each speed
+	long long count = 0, speedSum = 0, over = 0;
+	int days = 0;
+	vector<string> directions;
+	if (direction != "*") directions.push_back(direction);
+	else{  // Every direction the index holds
+		WIN32_FIND_DATAA found;
+		HANDLE search = FindFirstFileA((indexPath + "*.vsi").c_str(), &found);
+		if (search != INVALID_HANDLE_VALUE){
+			do{
+				string name = found.cFileName;
+				string heading = name.substr(9, name.length() - 13);
+				if (find(directions.begin(), directions.end(), heading) == directions.end()) directions.push_back(heading);
+			} while (FindNextFileA(search, &found));
+			FindClose(search);
+		}
+	}
+	clock_t started = clock();
+	for (string day = fromDay; day <= toDay; day = dayAfter(day)){
+		days++;
+		for (size_t d = 0; d < directions.size(); d++){
+			MappedPartition partition;
+			if (!partition.open(indexPath + day + "_" + directions[d] + ".vsi")) continue;
+			int first = partition.firstAtOrAfter(fromSecond);
+			int last = partition.firstAtOrAfter(toSecond);
+			for (int i = first; i < last; i++){
+				int speed = min(max(int(partition.speed[i]), 0), MAX_INDEX_SPEED);
+				histogram[speed]++;
+				speedSum += partition.speed[i];
+				if (partition.speed[i] > overSpeed) over++;
+			}
+			count += last - first;
+		}
+	}
+	double msec = 1000.0 * (clock() - started) / CLOCKS_PER_SEC;
+
+	cout << days << " days, " << fromDay << " to " << toDay << ",  " << fromSecond / 3600 << ":" << (fromSecond / 60) % 60 / 10 << (fromSecond / 60) % 10
+		<< " to " << toSecond / 3600 << ":" << (toSecond / 60) % 60 / 10 << (toSecond / 60) % 10 << ",  heading " << direction << endl;
+	cout << "Vehicles:  " << count << endl;
+	if (count > 0){
+		cout << "Mean speed:  " << double(speedSum) / count << endl;
+		cout << "Median speed:  " << percentile(histogram, int(count), 0.5) << endl;
+		cout << "85th percentile speed:  " << percentile(histogram, int(count), 0.85) << endl;
+		if (overSpeed < MAX_INDEX_SPEED) cout << "Faster than " << overSpeed << ":  " << over << "  (" << 100.0 * over / count << "%)" << endl;
+	}
+	cout << "(" << msec << " msec)" << endl;
+	return 0;
+}
+
+
+int main(int argc, char* argv[]){
+
+	if (!readConfig()) return -1;
+	indexPath = dataPathPrefix + "\\Index\\";
+	CreateDirectoryA(indexPath.c_str(), NULL);  // First run
+	if (!update()) return -1;
+	if (argc < 2) return 0;
+
+	if (string(argv[1]) != "-query" || argc < 4){
+		cout << "Usage:  SpeedIndex [-query <from yyyymmdd|-days> <to yyyymmdd|-days> [<hh[:mm]> <hh[:mm]> [<direction>|* [<speed>]]]]" << endl;
+		return -1;
+	}
+	string fromDay = dayArgument(argv[2]);
+	string toDay = dayArgument(argv[3]);
+	uint32_t fromSecond = (argc > 5) ? secondArgument(argv[4]) : 0;
+	uint32_t toSecond = (argc > 5) ? secondArgument(argv[5]) : 24 * 3600;
+	string direction = (argc > 6) ? argv[6] : "*";
+	int overSpeed = (argc > 7) ? stoi(argv[7]) : MAX_INDEX_SPEED;
+	return query(fromDay, toDay, fromSecond, toSecond, direction, overSpeed);
+}
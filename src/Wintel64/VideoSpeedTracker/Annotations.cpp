@@ -0,0 +1,74 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "Annotations.h"
+
+
+Annotations::Annotations()
+{
+}
+
+
+Annotations::~Annotations()
+{
+}
+
+
+void Annotations::clear(){
+// Capacity is kept, so listing the next frame pair's annotations allocates nothing.
+	lines.clear();
+	texts.clear();
+}
+
+
+void Annotations::addLine(Point from, Point to, Scalar color){
+	lines.push_back(AnnotationLine{ from, to, color });
+}
+
+
+void Annotations::addBox(Rect box, Scalar color){
+	int x = box.x;
+	int y = box.y;
+	addLine(Point(x, y), Point(x + box.width, y), color);
+	addLine(Point(x, y + box.height), Point(x + box.width, y + box.height), color);
+	addLine(Point(x, y), Point(x, y + box.height), color);
+	addLine(Point(x + box.width, y), Point(x + box.width, y + box.height), color);
+}
+
+
+void Annotations::addText(string text, Point at, Scalar color){
+	texts.push_back(AnnotationText{ text, at, color });
+}
+
+
+bool Annotations::empty(){
+	return lines.empty() && texts.empty();
+}
+
+
+void Annotations::draw(Mat &canvas){
+	for (int i = 0; i < lines.size(); i++)
+		cv::line(canvas, lines[i].from, lines[i].to, lines[i].color, 2);
+	for (int i = 0; i < texts.size(); i++)
+		putText(canvas, texts[i].text, texts[i].at, 2, 1, texts[i].color, 2);
+}
@@ -0,0 +1,68 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include <opencv\cv.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+// Annotations are the lines and text the tracker would draw on a frame pair's AnalysisFrame:  speed posts, vehicle boxes, observed
+// blobs, speeds and the bailing bar.  They are only listed while tracking, and rasterized by draw() when the frame is actually shown
+// or saved for highlights, so runs that show nothing and save no highlights frames never draw a pixel.
+
+struct AnnotationLine
+{
+	Point from;
+	Point to;
+	Scalar color;
+};
+
+struct AnnotationText
+{
+	string text;
+	Point at;			// Bottom left of the text
+	Scalar color;
+};
+
+class Annotations
+{
+public:
+	Annotations();
+	~Annotations();
+
+	void clear();
+	void addLine(Point from, Point to, Scalar color);
+	void addBox(Rect box, Scalar color);
+	void addText(string text, Point at, Scalar color);
+	bool empty();
+	void draw(Mat &canvas);
+
+private:
+
+	vector<AnnotationLine> lines;  // Drawn 2 pixels wide, in the order listed
+	vector<AnnotationText> texts;  // Drawn over the lines
+};
@@ -0,0 +1,220 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "CameraWatch.h"
+#include "MappedVideo.h"
+#include <windows.h>
+#include <conio.h>
+#include <iostream>
+#include <fstream>
+#include <ctime>
+#include <iterator>
+
+
+CameraWatch::CameraWatch()
+{
+}
+
+
+CameraWatch::~CameraWatch()
+{
+	close();
+}
+
+
+string todayName(string format){
+	time_t now = time(0);
+	char stamp[16];
+	strftime(stamp, sizeof(stamp), format.c_str(), localtime(&now));
+	return stamp;
+}
+
+
+bool CameraWatch::open(string inCamPath, Globals& inG, int speedLimit, int hiLiteSpeed){
+	close();
+	camPath = inCamPath;
+	g = inG;
+	site.name = "watch";
+	site.g = g;
+	site.inputPath = camPath;
+	SpeedTracker &tracker = site.tracker;
+	tracker.configure(g);
+	tracker.headless = true;
+	tracker.speedLimit = speedLimit;
+	tracker.egregiousSpeedLowerBound = tracker.speedLimit + 10;
+	tracker.crazySpeed = tracker.egregiousSpeedLowerBound + 20;  // Stats reporting will flag anything faster than this.
+	tracker.summaryPrefix = g.dataPathPrefix + "\\stats\\summary_";  // Named as a run over the day directory names them
+	hiLitesPlease = (hiLiteSpeed > 0);
+	if (hiLitesPlease) tracker.highLightsSpeedLower = hiLiteSpeed;
+
+	directory = CreateFileA(camPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (directory == INVALID_HANDLE_VALUE){
+		directory = NULL;
+		cout << "Can't watch " << camPath << "." << endl;
+		return false;
+	}
+	changed = CreateEventA(NULL, TRUE, FALSE, NULL);
+	overlapped = new OVERLAPPED();
+	changes.resize(WATCH_BUFFER_BYTES / sizeof(uint32_t));
+	return watchForChanges();
+}
+
+
+void CameraWatch::close(){
+	if (directory != NULL){
+		CancelIo(directory);
+		CloseHandle(directory);
+	}
+	if (changed != NULL) CloseHandle(changed);
+	delete (OVERLAPPED*)overlapped;
+	directory = changed = overlapped = NULL;
+	SpeedTracker &tracker = site.tracker;
+	if (tracker.statsFile.is_open()) tracker.statsFile.close();
+	if (site.hiLiteSize.area() > 0) tracker.closeHiLites();
+	site.hiLiteSize = Size();
+	day.clear();
+}
+
+
+bool CameraWatch::watchForChanges(){
+// Ask to be told (through the changed event) about files created, renamed or written to anywhere under the IPCam directory.
+	OVERLAPPED* request = (OVERLAPPED*)overlapped;
+	*request = OVERLAPPED();
+	request->hEvent = changed;
+	if (!ReadDirectoryChangesW(directory, changes.data(), DWORD(changes.size() * sizeof(uint32_t)), TRUE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE, NULL, request, NULL)){
+		cout << "Can't watch " << camPath << " for changes." << endl;
+		return false;
+	}
+	return true;
+}
+
+
+void CameraWatch::collectChanges(int waitMsec){
+// Wait up to waitMsec for change notifications, and add any video files they name to the pending files.
+	if (WaitForSingleObject(changed, waitMsec) != WAIT_OBJECT_0) return;
+	DWORD bytes = 0;
+	if (!GetOverlappedResult(directory, (OVERLAPPED*)overlapped, &bytes, FALSE)) bytes = 0;
+	if (bytes == 0) catchUp(todayName("%Y%m%d"));  // Too many changes to hold:  look at the directory itself instead.
+	const char* next = (const char*)changes.data();
+	while (bytes > 0){
+		const FILE_NOTIFY_INFORMATION* change = (const FILE_NOTIFY_INFORMATION*)next;
+		if (change->Action == FILE_ACTION_ADDED || change->Action == FILE_ACTION_MODIFIED || change->Action == FILE_ACTION_RENAMED_NEW_NAME){
+			char name[MAX_PATH];
+			int length = WideCharToMultiByte(CP_ACP, 0, change->FileName, int(change->FileNameLength / sizeof(WCHAR)), name, sizeof(name), NULL, NULL);
+			string relativePath(name, length);
+			if (isDayFile(relativePath) && analyzed.count(relativePath) == 0) pending.insert(relativePath);
+		}
+		if (change->NextEntryOffset == 0) break;
+		next += change->NextEntryOffset;
+	}
+	ResetEvent(changed);
+	watchForChanges();
+}
+
+
+bool CameraWatch::isDayFile(string relativePath){
+// yyyymmdd\<name>.avi (or .y4m or .gray)?
+	if (relativePath.size() < 10 || relativePath[8] != '\\' || relativePath.find('\\', 9) != string::npos) return false;
+	for (int i = 0; i < 8; i++) if (!isdigit(relativePath[i])) return false;
+	string extension = relativePath.substr(relativePath.find_last_of('.') + 1);
+	for (int i = 0; i < extension.size(); i++) extension[i] = tolower(extension[i]);
+	return extension == "avi" || MappedVideo::handles(relativePath);
+}
+
+
+void CameraWatch::catchUp(string dayName){
+// Pend every video file in a day directory that its analyzed.txt doesn't list.
+	ifstream ledger(camPath + dayName + "\\analyzed.txt");
+	string fileName;
+	while (getline(ledger, fileName)) analyzed.insert(dayName + "\\" + fileName);
+	ledger.close();
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA((camPath + dayName + "\\*").c_str(), &found);
+	if (search == INVALID_HANDLE_VALUE) return;
+	do{
+		string relativePath = dayName + "\\" + found.cFileName;
+		if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isDayFile(relativePath) && analyzed.count(relativePath) == 0)
+			pending.insert(relativePath);
+	} while (FindNextFileA(search, &found));
+	FindClose(search);
+}
+
+
+void CameraWatch::startDay(string dayName){
+// Close the previous day's outputs, and open (or reopen, to append to) this day's.
+	SpeedTracker &tracker = site.tracker;
+	if (tracker.statsFile.is_open()) tracker.statsFile.close();
+	if (site.hiLiteSize.area() > 0) tracker.closeHiLites();
+	site.hiLiteSize = Size();
+	day = dayName;
+	string statsPath = g.dataPathPrefix + "\\stats\\stats_" + day + ".csv";
+	bool newStats = !ifstream(statsPath).good();
+	tracker.statsFile.open(statsPath, ios::out | ios::app);
+	if (newStats) tracker.statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
+	if (hiLitesPlease) site.hiLitePath = g.dataPathPrefix + "\\HiLites\\Hilites_" + day + "_" + todayName("%H%M%S") + ".avi";
+	cout << "Stats for " << day << " go to " << statsPath << endl;
+}
+
+
+void CameraWatch::analyze(string relativePath){
+	string dayName = relativePath.substr(0, 8);
+	if (dayName != day) startDay(dayName);
+	site.files.push_back(camPath + relativePath);
+	while (site.takeTurn());
+	site.tracker.finishFile();
+	site.tracker.statsFile.flush();  // This file's speeds are there to see now, not when the day is over.
+	ofstream ledger(camPath + dayName + "\\analyzed.txt", ios::out | ios::app);
+	ledger << relativePath.substr(9) << endl;
+	analyzed.insert(relativePath);
+}
+
+
+void CameraWatch::run(){
+// Analyze files as they are closed, oldest first, until the user presses esc.
+	cout << "Watching " << camPath << " for camera files.  Press esc to stop." << endl;
+	catchUp(todayName("%Y%m%d"));
+	while (!(_kbhit() && _getch() == 27)){
+		collectChanges(pending.empty() ? WATCH_POLL_MSEC : 0);
+		vector<string> ready;
+		for (set<string>::iterator file = pending.begin(); file != pending.end(); file++){
+			string path = camPath + *file;
+			if (GetFileAttributesA(path.c_str()) == INVALID_FILE_ATTRIBUTES){  // Gone (deleted or renamed) before it was analyzed.
+				ready.push_back("");
+				continue;
+			}
+			// The camera holds the file open until the segment is done.  Until then, opening it with no sharing fails.
+			HANDLE probe = CreateFileA(path.c_str(), GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (probe == INVALID_HANDLE_VALUE) break;  // Still being written;  later files wait their turn, to keep time order.
+			CloseHandle(probe);
+			ready.push_back(*file);
+		}
+		for (int i = 0; i < ready.size(); i++){
+			if (!ready[i].empty()) analyze(ready[i]);
+		}
+		pending.erase(pending.begin(), next(pending.begin(), ready.size()));
+		if (ready.empty() && !pending.empty()) Sleep(WATCH_POLL_MSEC);  // Waiting on the camera;  notifications keep meanwhile.
+	}
+	cout << "Stopped watching." << endl;
+}
@@ -0,0 +1,77 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include "SiteEngine.h"
+#include <string>
+#include <set>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+// A CameraWatch analyzes camera files as the camera finishes them, for as long as it runs, with no questions or windows.  It watches
+// the IPCam tree for video files appearing in day directories (IPCam\yyyymmdd), and analyzes each one as soon as the camera closes
+// it.  (An avi's index is written when it is closed, so it can't be read before then;  segments are a few minutes long, so results are
+// minutes behind the camera.)  Each day's speeds are appended to that day's stats file, Stats\stats_yyyymmdd.csv, the same file a run
+// over the whole day directory writes.  An avi can't be appended to, so each day of each run gets its own highlights file,
+// HiLites\Hilites_yyyymmdd_hhmmss.avi, named for when it was started;  it can be read once the day is over or the watch is stopped.
+// Files analyzed are listed in analyzed.txt in their day directory, so a restarted watch catches up on today's files without
+// repeating any.
+
+const int WATCH_POLL_MSEC = 1000;			// How often to check whether files being written have been closed.
+const int WATCH_BUFFER_BYTES = 64 * 1024;	// Change notifications held between polls.  If they overflow, today's directory is rescanned.
+
+class CameraWatch
+{
+public:
+	CameraWatch();
+	~CameraWatch();
+
+	bool open(string inCamPath, Globals& inG, int speedLimit, int hiLiteSpeed);
+	void run();
+	void close();
+
+private:
+
+	bool watchForChanges();
+	void collectChanges(int waitMsec);
+	void catchUp(string dayName);
+	bool isDayFile(string relativePath);
+	void analyze(string relativePath);
+	void startDay(string dayName);
+
+	string camPath;				// IPCam directory, with trailing back-slash
+	Globals g;
+	Site site;					// The tracker, and the files handed to it
+	bool hiLitesPlease = false;
+	string day;					// yyyymmdd whose stats and highlights are open
+	set<string> pending;		// Files seen (yyyymmdd\name), not analyzed yet.  In name order, which is time order.
+	set<string> analyzed;		// Files analyzed already, per analyzed.txt
+
+	void* directory = NULL;		// Windows handles
+	void* changed = NULL;		// Event set when change notifications arrive
+	void* overlapped = NULL;	// OVERLAPPED for the change request outstanding
+	vector<uint32_t> changes;	// Notification buffer;  DWORD aligned, as ReadDirectoryChangesW() requires
+};
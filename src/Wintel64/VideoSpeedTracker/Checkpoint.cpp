@@ -0,0 +1,159 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "Checkpoint.h"
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+
+Checkpoint::Checkpoint()
+{
+}
+
+
+Checkpoint::~Checkpoint()
+{
+}
+
+
+template <typename T> static bool readNumber(map<string, string>& values, string path, string name, T& value){
+// One number from a loaded checkpoint.  False, saying why, if its line is missing or isn't just a number.
+	map<string, string>::iterator found = values.find(name);
+	T parsed;
+	istringstream in((found == values.end()) ? "" : found->second);
+	in >> parsed;
+	if (found == values.end() || in.fail() || !(in >> ws).eof()){
+		cout << "Checkpoint " << path << " has no proper " << name << " line." << endl;
+		return false;
+	}
+	value = parsed;
+	return true;
+}
+
+
+bool Checkpoint::save(string path){
+// Written beside the old checkpoint, then swapped for it, so a crash while saving leaves the previous checkpoint intact.
+	string newPath = path + ".new";
+	ofstream out(newPath, ios::out | ios::trunc);
+	if (!out.is_open()) return false;
+	out << "dirPath = " << dirPath << endl;
+	out << "yesNoAll = " << yesNoAll << endl;
+	out << "runName = " << runName << endl;
+	out << "pleaseTrace = " << pleaseTrace << endl;
+	out << "highLightsPlease = " << highLightsPlease << endl;
+	out << "compactHiLites = " << compactHiLites << endl;
+	out << "deferHiLites = " << deferHiLites << endl;
+	out << "maskCachePlease = " << maskCachePlease << endl;
+	out << "probePlease = " << probePlease << endl;
+	out << "validateProbe = " << validateProbe << endl;
+	out << "screenPlease = " << screenPlease << endl;
+	out << "recordDetections = " << recordDetections << endl;
+	out << "speedLimit = " << speedLimit << endl;
+	out << "egregiousSpeedLowerBound = " << egregiousSpeedLowerBound << endl;
+	out << "crazySpeed = " << crazySpeed << endl;
+	out << "highLightsSpeedLower = " << highLightsSpeedLower << endl;
+	out << "highLightsSpeedUpper = " << highLightsSpeedUpper << endl;
+	out << "minimumProfileArea = " << minimumProfileArea << endl;
+	out << "hiLiteWidth = " << hiLiteWidth << endl;
+	out << "hiLiteHeight = " << hiLiteHeight << endl;
+	out << "hiLiteFPS = " << hiLiteFPS << endl;
+	out << "fileName = " << fileName << endl;
+	out << "frameNumber = " << frameNumber << endl;
+	out << "statsBytes = " << statsBytes << endl;
+	out << "traceBytes = " << traceBytes << endl;
+	out << "hiLiteFrames = " << hiLiteFrames << endl;
+	out << "deferredBytes = " << deferredBytes << endl;
+	out << "summary = " << endl;  // Last:  the summary's own lines follow.
+	summary.write(out);
+	out.close();
+	if (out.fail()) return false;
+	return MoveFileExA(newPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+
+bool Checkpoint::load(string path){
+	ifstream in(path);
+	if (!in.is_open()) return false;
+	map<string, string> values;
+	string line;
+	while (getline(in, line)){
+		if (line == "summary = "){
+			if (!summary.read(in)) cout << "Checkpoint " << path << " has no speed summary." << endl;
+			break;
+		}
+		size_t equals = line.find(" = ");
+		if (equals != string::npos) values[line.substr(0, equals)] = line.substr(equals + 3);
+	}
+	const char* required[] = { "dirPath", "yesNoAll", "runName", "fileName", "frameNumber", "statsBytes", "hiLiteFrames" };
+	for (const char* name : required){
+		if (values.find(name) == values.end()){
+			cout << "Checkpoint " << path << " has no " << name << " line." << endl;
+			return false;
+		}
+	}
+	dirPath = values["dirPath"];
+	yesNoAll = values["yesNoAll"];
+	runName = values["runName"];
+	pleaseTrace = (values["pleaseTrace"] == "1");
+	highLightsPlease = (values["highLightsPlease"] == "1");
+	compactHiLites = (values["compactHiLites"] == "1");
+	deferHiLites = (values["deferHiLites"] == "1");
+	maskCachePlease = (values["maskCachePlease"] == "1");
+	probePlease = (values["probePlease"] == "1");
+	validateProbe = (values["validateProbe"] == "1");
+	screenPlease = (values["screenPlease"] == "1");
+	recordDetections = (values["recordDetections"] == "1");
+	fileName = values["fileName"];
+	deferredBytes = 0;  // Older checkpoints have no deferred highlights line.
+	if (!readNumber(values, path, "speedLimit", speedLimit) || !readNumber(values, path, "egregiousSpeedLowerBound", egregiousSpeedLowerBound)
+		|| !readNumber(values, path, "crazySpeed", crazySpeed) || !readNumber(values, path, "highLightsSpeedLower", highLightsSpeedLower)
+		|| !readNumber(values, path, "highLightsSpeedUpper", highLightsSpeedUpper) || !readNumber(values, path, "minimumProfileArea", minimumProfileArea)
+		|| !readNumber(values, path, "hiLiteWidth", hiLiteWidth) || !readNumber(values, path, "hiLiteHeight", hiLiteHeight)
+		|| !readNumber(values, path, "hiLiteFPS", hiLiteFPS) || !readNumber(values, path, "frameNumber", frameNumber)
+		|| !readNumber(values, path, "statsBytes", statsBytes) || !readNumber(values, path, "traceBytes", traceBytes)
+		|| !readNumber(values, path, "hiLiteFrames", hiLiteFrames)
+		|| (values.count("deferredBytes") && !readNumber(values, path, "deferredBytes", deferredBytes)))
+		return false;
+	if (frameNumber < 0){
+		cout << "Checkpoint " << path << " has a negative frameNumber." << endl;
+		return false;
+	}
+	return true;
+}
+
+
+bool Checkpoint::truncateFile(string path, long long length){
+// Cut a text output file back to length bytes.  Stats and trace files are small, so they are simply rewritten.
+	ifstream in(path, ios::in | ios::binary);
+	if (!in.is_open()) return false;
+	vector<char> kept((size_t)length);
+	in.read(kept.data(), length);
+	if (in.gcount() != length) return false;  // Shorter than at the checkpoint:  not the file the checkpoint describes.
+	in.close();
+	ofstream out(path, ios::out | ios::binary | ios::trunc);
+	out.write(kept.data(), length);
+	return out.good();
+}
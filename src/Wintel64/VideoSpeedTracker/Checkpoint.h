@@ -0,0 +1,81 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <string>
+#include "SpeedSummary.h"
+
+using namespace std;
+
+// A Checkpoint records how far a batch run has got, so a run cut short (crash, reboot, power cut, or esc) can be taken up again
+// with "VideoSpeedTracker -resume" instead of being started over.  Checkpoints are taken only between vehicles, when nothing is in
+// track, so there is no vehicle state to save:  a tracker started empty at the checkpoint's frame pair does exactly what the
+// interrupted run did from there.  The stats and trace files are cut back to their lengths at the checkpoint, and the highlights
+// file to its frame count then, so nothing written after the checkpoint is repeated, and nothing before it is lost.
+// The file is plain text, "name = value" per line, like VST.cfg.
+
+const int CHECKPOINT_SECONDS = 30;  // Least time between checkpoints within a file.  Every file's start is a checkpoint too.
+
+class Checkpoint
+{
+public:
+	Checkpoint();
+	~Checkpoint();
+
+	bool save(string path);
+	bool load(string path);
+
+	static bool truncateFile(string path, long long length);
+
+// The run, as set up by the user
+	string dirPath;					// Directory of the input files
+	string yesNoAll;				// "y" for one file, "*" for all files in files.txt
+	string runName;					// Names the stats, trace and highlights files
+	bool pleaseTrace = false;
+	bool highLightsPlease = false;
+	bool compactHiLites = false;
+	bool deferHiLites = false;
+	bool maskCachePlease = false;
+	bool probePlease = false;
+	bool validateProbe = false;
+	bool screenPlease = false;
+	bool recordDetections = false;
+	int speedLimit = 25;
+	int egregiousSpeedLowerBound = 35;
+	int crazySpeed = 55;
+	int highLightsSpeedLower = 35;
+	int highLightsSpeedUpper = 100;
+	int minimumProfileArea = 100;
+	int hiLiteWidth = 0;			// Input frame size highlights come from, and highlights frame rate
+	int hiLiteHeight = 0;
+	double hiLiteFPS = 0.0;
+
+// How far it has got
+	string fileName;				// Input file being analyzed
+	int frameNumber = 0;			// First frame of the next pair to analyze
+	long long statsBytes = 0;		// Stats file length
+	long long traceBytes = 0;		// Trace file length
+	int hiLiteFrames = 0;			// Frames in the highlights file
+	long long deferredBytes = 0;	// Deferred highlights list length
+	SpeedSummary summary;			// Speeds logged so far from fileName
+};
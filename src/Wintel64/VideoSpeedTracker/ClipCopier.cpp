@@ -0,0 +1,196 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "ClipCopier.h"
+#include <cmath>
+#include <algorithm>
+
+#ifdef VST_FFMPEG
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+#pragma comment(lib, "avformat.lib")
+#pragma comment(lib, "avcodec.lib")
+#pragma comment(lib, "avutil.lib")
+
+
+ClipCopier::ClipCopier()
+{
+}
+
+
+ClipCopier::~ClipCopier()
+{
+	release();
+}
+
+
+bool ClipCopier::open(string videoPath){
+	release();
+	if (avformat_open_input(&format, videoPath.c_str(), NULL, NULL) < 0) return false;
+	if (avformat_find_stream_info(format, NULL) < 0){
+		release();
+		return false;
+	}
+	streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+	if (streamIndex < 0){
+		release();
+		return false;
+	}
+	AVStream* stream = format->streams[streamIndex];
+	AVRational rate = av_guess_frame_rate(format, stream, NULL);
+	FPS = (rate.num > 0 && rate.den > 0) ? av_q2d(rate) : 30.0;
+	timeBase = av_q2d(stream->time_base);
+	startPts = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+	width = stream->codecpar->width;
+	height = stream->codecpar->height;
+	packet = av_packet_alloc();
+	return true;
+}
+
+
+void ClipCopier::release(){
+	av_packet_free(&packet);
+	if (format != NULL) avformat_close_input(&format);
+	streamIndex = -1;
+}
+
+
+bool ClipCopier::isOpened(){
+	return format != NULL;
+}
+
+
+int ClipCopier::frameOf(int64_t pts){
+// Frame numbers from timestamps, as FFmpegDecoder numbers them.
+	return int(floor((pts - startPts) * timeBase * FPS + 0.5));
+}
+
+
+bool ClipCopier::copy(int firstFrame, int lastFrame, string clipPath, int &clipFirstFrame, int &clipLastFrame){
+// Copy frames firstFrame through lastFrame, widened out to GOP boundaries, to clipPath.  clipFirstFrame and clipLastFrame are the
+// frames of the video file the clip actually starts and ends with.
+	clipFirstFrame = clipLastFrame = -1;
+	int64_t target = startPts + int64_t(firstFrame / FPS / timeBase);
+	if (av_seek_frame(format, streamIndex, target, AVSEEK_FLAG_BACKWARD) < 0) return false;
+	AVFormatContext* clip = NULL;
+	if (avformat_alloc_output_context2(&clip, NULL, NULL, clipPath.c_str()) < 0) return false;
+	AVStream* in = format->streams[streamIndex];
+	AVStream* out = avformat_new_stream(clip, NULL);
+	bool ok = (out != NULL && avcodec_parameters_copy(out->codecpar, in->codecpar) >= 0);
+	if (ok){
+		out->codecpar->codec_tag = 0;  // Let the clip's format pick its own tag for the codec.
+		out->time_base = in->time_base;
+		ok = (avio_open(&clip->pb, clipPath.c_str(), AVIO_FLAG_WRITE) >= 0);
+	}
+	bool headerWritten = ok && (avformat_write_header(clip, NULL) >= 0);
+	ok = headerWritten;
+	int64_t offset = AV_NOPTS_VALUE;  // Clip timestamps start from zero.
+	while (ok && av_read_frame(format, packet) >= 0){
+		if (packet->stream_index != streamIndex){
+			av_packet_unref(packet);
+			continue;
+		}
+		int64_t pts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+		int frameNum = frameOf(pts);
+		bool keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+		if (offset == AV_NOPTS_VALUE){
+			if (!keyframe){  // A clip can't start here.
+				av_packet_unref(packet);
+				continue;
+			}
+			offset = (packet->dts != AV_NOPTS_VALUE) ? packet->dts : pts;
+			clipFirstFrame = frameNum;
+		}
+		else if (keyframe && frameNum > lastFrame){  // The next GOP is all after the range.
+			av_packet_unref(packet);
+			break;
+		}
+		if (packet->pts != AV_NOPTS_VALUE) packet->pts -= offset;
+		if (packet->dts != AV_NOPTS_VALUE) packet->dts -= offset;
+		av_packet_rescale_ts(packet, in->time_base, out->time_base);
+		packet->stream_index = out->index;
+		packet->pos = -1;
+		clipLastFrame = max(clipLastFrame, frameNum);
+		ok = (av_interleaved_write_frame(clip, packet) >= 0);  // Takes the packet's data.
+	}
+	if (headerWritten) av_write_trailer(clip);
+	if (clip->pb != NULL) avio_closep(&clip->pb);
+	avformat_free_context(clip);
+	return ok && clipFirstFrame >= 0;
+}
+
+#else  // Built without FFmpeg:  no clips are copied.
+
+ClipCopier::ClipCopier()
+{
+}
+
+
+ClipCopier::~ClipCopier()
+{
+}
+
+
+bool ClipCopier::open(string videoPath){
+	return false;
+}
+
+
+void ClipCopier::release(){
+}
+
+
+bool ClipCopier::isOpened(){
+	return false;
+}
+
+
+int ClipCopier::frameOf(int64_t pts){
+	return -1;
+}
+
+
+bool ClipCopier::copy(int firstFrame, int lastFrame, string clipPath, int &clipFirstFrame, int &clipLastFrame){
+	return false;
+}
+
+#endif
+
+
+double ClipCopier::getFPS(){
+	return FPS;
+}
+
+
+int ClipCopier::getFrameWidth(){
+	return width;
+}
+
+
+int ClipCopier::getFrameHeight(){
+	return height;
+}
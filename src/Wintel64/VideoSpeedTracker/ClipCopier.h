@@ -0,0 +1,68 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// A ClipCopier cuts frame ranges out of a video file into clip files of their own by copying its compressed packets, with no
+// decoding or encoding, so a clip is at the camera's own quality and costs little more than the bytes copied.  A clip can only
+// start on a keyframe, so each is widened out to GOP boundaries:  it starts at the keyframe at or before the first frame asked for,
+// and runs up to the first keyframe after the last.  The clip file's format follows from its name (.avi, .mkv, .mp4).
+//
+// Built only when VST_FFMPEG is defined, as FFmpegDecoder is.  Otherwise open() always fails.
+
+struct AVFormatContext;
+struct AVPacket;
+
+class ClipCopier
+{
+public:
+	ClipCopier();
+	~ClipCopier();
+
+	bool open(string videoPath);
+	void release();
+	bool isOpened();
+
+	bool copy(int firstFrame, int lastFrame, string clipPath, int &clipFirstFrame, int &clipLastFrame);
+
+	double getFPS();
+	int getFrameWidth();
+	int getFrameHeight();
+
+private:
+
+	int frameOf(int64_t pts);
+
+	AVFormatContext* format = NULL;
+	AVPacket* packet = NULL;
+	int streamIndex = -1;
+	int64_t startPts = 0;
+	double timeBase = 0.0;	// Seconds per timestamp tick
+	double FPS = 30.0;
+	int width = 0;
+	int height = 0;
+};
@@ -0,0 +1,132 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "DeferredHiLites.h"
+#include <iostream>
+#include <sstream>
+
+// List layout:  "name = value" lines for dirPath, speedLimit, egregiousSpeedLowerBound and compactHiLites, then one line per clip:
+//     sourceFile, L2R|R2L, speed, area, trackStartFrame, stampFrame; frame x y width height overlap speed; frame x y ...
+
+DeferredHiLites::DeferredHiLites()
+{
+}
+
+
+DeferredHiLites::~DeferredHiLites()
+{
+	close();
+}
+
+
+string DeferredHiLites::pathFor(string hiLitePath){
+	return hiLitePath.substr(0, hiLitePath.find_last_of('.')) + ".vhd";
+}
+
+
+bool DeferredHiLites::open(string path, bool append){
+// Appending carries on a list a checkpoint cut back;  its settings are already at the top.
+	close();
+	listOut.open(path, append ? (ios::out | ios::app) : (ios::out | ios::trunc));
+	if (!listOut.is_open()){
+		cout << "Can't open deferred highlights list " << path << endl;
+		return false;
+	}
+	if (append) return true;
+	listOut << "dirPath = " << dirPath << endl;
+	listOut << "speedLimit = " << speedLimit << endl;
+	listOut << "egregiousSpeedLowerBound = " << egregiousSpeedLowerBound << endl;
+	listOut << "compactHiLites = " << compactHiLites << endl;
+	return listOut.good();
+}
+
+
+void DeferredHiLites::add(const DeferredClip& clip){
+// Flushed, so the list has every clip the stats file has, even if VST is stopped.
+	if (!listOut.is_open()) return;
+	listOut << clip.sourceFile << ", " << ((clip.dir == L2R) ? "L2R" : "R2L") << ", " << clip.speed << ", " << clip.area << ", "
+		<< clip.trackStartFrame << ", " << clip.stampFrame;
+	for (int i = 0; i < clip.marks.size(); i++){
+		const HiLiteMark &mark = clip.marks[i];
+		listOut << "; " << mark.frame << " " << mark.box.x << " " << mark.box.y << " " << mark.box.width << " " << mark.box.height << " "
+			<< int(mark.olap) << " " << mark.estSpeed;
+	}
+	listOut << endl;
+}
+
+
+long long DeferredHiLites::length(){
+	if (!listOut.is_open()) return 0;
+	listOut.flush();
+	return listOut.tellp();
+}
+
+
+void DeferredHiLites::close(){
+	if (listOut.is_open()) listOut.close();
+}
+
+
+bool DeferredHiLites::isOpen(){
+	return listOut.is_open();
+}
+
+
+bool DeferredHiLites::read(string path, vector<DeferredClip>& clips){
+// The list's settings, and its clips.
+	ifstream listIn(path);
+	if (!listIn.is_open()) return false;
+	clips.clear();
+	string line;
+	while (getline(listIn, line)){
+		size_t equals = line.find('=');
+		if (equals != string::npos){
+			string name = line.substr(0, line.find_first_of(" =")), value = line.substr(min(equals + 2, line.length()));
+			if (!value.empty() && value.back() == '\r') value.pop_back();
+			if (name == "dirPath") dirPath = value;
+			else if (name == "speedLimit") speedLimit = stoi(value);
+			else if (name == "egregiousSpeedLowerBound") egregiousSpeedLowerBound = stoi(value);
+			else if (name == "compactHiLites") compactHiLites = (value == "1");
+			continue;
+		}
+		if (line.find(';') == string::npos) continue;  // A clip with no frames
+		istringstream row(line);
+		string head, markText;
+		getline(row, head, ';');
+		DeferredClip clip;
+		char name[260], dirName[4];
+		if (sscanf(head.c_str(), " %259[^,], %3[^,], %d, %d, %d, %d", name, dirName, &clip.speed, &clip.area, &clip.trackStartFrame, &clip.stampFrame) != 6) continue;
+		clip.sourceFile = name;
+		clip.dir = (string(dirName) == "L2R") ? L2R : R2L;
+		while (getline(row, markText, ';')){
+			HiLiteMark mark;
+			int olap;
+			if (sscanf(markText.c_str(), "%d %d %d %d %d %d %d", &mark.frame, &mark.box.x, &mark.box.y, &mark.box.width, &mark.box.height,
+				&olap, &mark.estSpeed) != 7 || mark.frame < 0) continue;  // Malformed, or a mark that was never set
+			mark.olap = OverlapType(olap);
+			clip.marks.push_back(mark);
+		}
+		clips.push_back(clip);
+	}
+	return true;
+}
@@ -0,0 +1,84 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include <opencv\cv.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+using namespace std;
+using namespace cv;
+
+// Deferred highlights:  instead of keeping every annotated frame of every vehicle that might make the highlights file, the tracker
+// keeps a HiLiteMark per frame, saying which frame of the input it was and what was drawn on it.  The clips of qualifying vehicles
+// are listed, one line each, in a file beside where the highlights file would be (Hilites_20160114.avi -> Hilites_20160114.vhd).
+// VideoSpeedTracker -hilites <list> then seeks into the input files for just those frames, draws the vehicle boxes and speeds on them
+// again and writes the highlights file, as the analysis run would have.  The analysis run can then read luma only, and holds no
+// frames for highlights however long a vehicle takes to qualify.
+
+struct HiLiteMark
+{
+	int frame;				// Frame of the input file:  the newer of its pair
+	Rect box;				// Vehicle box drawn, relative to AnalysisBox
+	OverlapType olap;		// Which of its sides were drawn red
+	int estSpeed;			// Speed shown, if > 0
+};
+
+struct DeferredClip
+{
+	string sourceFile;		// Input file name, in the list's dirPath
+	direction dir;
+	int speed;
+	int area;
+	int trackStartFrame;
+	int stampFrame;			// Frame whose date/time stamp goes into the clip
+	vector<HiLiteMark> marks;
+};
+
+class DeferredHiLites
+{
+public:
+	DeferredHiLites();
+	~DeferredHiLites();
+
+	static string pathFor(string hiLitePath);
+
+	bool read(string path, vector<DeferredClip>& clips);
+
+	bool open(string path, bool append);
+	void add(const DeferredClip& clip);
+	long long length();
+	void close();
+	bool isOpen();
+
+// Written at the top of the list by open(), read back by read()
+	string dirPath;					// Directory of the input files
+	int speedLimit = 25;			// For the colors of speeds shown
+	int egregiousSpeedLowerBound = 35;
+	bool compactHiLites = false;
+
+private:
+	ofstream listOut;
+};
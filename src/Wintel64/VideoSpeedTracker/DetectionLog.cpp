@@ -0,0 +1,238 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "DetectionLog.h"
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+// File layout (little endian):
+//   header:  "VSTD", int32 version, int32 AnalysisBox x, y, width, height, int32 SENSITIVITY_VALUE, BLUR_SIZE, L2RStreetY, R2LStreetY
+//   per frame pair:  int32 frame number, uint8 number of queries, then per query:
+//                    int16 region x, y, width, height, int8 number found (-1 == too many), then int16 x, y, width, height per rectangle.
+
+const char detectionLogMagic[4] = { 'V', 'S', 'T', 'D' };
+const int32_t detectionLogVersion = 1;
+
+DetectionLog::DetectionLog()
+{
+}
+
+
+DetectionLog::~DetectionLog()
+{
+	close();
+}
+
+
+void writeInt32(ofstream& out, int32_t value){
+	out.write((const char *)&value, sizeof(value));
+}
+
+void writeRect16(ofstream& out, Rect r){
+	int16_t xywh[4] = { int16_t(r.x), int16_t(r.y), int16_t(r.width), int16_t(r.height) };
+	out.write((const char *)xywh, sizeof(xywh));
+}
+
+bool readInt32(ifstream& in, int32_t& value){
+	in.read((char *)&value, sizeof(value));
+	return in.good();
+}
+
+bool readRect16(ifstream& in, Rect& r){
+	int16_t xywh[4];
+	in.read((char *)xywh, sizeof(xywh));
+	r = Rect(xywh[0], xywh[1], xywh[2], xywh[3]);
+	return in.good();
+}
+
+
+bool DetectionLog::writeHeader(Globals& g){
+	logOut.write(detectionLogMagic, 4);
+	writeInt32(logOut, detectionLogVersion);
+	writeInt32(logOut, g.AnalysisBoxLeft);
+	writeInt32(logOut, g.AnalysisBoxTop);
+	writeInt32(logOut, g.AnalysisBoxWidth);
+	writeInt32(logOut, g.AnalysisBoxHeight);
+	writeInt32(logOut, g.SENSITIVITY_VALUE);
+	writeInt32(logOut, g.BLUR_SIZE);
+	writeInt32(logOut, g.L2RStreetY);
+	writeInt32(logOut, g.R2LStreetY);
+	return logOut.good();
+}
+
+
+bool DetectionLog::readHeader(Globals& g){
+	char magic[4];
+	int32_t version, boxLeft, boxTop, boxWidth, boxHeight, sensitivity, blurSize, L2RStreetY, R2LStreetY;
+	logIn.read(magic, 4);
+	if (!logIn.good() || memcmp(magic, detectionLogMagic, 4) != 0){
+		cout << "Not a detection log." << endl;
+		return false;
+	}
+	if (!readInt32(logIn, version) || version != detectionLogVersion){
+		cout << "Detection log version " << version << " not supported." << endl;
+		return false;
+	}
+	readInt32(logIn, boxLeft);
+	readInt32(logIn, boxTop);
+	readInt32(logIn, boxWidth);
+	readInt32(logIn, boxHeight);
+	readInt32(logIn, sensitivity);
+	readInt32(logIn, blurSize);
+	readInt32(logIn, L2RStreetY);
+	if (!readInt32(logIn, R2LStreetY)) return false;
+
+	// A log made with a different analysis box or preprocessing still replays, but it answers for the recorded configuration, not VST.cfg.
+	if (boxLeft != g.AnalysisBoxLeft || boxTop != g.AnalysisBoxTop || boxWidth != g.AnalysisBoxWidth || boxHeight != g.AnalysisBoxHeight)
+		cout << "Warning: detection log was recorded with a different AnalysisBox than VST.cfg specifies." << endl;
+	if (sensitivity != g.SENSITIVITY_VALUE || blurSize != g.BLUR_SIZE)
+		cout << "Warning: detection log was recorded with SENSITIVITY_VALUE = " << sensitivity << ", BLUR_SIZE = " << blurSize << endl;
+	if (L2RStreetY != g.L2RStreetY || R2LStreetY != g.R2LStreetY)
+		cout << "Warning: hubcap lines differ from recording; lane band detections will be approximated." << endl;
+	return true;
+}
+
+
+bool DetectionLog::openForRecord(string path, Globals& g){
+	close();
+	logOut.open(path, ios::out | ios::binary | ios::trunc);
+	if (!logOut.is_open()){
+		cout << "Can't open detection log " << path << " for recording." << endl;
+		return false;
+	}
+	queries.clear();
+	pairFrameNum = -1;
+	return writeHeader(g);
+}
+
+
+bool DetectionLog::openForReplay(string path, Globals& g){
+	close();
+	logIn.open(path, ios::in | ios::binary);
+	if (!logIn.is_open()){
+		cout << "Can't open detection log " << path << " for replay." << endl;
+		return false;
+	}
+	queries.clear();
+	return readHeader(g);
+}
+
+
+void DetectionLog::close(){
+	if (logOut.is_open()){
+		endPair();
+		logOut.close();
+	}
+	if (logIn.is_open()) logIn.close();
+	queries.clear();
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * R e c o r d i n g * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void DetectionLog::beginPair(int frameNum){
+	pairFrameNum = frameNum;
+	queries.clear();
+}
+
+
+void DetectionLog::record(Rect region, Rect found[], int numFound){
+	DetectionQuery query;
+	query.region = region;
+	query.numFound = numFound;
+	for (int i = 0; i < numFound; i++) query.found.push_back(found[i]);
+	query.used = false;
+	queries.push_back(query);
+}
+
+
+void DetectionLog::endPair(){
+	if (!logOut.is_open() || pairFrameNum < 0) return;
+	writeInt32(logOut, pairFrameNum);
+	uint8_t numQueries = uint8_t(min(int(queries.size()), 255));
+	logOut.write((const char *)&numQueries, 1);
+	for (int q = 0; q < numQueries; q++){
+		writeRect16(logOut, queries[q].region);
+		int8_t numFound = int8_t(queries[q].numFound);
+		logOut.write((const char *)&numFound, 1);
+		for (int i = 0; i < queries[q].numFound; i++) writeRect16(logOut, queries[q].found[i]);
+	}
+	pairFrameNum = -1;  // Written; don't write again on close().
+	queries.clear();
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * R e p l a y * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool DetectionLog::nextPair(int& frameNum){
+	queries.clear();
+	int32_t inFrame;
+	if (!readInt32(logIn, inFrame)) return false;
+	uint8_t numQueries;
+	logIn.read((char *)&numQueries, 1);
+	for (int q = 0; q < numQueries && logIn.good(); q++){
+		DetectionQuery query;
+		int8_t numFound;
+		readRect16(logIn, query.region);
+		logIn.read((char *)&numFound, 1);
+		query.numFound = numFound;
+		for (int i = 0; i < numFound; i++){
+			Rect r;
+			readRect16(logIn, r);
+			query.found.push_back(r);
+		}
+		query.used = false;
+		queries.push_back(query);
+	}
+	if (!logIn.good()) return false;  // Truncated log, e.g. recording run was interrupted.
+	frameNum = inFrame;
+	return true;
+}
+
+
+int DetectionLog::lookup(Rect region, Rect found[], int maxFound, int minArea){
+	// Exact answer: the same region was searched, in order, when the log was recorded.
+	for (int q = 0; q < queries.size(); q++){
+		if (!queries[q].used && queries[q].region == region){
+			queries[q].used = true;
+			int numFound = min(queries[q].numFound, maxFound);
+			for (int i = 0; i < numFound; i++) found[i] = queries[q].found[i];
+			return numFound;
+		}
+	}
+	// Approximate answer: clip blobs from a recorded search that covered this region (normally the whole lane band).
+	for (int q = 0; q < queries.size(); q++){
+		Rect covering = queries[q].region;
+		if (queries[q].numFound >= 0 && covering.y == region.y && covering.height == region.height
+			&& covering.x <= region.x && (covering.x + covering.width) >= (region.x + region.width)){
+			int numFound = 0;
+			for (int i = 0; i < queries[q].numFound && numFound < maxFound; i++){
+				Rect clipped = queries[q].found[i] & region;
+				if (clipped.area() >= minArea) found[numFound++] = clipped;
+			}
+			return numFound;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include <opencv\cv.h>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+// A DetectionLog holds, for each frame pair, every answer the contour finder gave manageMovers(): the region that was searched
+// and the OK-size blob rectangles found there.  Recording one while analyzing video allows the tracker to be re-run later straight
+// from the log, with no decoding, differencing or contour finding.  If the tracker asks exactly the questions it asked when the log
+// was recorded (same tracker logic, same tracker parameters), the replay is exact.  If a search region was never recorded, the
+// answer is approximated by clipping the blobs recorded for the full lane band to that region.
+
+struct DetectionQuery
+{
+	Rect region;			// Region searched, relative to AnalysisBox
+	int numFound;			// -1 if contour finder reported too many objects
+	vector<Rect> found;		// OK-size blob rectangles found, relative to AnalysisBox
+	bool used;				// Already handed back during replay of this frame pair?
+};
+
+class DetectionLog
+{
+public:
+	DetectionLog();
+	~DetectionLog();
+
+	bool openForRecord(string path, Globals& g);
+	bool openForReplay(string path, Globals& g);
+	void close();
+
+	void beginPair(int frameNum);
+	void record(Rect region, Rect found[], int numFound);
+	void endPair();
+
+	bool nextPair(int& frameNum);
+	int lookup(Rect region, Rect found[], int maxFound, int minArea);
+
+private:
+
+	bool writeHeader(Globals& g);
+	bool readHeader(Globals& g);
+
+	ofstream logOut;
+	ifstream logIn;
+
+	int pairFrameNum = -1;  // Frame pair being recorded; -1 when nothing is pending.
+	vector<DetectionQuery> queries;  // All queries for the frame pair currently being recorded or replayed.
+};
@@ -0,0 +1,293 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "FFmpegDecoder.h"
+#include <cmath>
+
+int FFmpegDecoder::decodeThreads = 0;
+
+#ifdef VST_FFMPEG
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#pragma comment(lib, "avformat.lib")
+#pragma comment(lib, "avcodec.lib")
+#pragma comment(lib, "avutil.lib")
+#pragma comment(lib, "swscale.lib")
+
+
+FFmpegDecoder::FFmpegDecoder()
+{
+	frames[0] = frames[1] = NULL;
+}
+
+
+FFmpegDecoder::~FFmpegDecoder()
+{
+	release();
+}
+
+
+bool FFmpegDecoder::open(string videoPath, int inLumaTop, int inLumaHeight){
+// inLumaTop and inLumaHeight are the rows readLuma() hands out;  inLumaHeight of 0 means down to the bottom of the frame.
+	release();
+	if (avformat_open_input(&format, videoPath.c_str(), NULL, NULL) < 0) return false;
+	if (avformat_find_stream_info(format, NULL) < 0){
+		release();
+		return false;
+	}
+	const AVCodec* decoder = NULL;
+	streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+	if (streamIndex < 0){
+		release();
+		return false;
+	}
+	AVStream* stream = format->streams[streamIndex];
+	codec = avcodec_alloc_context3(decoder);
+	avcodec_parameters_to_context(codec, stream->codecpar);
+	codec->thread_count = decodeThreads;  // 0:  one thread per core
+	codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+	if (avcodec_open2(codec, decoder, NULL) < 0){
+		release();
+		return false;
+	}
+
+	// Luma used in place has to be a plane of its own, 8 bits per pixel:  planar YUV (e.g. MJPEG's yuvj420p) or gray.
+	const AVPixFmtDescriptor* pixels = av_pix_fmt_desc_get(codec->pix_fmt);
+	if (pixels == NULL || (pixels->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL)) || pixels->comp[0].depth != 8
+		|| (!(pixels->flags & AV_PIX_FMT_FLAG_PLANAR) && pixels->nb_components != 1)){
+		release();
+		return false;
+	}
+
+	width = codec->width;
+	height = codec->height;
+	setLumaRows(inLumaTop, inLumaHeight);
+	AVRational rate = av_guess_frame_rate(format, stream, NULL);
+	FPS = (rate.num > 0 && rate.den > 0) ? av_q2d(rate) : 30.0;
+	timeBase = av_q2d(stream->time_base);
+	startPts = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+	frameCount = (stream->nb_frames > 0) ? int(stream->nb_frames) : int(format->duration * FPS / AV_TIME_BASE);
+
+	packet = av_packet_alloc();
+	frames[0] = av_frame_alloc();
+	frames[1] = av_frame_alloc();
+	current = 0;
+	pending = false;
+	frameIndex = -1;
+	msec = -1.0;
+	timed = true;
+	if (!decodeNext()){  // The first frame, decoded now, tells seek() whether frames carry timestamps.
+		release();
+		return false;
+	}
+	pending = true;
+	return true;
+}
+
+
+void FFmpegDecoder::release(){
+	if (toBGR != NULL) sws_freeContext(toBGR);
+	toBGR = NULL;
+	av_frame_free(&frames[0]);
+	av_frame_free(&frames[1]);
+	av_packet_free(&packet);
+	avcodec_free_context(&codec);
+	if (format != NULL) avformat_close_input(&format);
+	streamIndex = -1;
+}
+
+
+bool FFmpegDecoder::isOpened(){
+	return codec != NULL;
+}
+
+
+bool FFmpegDecoder::decodeNext(){
+// Decode the next frame into the older of the two frames, leaving the one last handed out alone.
+	AVFrame* frame = frames[current ^ 1];
+	av_frame_unref(frame);
+	while (true){
+		int result = avcodec_receive_frame(codec, frame);
+		if (result == 0) break;
+		if (result != AVERROR(EAGAIN)) return false;  // End of file, or a decoding error.
+		if (av_read_frame(format, packet) < 0){
+			avcodec_send_packet(codec, NULL);  // End of file:  drain the frames still in the decoder threads.
+			continue;
+		}
+		if (packet->stream_index == streamIndex) avcodec_send_packet(codec, packet);
+		av_packet_unref(packet);
+	}
+	current ^= 1;
+
+	int64_t pts = frame->best_effort_timestamp;
+	if (pts == AV_NOPTS_VALUE){  // No timestamp:  count.
+		timed = false;
+		frameIndex++;
+		msec = frameIndex * 1000.0 / FPS;
+	}
+	else{
+		msec = (pts - startPts) * timeBase * 1000.0;
+		frameIndex = int(floor(msec * FPS / 1000.0 + 0.5));
+	}
+	return true;
+}
+
+
+bool FFmpegDecoder::seek(int frameNum){
+// Back to the keyframe at or before frameNum, then decode forward to it.  The next read returns frame frameNum exactly.
+// Frames without timestamps are numbered by counting from the start of the file, which a jump to a keyframe would lose;  so then
+// seek() only goes forward, decoding every frame on the way, and fails if asked to go back.
+	if (!timed){
+		int next = pending ? frameIndex : frameIndex + 1;  // Frame the next read would return
+		if (frameNum < next) return false;
+		if (frameNum == next) return true;
+		pending = false;
+		do {
+			if (!decodeNext()) return false;
+		} while (frameIndex < frameNum);
+		pending = true;
+		return true;
+	}
+	int64_t target = startPts + int64_t(frameNum / FPS / timeBase);
+	if (av_seek_frame(format, streamIndex, target, AVSEEK_FLAG_BACKWARD) < 0) return false;
+	avcodec_flush_buffers(codec);
+	pending = false;
+	frameIndex = -1;
+	do {
+		if (!decodeNext()) return false;
+		if (!timed) return false;  // Timestamps stopped partway through the file:  where this is is unknown.
+	} while (frameIndex < frameNum);
+	pending = true;
+	return true;
+}
+
+
+bool FFmpegDecoder::readLuma(Mat &luma){
+// The Y plane rows asked for at open(), in the decoder's own buffer.  Good until the read after next.
+	if (pending) pending = false;
+	else if (!decodeNext()) return false;
+	AVFrame* frame = frames[current];
+	luma = Mat(lumaHeight, width, CV_8UC1, frame->data[0] + lumaTop * frame->linesize[0], frame->linesize[0]);
+	return true;
+}
+
+
+bool FFmpegDecoder::readBGR(Mat &frame){
+// The whole frame, in color.
+	if (pending) pending = false;
+	else if (!decodeNext()) return false;
+	AVFrame* source = frames[current];
+	toBGR = sws_getCachedContext(toBGR, width, height, AVPixelFormat(source->format), width, height, AV_PIX_FMT_BGR24,
+		SWS_BILINEAR, NULL, NULL, NULL);
+	frame.create(height, width, CV_8UC3);
+	uint8_t* planes[1] = { frame.data };
+	int strides[1] = { int(frame.step) };
+	sws_scale(toBGR, source->data, source->linesize, 0, height, planes, strides);
+	return true;
+}
+
+#else  // Built without FFmpeg:  VideoFile always uses VideoCapture.
+
+FFmpegDecoder::FFmpegDecoder()
+{
+	frames[0] = frames[1] = NULL;
+}
+
+
+FFmpegDecoder::~FFmpegDecoder()
+{
+}
+
+
+bool FFmpegDecoder::open(string videoPath, int inLumaTop, int inLumaHeight){
+	return false;
+}
+
+
+void FFmpegDecoder::release(){
+}
+
+
+bool FFmpegDecoder::isOpened(){
+	return false;
+}
+
+
+bool FFmpegDecoder::seek(int frameNum){
+	return false;
+}
+
+
+bool FFmpegDecoder::readLuma(Mat &luma){
+	return false;
+}
+
+
+bool FFmpegDecoder::readBGR(Mat &frame){
+	return false;
+}
+
+#endif
+
+
+int FFmpegDecoder::getFrameIndex(){
+	return frameIndex;
+}
+
+
+double FFmpegDecoder::getMsec(){
+	return msec;
+}
+
+
+int FFmpegDecoder::getFrameCount(){
+	return frameCount;
+}
+
+
+double FFmpegDecoder::getFPS(){
+	return FPS;
+}
+
+
+void FFmpegDecoder::setLumaRows(int inLumaTop, int inLumaHeight){
+// Change the rows readLuma() hands out, e.g. once the frame size is known.  A height of 0 means to the bottom.
+	lumaTop = min(max(inLumaTop, 0), height);
+	lumaHeight = (inLumaHeight > 0) ? min(inLumaHeight, height - lumaTop) : height - lumaTop;
+}
+
+
+int FFmpegDecoder::getFrameHeight(){
+	return height;
+}
+
+
+int FFmpegDecoder::getFrameWidth(){
+	return width;
+}
@@ -0,0 +1,94 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+using namespace cv;
+
+// An FFmpegDecoder decodes video with libavcodec directly, rather than through VideoCapture, so motion detection gets what it
+// needs and no more:  the decoder's own luma (Y) plane, used in place, limited to the rows of the AnalysisBox, with no color
+// conversion at all.  The decoder runs frame and slice threads.  Frame numbers and presentation times come from each frame's
+// own timestamp, not from counting, unless the file has none.  Color frames, for highlights and ProcessHiLites, are converted only when asked for.
+//
+// Built only when VST_FFMPEG is defined, with FFmpeg's include and lib directories added to the project.  Otherwise open()
+// always fails, and VideoFile uses VideoCapture as before.
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+struct SwsContext;
+
+class FFmpegDecoder
+{
+public:
+	FFmpegDecoder();
+	~FFmpegDecoder();
+
+	bool open(string videoPath, int inLumaTop, int inLumaHeight);
+	void release();
+	bool isOpened();
+
+	bool seek(int frameNum);
+	bool readLuma(Mat &luma);
+	bool readBGR(Mat &frame);
+	void setLumaRows(int inLumaTop, int inLumaHeight);
+
+	int getFrameIndex();	// Number of the frame last read (or sought).
+	double getMsec();		// Its presentation time, from the start of the file.
+	int getFrameCount();
+	double getFPS();
+	int getFrameWidth();
+	int getFrameHeight();
+
+	static int decodeThreads;	// Threads each decoder opened from now on uses.  0 (the default) for one per core.
+
+private:
+
+	bool decodeNext();
+
+	AVFormatContext* format = NULL;
+	AVCodecContext* codec = NULL;
+	AVPacket* packet = NULL;
+	AVFrame* frames[2];		// The frame last handed out (which the caller may still be looking at) and the one before it.
+	int current = 0;
+	bool pending = false;	// frames[current] was decoded by seek() and not handed out yet.
+	SwsContext* toBGR = NULL;
+
+	int streamIndex = -1;
+	int64_t startPts = 0;
+	double timeBase = 0.0;	// Seconds per timestamp tick
+	double FPS = 30.0;
+	int frameCount = 0;
+	int width = 0;
+	int height = 0;
+	int lumaTop = 0;		// Rows of luma handed out by readLuma()
+	int lumaHeight = 0;
+	int frameIndex = -1;
+	double msec = -1.0;
+	bool timed = true;		// Every frame decoded so far had a timestamp
+};
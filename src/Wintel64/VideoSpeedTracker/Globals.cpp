@@ -1,250 +1,369 @@
-//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
-//                                     All rights reserved.
-
-//                                     License Agreement
-//                                For VideoSpeedTracker (VST)
-//                                 (3 - clause BSD License)
-
-// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
-// conditions are met :
-
-// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
-// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
-//      in the documentation and / or other materials provided with the distribution.
-// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-
-// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
-// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
-// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
-// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
-// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
-// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
-
-
-#include "Globals.h"
-#include <queue>
-#include <iostream>
-#include <fstream>
-#include <sstream>
-// #include <string>
-
-using namespace std;
-
-Globals::Globals()
-{
-}
-
-
-Globals::~Globals()
-{
-}
-
-string inLine, lhs, rhs;
-
-
-bool getSides(string inLine){
-	string tempLHS, tempRHS;
-	istringstream configLine(inLine);
-	getline(configLine, tempLHS, '=');
-	getline(configLine, tempRHS, '#');
-	lhs = tempLHS;
-	rhs = tempRHS;
-	return true;
-}
-
-string trim(string toBeTrimmed){
-	int first = 0;
-	while (toBeTrimmed.substr(first, 1) == " ") first++;
-	int last = toBeTrimmed.length() - 1;
-	while (toBeTrimmed.substr(last, 1) == " ") last--;
-	return toBeTrimmed.substr(first, (last-first)+1);
-}
-
-
-
-bool Globals::readConfig(){
-
-// Items in config file VST.cfg must conform WRT order and spelling of LHS items, as follows:
-//  VST.cfg must use syntax:  <LHS> = <RHS> # 
-//                                            ^^^^^ Anything can follow the #
-	string lhsString[23] = {
-		"dataPathPrefix",
-		"L2RDirection",
-		"R2LDirection",
-		"obstruction", 
-		"AnalysisBoxLeft",
-		"AnalysisBoxTop",
-		"AnalysisBoxWidth",
-		"AnalysisBoxHeight",
-		"speedLineLeft",
-		"speedLineRight",
-		"maxL2RDistOnEntry",
-		"maxR2LDistOnEntry",
-		"entryLookBack",
-		"obstruction_extent",
-		"largeVehicleArea",
-		"CalibrationFramesL2R",
-		"CalibrationFramesR2L",
-		"SENSITIVITY_VALUE",
-		"BLUR_SIZE",
-		"SLOP",
-		"R2LStreetY",
-		"L2RStreetY",
-		"nextHeight"
-	};
-
-
-	ifstream configIn("VST.cfg");
-	if (!configIn.good()){
-		cout << "Can't open VST.cfg." << endl;
-		return false;
-	}
-
-	int place, place2;
-	int lineNo = 0;
-	while (!configIn.eof()){
-		getline(configIn, inLine);
-		if (!configIn){
-			cout << "Unexpected error in config file." << endl;
-			return false;
-		}
-		if (getSides(inLine)){
-			lhs = trim(lhs);
-			rhs = trim(rhs);
-			if (lhs != lhsString[lineNo]){
-				cout << "Just read LHS doesn't match anything: <" << lhs << ">.  Aborting" << endl;
-				return false;
-			}
-			switch (lineNo){
-			case 0:             // dataPathPrefix
-				dataPathPrefix = rhs;
-				cout << "dataPathPrefix = " << dataPathPrefix << endl;
-				break;
-			case 1:             // L2RDirection
-				L2RDirection = rhs;
-				cout << "L2RDirection = " << L2RDirection << endl;
-				break;
-			case 2:             // R2LDirection
-				R2LDirection = rhs;
-				cout << "R2LDirection = " << R2LDirection << endl;
-				break;
-			case 3:             // obstruction  (If no foreground obstructions in scene, just make first value >= second value)
-				place = rhs.find(',');
-				place2 = rhs.find(']');
-				obstruction[0] = stoi(rhs.substr(1, place - 1));
-				obstruction[1] = stoi(rhs.substr(place + 1, (place2 - place) - 1));
-				cout << "obstruction[0] = " << obstruction[0] << endl;
-				cout << "obstruction[1] = " << obstruction[1] << endl;
-				break;
-			case 4:             // AnalysisBoxLeft     ( must be >= 0 and <= 1279)
-				AnalysisBoxLeft = stoi(rhs);
-				cout << "AnalysisBoxLeft = " << AnalysisBoxLeft << endl;
-				break;
-			case 5:             // AnalysisBoxTop      ( must be >= 0 and <= 719)
-				AnalysisBoxTop = stoi(rhs);
-				cout << "AnalysisBoxTop = " << AnalysisBoxTop << endl;
-				break;
-			case 6:             // AnalysisBoxWidth       ( must be >= 0 and <= (1279 - AnalysisBoxLeft))
-				AnalysisBoxWidth = stoi(rhs);
-				cout << "AnalysisBoxWidth = " << AnalysisBoxWidth << endl;
-				break;
-			case 7:             // AnalysisBoxHeight            ( must be >= 0 and <= (719 - AnalysisBoxTop))
-				AnalysisBoxHeight = stoi(rhs);
-				cout << "AnalysisBoxHeight = " << AnalysisBoxHeight << endl;
-				break;
-			case 8:             // speedLineLeft              (relative to AnalysisBoxLeft.  Must be >= 0 and <= (719 - AnalysisBoxWidth))
-				speedLineLeft = stoi(rhs);
-				cout << "speedLineLeft = " << speedLineLeft << endl;
-				break;
-			case 9:             // speedLineRight          (relative to AnalysisBoxLeft.  Must be > speedLineLeft and <= (719 - AnalysisBoxWidth))
-				speedLineRight = stoi(rhs);
-				cout << "speedLineRight = " << speedLineRight << endl;
-				break;
-			case 10:             // maxL2RDistOnEntry
-				maxL2RDistOnEntry = stoi(rhs);
-				cout << "maxL2RDistOnEntry = " << maxL2RDistOnEntry << endl;
-				break;
-			case 11:             // maxR2LDistOnEntry
-				maxR2LDistOnEntry = stoi(rhs);
-				cout << "maxR2LDistOnEntry = " << maxR2LDistOnEntry << endl;
-				break;
-			case 12:             // entryLookBack
-				entryLookBack = stoi(rhs);
-				cout << "entryLookBack = " << entryLookBack << endl;
-				break;
-			case 13:             // obstruction_extent
-				obstruction_extent = stoi(rhs);
-				cout << "obstruction_extent = " << obstruction_extent << endl;
-				break;
-			case 14:             // largeVehicleArea
-				largeVehicleArea = stoi(rhs);
-				cout << "largeVehicleArea = " << largeVehicleArea << endl;
-				break;
-			case 15:             // CalibrationFramesL2R     (How many frames does it take a L2R vehicle to pass thru speed zone at speed limit?)
-				CalibrationFramesL2R = stoi(rhs);
-				cout << "CalibrationFramesL2R = " << CalibrationFramesL2R << endl;
-				break;
-			case 16:             // CalibrationFramesR2L     (How many frames does it take a R2L vehicle to pass thru speed zone at speed limit?)
-				CalibrationFramesR2L = stoi(rhs);
-				cout << "CalibrationFramesR2L = " << CalibrationFramesR2L << endl;
-				break;
-			case 17:             // SENSITIVITY_VALUE
-				SENSITIVITY_VALUE = stoi(rhs);
-				cout << "SENSITIVITY_VALUE = " << SENSITIVITY_VALUE << endl;
-				break;
-			case 18:             // BLUR_SIZE
-				BLUR_SIZE = stoi(rhs);
-				cout << "BLUR_SIZE = " << BLUR_SIZE << endl;
-				break;
-			case 19:             // SLOP
-				SLOP = stoi(rhs);
-				cout << "SLOP = " << SLOP << endl;
-				break;
-			case 20:             // R2LStreetY         (R2L hubcap line)
-				R2LStreetY = stoi(rhs);
-				cout << "R2LStreetY = " << R2LStreetY << endl;
-				break;
-			case 21:             // L2RStreetY         (L2R hubcap line)
-				L2RStreetY = stoi(rhs);
-				cout << "L2RStreetY = " << L2RStreetY << endl;
-				break;
-			case 22:             // nextHeight
-				nextHeight = stoi(rhs);
-				cout << "nextHeight = " << nextHeight << endl;
-				break;
-
-			default:
-				if (lineNo > 22){
-					cout << "Too many lines in config file.  Abortiing." << endl;
-					return false;
-				}
-			} // switch
-			lineNo++;
-		
-		}
-		else{
-			cout << "getSides() failed in config reader.  Check VST.cfg syntax.  Aborting " << endl;
-			configIn.close();
-			return false;
-		}
-		
-
-
-	}  // while not eof
-
-	configIn.close();
-
-	if ((AnalysisBoxLeft + AnalysisBoxWidth) > 1279){
-		cout << "Analysis box too wide.  Must be <= 1279. Check config file.  Aborting." << endl;
-		return false;
-	}
-	else if ((AnalysisBoxTop + AnalysisBoxHeight) > 719){
-		cout << "Analysis box too high.  Must be <= 719.  Check config file.  Aborting." << endl;
-		return false;
-	}
-	return true;
-};
-
-
-
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+
+#include "Globals.h"
+#include <queue>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+// #include <string>
+
+using namespace std;
+
+Globals::Globals()
+{
+}
+
+
+Globals::~Globals()
+{
+}
+
+string inLine, lhs, rhs;
+
+
+bool getSides(string inLine){
+	string tempLHS, tempRHS;
+	istringstream configLine(inLine);
+	getline(configLine, tempLHS, '=');
+	getline(configLine, tempRHS, '#');
+	lhs = tempLHS;
+	rhs = tempRHS;
+	return true;
+}
+
+string trim(string toBeTrimmed){
+	int first = 0;
+	while (toBeTrimmed.substr(first, 1) == " ") first++;
+	int last = toBeTrimmed.length() - 1;
+	while (toBeTrimmed.substr(last, 1) == " ") last--;
+	return toBeTrimmed.substr(first, (last-first)+1);
+}
+
+string stripped(string field){
+	int first = field.find_first_not_of(" \t");
+	if (first == string::npos) return "";
+	return field.substr(first, field.find_last_not_of(" \t") - first + 1);
+}
+
+bool readInt(string field, int &value){
+	if (field.empty()) return false;
+	char* end;
+	long number = strtol(field.c_str(), &end, 10);
+	if (*end != '\0') return false;
+	value = int(number);
+	return true;
+}
+
+bool readDouble(string field, double &value){
+	if (field.empty()) return false;
+	char* end;
+	double number = strtod(field.c_str(), &end);
+	if (*end != '\0') return false;
+	value = number;
+	return true;
+}
+
+
+thread_local ostream* consoleBuffer = NULL;
+
+ostream& console(){
+	return (consoleBuffer != NULL) ? *consoleBuffer : cout;
+}
+
+
+
+bool Globals::readConfig(string configPath){
+
+// Items in config file VST.cfg must conform WRT order and spelling of LHS items, as follows (the last four may be left out):
+//  VST.cfg must use syntax:  <LHS> = <RHS> # 
+//                                            ^^^^^ Anything can follow the #
+	string lhsString[27] = {
+		"dataPathPrefix",
+		"L2RDirection",
+		"R2LDirection",
+		"obstruction", 
+		"AnalysisBoxLeft",
+		"AnalysisBoxTop",
+		"AnalysisBoxWidth",
+		"AnalysisBoxHeight",
+		"speedLineLeft",
+		"speedLineRight",
+		"maxL2RDistOnEntry",
+		"maxR2LDistOnEntry",
+		"entryLookBack",
+		"obstruction_extent",
+		"largeVehicleArea",
+		"CalibrationFramesL2R",
+		"CalibrationFramesR2L",
+		"SENSITIVITY_VALUE",
+		"BLUR_SIZE",
+		"SLOP",
+		"R2LStreetY",
+		"L2RStreetY",
+		"nextHeight",
+		"ReferenceWidth",
+		"ReferenceHeight",
+		"ReferenceFPS",
+		"ProcessingScale"
+	};
+
+
+	ifstream configIn(configPath);
+	if (!configIn.good()){
+		cout << "Can't open " << configPath << "." << endl;
+		return false;
+	}
+
+	int place, place2;
+	int lineNo = 0;
+	while (!configIn.eof()){
+		getline(configIn, inLine);
+		if (!configIn){
+			cout << "Unexpected error in config file." << endl;
+			return false;
+		}
+		if (getSides(inLine)){
+			lhs = trim(lhs);
+			rhs = trim(rhs);
+			if (lhs != lhsString[lineNo]){
+				cout << "Just read LHS doesn't match anything: <" << lhs << ">.  Aborting" << endl;
+				return false;
+			}
+			switch (lineNo){
+			case 0:             // dataPathPrefix
+				dataPathPrefix = rhs;
+				cout << "dataPathPrefix = " << dataPathPrefix << endl;
+				break;
+			case 1:             // L2RDirection
+				L2RDirection = rhs;
+				cout << "L2RDirection = " << L2RDirection << endl;
+				break;
+			case 2:             // R2LDirection
+				R2LDirection = rhs;
+				cout << "R2LDirection = " << R2LDirection << endl;
+				break;
+			case 3:             // obstruction  (If no foreground obstructions in scene, just make first value >= second value)
+				place = rhs.find(',');
+				place2 = rhs.find(']');
+				obstruction[0] = stoi(rhs.substr(1, place - 1));
+				obstruction[1] = stoi(rhs.substr(place + 1, (place2 - place) - 1));
+				cout << "obstruction[0] = " << obstruction[0] << endl;
+				cout << "obstruction[1] = " << obstruction[1] << endl;
+				break;
+			case 4:             // AnalysisBoxLeft     ( must be >= 0 and <= 1279)
+				AnalysisBoxLeft = stoi(rhs);
+				cout << "AnalysisBoxLeft = " << AnalysisBoxLeft << endl;
+				break;
+			case 5:             // AnalysisBoxTop      ( must be >= 0 and <= 719)
+				AnalysisBoxTop = stoi(rhs);
+				cout << "AnalysisBoxTop = " << AnalysisBoxTop << endl;
+				break;
+			case 6:             // AnalysisBoxWidth       ( must be >= 0 and <= (1279 - AnalysisBoxLeft))
+				AnalysisBoxWidth = stoi(rhs);
+				cout << "AnalysisBoxWidth = " << AnalysisBoxWidth << endl;
+				break;
+			case 7:             // AnalysisBoxHeight            ( must be >= 0 and <= (719 - AnalysisBoxTop))
+				AnalysisBoxHeight = stoi(rhs);
+				cout << "AnalysisBoxHeight = " << AnalysisBoxHeight << endl;
+				break;
+			case 8:             // speedLineLeft              (relative to AnalysisBoxLeft.  Must be >= 0 and <= (719 - AnalysisBoxWidth))
+				speedLineLeft = stoi(rhs);
+				cout << "speedLineLeft = " << speedLineLeft << endl;
+				break;
+			case 9:             // speedLineRight          (relative to AnalysisBoxLeft.  Must be > speedLineLeft and <= (719 - AnalysisBoxWidth))
+				speedLineRight = stoi(rhs);
+				cout << "speedLineRight = " << speedLineRight << endl;
+				break;
+			case 10:             // maxL2RDistOnEntry
+				maxL2RDistOnEntry = stoi(rhs);
+				cout << "maxL2RDistOnEntry = " << maxL2RDistOnEntry << endl;
+				break;
+			case 11:             // maxR2LDistOnEntry
+				maxR2LDistOnEntry = stoi(rhs);
+				cout << "maxR2LDistOnEntry = " << maxR2LDistOnEntry << endl;
+				break;
+			case 12:             // entryLookBack
+				entryLookBack = stoi(rhs);
+				cout << "entryLookBack = " << entryLookBack << endl;
+				break;
+			case 13:             // obstruction_extent
+				obstruction_extent = stoi(rhs);
+				cout << "obstruction_extent = " << obstruction_extent << endl;
+				break;
+			case 14:             // largeVehicleArea
+				largeVehicleArea = stoi(rhs);
+				cout << "largeVehicleArea = " << largeVehicleArea << endl;
+				break;
+			case 15:             // CalibrationFramesL2R     (How many frames does it take a L2R vehicle to pass thru speed zone at speed limit?)
+				CalibrationFramesL2R = stoi(rhs);
+				cout << "CalibrationFramesL2R = " << CalibrationFramesL2R << endl;
+				break;
+			case 16:             // CalibrationFramesR2L     (How many frames does it take a R2L vehicle to pass thru speed zone at speed limit?)
+				CalibrationFramesR2L = stoi(rhs);
+				cout << "CalibrationFramesR2L = " << CalibrationFramesR2L << endl;
+				break;
+			case 17:             // SENSITIVITY_VALUE
+				SENSITIVITY_VALUE = stoi(rhs);
+				cout << "SENSITIVITY_VALUE = " << SENSITIVITY_VALUE << endl;
+				break;
+			case 18:             // BLUR_SIZE
+				BLUR_SIZE = stoi(rhs);
+				cout << "BLUR_SIZE = " << BLUR_SIZE << endl;
+				break;
+			case 19:             // SLOP
+				SLOP = stoi(rhs);
+				cout << "SLOP = " << SLOP << endl;
+				break;
+			case 20:             // R2LStreetY         (R2L hubcap line)
+				R2LStreetY = stoi(rhs);
+				cout << "R2LStreetY = " << R2LStreetY << endl;
+				break;
+			case 21:             // L2RStreetY         (L2R hubcap line)
+				L2RStreetY = stoi(rhs);
+				cout << "L2RStreetY = " << L2RStreetY << endl;
+				break;
+			case 22:             // nextHeight
+				nextHeight = stoi(rhs);
+				cout << "nextHeight = " << nextHeight << endl;
+				break;
+			case 23:             // ReferenceWidth      (frame width the values above were measured at)
+				ReferenceWidth = stoi(rhs);
+				cout << "ReferenceWidth = " << ReferenceWidth << endl;
+				break;
+			case 24:             // ReferenceHeight
+				ReferenceHeight = stoi(rhs);
+				cout << "ReferenceHeight = " << ReferenceHeight << endl;
+				break;
+			case 25:             // ReferenceFPS        (frame rate the values above were measured at)
+				ReferenceFPS = stod(rhs);
+				cout << "ReferenceFPS = " << ReferenceFPS << endl;
+				break;
+			case 26:             // ProcessingScale     (must be > 0 and <= 1)
+				ProcessingScale = stod(rhs);
+				cout << "ProcessingScale = " << ProcessingScale << endl;
+				break;
+
+			default:
+				if (lineNo > 26){
+					cout << "Too many lines in config file.  Abortiing." << endl;
+					return false;
+				}
+			} // switch
+			lineNo++;
+		
+		}
+		else{
+			cout << "getSides() failed in config reader.  Check VST.cfg syntax.  Aborting " << endl;
+			configIn.close();
+			return false;
+		}
+		
+
+
+	}  // while not eof
+
+	configIn.close();
+
+	if ((AnalysisBoxLeft + AnalysisBoxWidth) > ReferenceWidth - 1){
+		cout << "Analysis box too wide.  Must be <= " << ReferenceWidth - 1 << ". Check config file.  Aborting." << endl;
+		return false;
+	}
+	else if ((AnalysisBoxTop + AnalysisBoxHeight) > ReferenceHeight - 1){
+		cout << "Analysis box too high.  Must be <= " << ReferenceHeight - 1 << ".  Check config file.  Aborting." << endl;
+		return false;
+	}
+	else if (ProcessingScale <= 0.0 || ProcessingScale > 1.0 || ReferenceFPS <= 0.0){
+		cout << "ProcessingScale must be > 0 and <= 1, and ReferenceFPS > 0.  Check config file.  Aborting." << endl;
+		return false;
+	}
+	scaleTo(ReferenceWidth, ReferenceHeight, ReferenceFPS, 1.0);  // Input and processing pixels are reference pixels until a video says otherwise.
+	return true;
+};
+
+
+int scaled(int value, double scale){
+	return int(floor(value * scale + 0.5));
+}
+
+
+void Globals::scaleTo(int inputWidth, int inputHeight, double inFPS, double processingScale){
+// Convert the values read from VST.cfg, measured on ReferenceWidth x ReferenceHeight frames at ReferenceFPS, for video of another size
+// and rate, analyzed at processingScale of its own size.  Call on a fresh copy of the Globals read from VST.cfg:  values are scaled
+// in place.  With reference size and rate video at scale 1, nothing changes.
+	double inputX = double(inputWidth) / ReferenceWidth;  // Input pixels per reference pixel
+	double inputY = double(inputHeight) / ReferenceHeight;
+	inputBoxLeft = scaled(AnalysisBoxLeft, inputX);
+	inputBoxTop = scaled(AnalysisBoxTop, inputY);
+	inputBoxWidth = min(scaled(AnalysisBoxWidth, inputX), inputWidth - inputBoxLeft);
+	inputBoxHeight = min(scaled(AnalysisBoxHeight, inputY), inputHeight - inputBoxTop);
+	inputFPS = (inFPS > 0.0) ? inFPS : ReferenceFPS;
+
+	scaleX = inputX * processingScale;
+	scaleY = inputY * processingScale;
+	frameWidth = scaled(inputWidth, processingScale);
+	frameHeight = scaled(inputHeight, processingScale);
+	AnalysisBoxLeft = scaled(inputBoxLeft, processingScale);
+	AnalysisBoxTop = scaled(inputBoxTop, processingScale);
+	AnalysisBoxWidth = max(scaled(inputBoxWidth, processingScale), 1);
+	AnalysisBoxHeight = max(scaled(inputBoxHeight, processingScale), 1);
+	pixelRight = AnalysisBoxWidth;
+
+	double perPair = scaleX * ReferenceFPS / inputFPS;  // Distances covered in one frame pair grow as the frame rate drops.
+	obstruction[0] = scaled(obstruction[0], scaleX);
+	obstruction[1] = scaled(obstruction[1], scaleX);
+	speedLineLeft = scaled(speedLineLeft, scaleX);
+	speedLineRight = scaled(speedLineRight, scaleX);
+	maxL2RDistOnEntry = scaled(maxL2RDistOnEntry, perPair);
+	maxR2LDistOnEntry = scaled(maxR2LDistOnEntry, perPair);
+	entryLookBack = scaled(entryLookBack, scaleX);
+	obstruction_extent = scaled(obstruction_extent, scaleX);
+	BLUR_SIZE = max(scaled(BLUR_SIZE, min(scaleX, scaleY)), 1);
+	SLOP = scaled(SLOP, scaleX);
+	R2LStreetY = scaled(R2LStreetY, scaleY);
+	L2RStreetY = scaled(L2RStreetY, scaleY);
+	R2LBandTop = scaled(R2LBandTop, scaleY);
+	L2RBandTop = scaled(L2RBandTop, scaleY);
+	R2LOwnedTop = scaled(R2LOwnedTop, scaleY);
+	R2LOwnedBottom = scaled(R2LOwnedBottom, scaleY);
+	L2ROwnedTop = scaled(L2ROwnedTop, scaleY);
+	L2ROwnedBottom = scaled(L2ROwnedBottom, scaleY);
+	nextHeight = scaled(nextHeight, scaleY);
+	areaUnit = areaUnit * scaleX * scaleY;  // So vehicle areas, and largeVehicleArea, read the same at any frame size.
+	entryNextY = scaled(entryNextY, scaleY);
+	entryVelocity = max(scaled(entryVelocity, perPair), 1);
+	edgeTolerance = scaled(edgeTolerance, scaleX);
+	centerTolerance = scaled(centerTolerance, scaleX);
+	overrunGap = scaled(overrunGap, scaleX);
+	searchBehind = scaled(searchBehind, scaleX);
+	searchAhead = scaled(searchAhead, scaleX);
+	searchBeyond = scaled(searchBeyond, scaleX);
+	arrowRise = scaled(arrowRise, scaleY);
+	// CalibrationFramesL2R/R2L stay in reference frames;  computeFinalSpeed() converts frame counts at inputFPS to them.
+}
+
+
+
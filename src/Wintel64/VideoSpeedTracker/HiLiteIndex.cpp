@@ -0,0 +1,102 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "HiLiteIndex.h"
+#include <iostream>
+#include <sstream>
+
+HiLiteIndex::HiLiteIndex()
+{
+}
+
+
+HiLiteIndex::~HiLiteIndex()
+{
+	close();
+}
+
+
+string HiLiteIndex::pathFor(string hiLitePath){
+	return hiLitePath.substr(0, hiLitePath.find_last_of('.')) + ".csv";
+}
+
+
+bool HiLiteIndex::read(string path, vector<HiLiteClip>& clips){
+// False if there is no index:  highlights from before indexes were written.
+	ifstream indexIn(path);
+	if (!indexIn.is_open()) return false;
+	clips.clear();
+	string line;
+	getline(indexIn, line);  // Column names
+	while (getline(indexIn, line)){
+		vector<string> fields;
+		istringstream row(line);
+		string field;
+		while (getline(row, field, ',')){
+			size_t first = field.find_first_not_of(" \"");
+			size_t last = field.find_last_not_of(" \"\r");
+			fields.push_back((first == string::npos) ? "" : field.substr(first, last - first + 1));
+		}
+		if (fields.size() < 10) continue;
+		HiLiteClip clip;
+		clip.clip = stoi(fields[0]);
+		clip.firstFrame = stoi(fields[1]);
+		clip.lastFrame = stoi(fields[2]);
+		clip.direction = fields[3];
+		clip.speed = stoi(fields[4]);
+		clip.area = stoi(fields[5]);
+		clip.date = fields[6];
+		clip.time = fields[7];
+		clip.sourceFile = fields[8];
+		clip.sourceFrame = stoi(fields[9]);
+		clips.push_back(clip);
+	}
+	return true;
+}
+
+
+bool HiLiteIndex::open(string path){
+	close();
+	indexOut.open(path, ios::out | ios::trunc);
+	if (!indexOut.is_open()){
+		cout << "Can't open highlights index " << path << endl;
+		return false;
+	}
+	indexOut << "Clip, FirstFrame, LastFrame, Direction, Speed, VehicleArea, Date, Time, SourceFile, SourceFrame" << endl;
+	numClips = 0;
+	return true;
+}
+
+
+void HiLiteIndex::add(HiLiteClip clip){
+// Numbers the clip.  Flushed, so the rows are there for every clip the highlights file has, even if VST is stopped.
+	if (!indexOut.is_open()) return;
+	clip.clip = ++numClips;
+	indexOut << clip.clip << ", " << clip.firstFrame << ", " << clip.lastFrame << ", " << clip.direction << ", " << clip.speed << ", "
+		<< clip.area << ", " << clip.date << ", " << clip.time << ", " << clip.sourceFile << ", " << clip.sourceFrame << endl;
+}
+
+
+void HiLiteIndex::close(){
+	if (indexOut.is_open()) indexOut.close();
+}
@@ -0,0 +1,66 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+
+using namespace std;
+
+// A HiLiteIndex lists the vehicle clips in a highlights file, one csv row per clip, in a file beside it of the same name ending
+// in .csv (Hilites_20160114.avi -> Hilites_20160114.csv).  VST writes a row as it finishes each clip;  ProcessHiLites reads them,
+// to list and filter clips without decoding anything, and to seek straight to the ones it wants.  A clip runs from its first
+// frame through its last, the black partition frame that ends every clip.
+
+struct HiLiteClip
+{
+	int clip;				// Clips are numbered from 1 in each highlights file
+	int firstFrame;			// Frames of the highlights file
+	int lastFrame;			// The partition frame
+	string direction;
+	int speed;
+	int area;				// Vehicle profile area, in processing pixels
+	string date;			// yyyymmdd and hhmmss the vehicle entered the scene
+	string time;
+	string sourceFile;		// Input file it was seen in, and the frame it was first tracked in there
+	int sourceFrame;
+};
+
+class HiLiteIndex
+{
+public:
+	HiLiteIndex();
+	~HiLiteIndex();
+
+	static string pathFor(string hiLitePath);
+	static bool read(string path, vector<HiLiteClip>& clips);
+
+	bool open(string path);
+	void add(HiLiteClip clip);
+	void close();
+
+private:
+	ofstream indexOut;
+	int numClips = 0;
+};
@@ -0,0 +1,307 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "LaneTracks.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+LaneTracks::LaneTracks()
+{
+}
+
+
+LaneTracks::~LaneTracks()
+{
+	for (int t = 0; t < trackers.size(); t++) delete trackers[t];
+}
+
+
+// Parallel loop body.  Each index belongs to exactly one thread, and each writes only its own mask copy and its own tracker.
+
+class LaneRunner : public ParallelLoopBody
+{
+public:
+	LaneRunner(LaneTracks* inLanes) : lanes(inLanes) {}
+	virtual void operator()(const Range& range) const { lanes->runTrackers(range.start, range.end); }
+private:
+	LaneTracks* lanes;
+};
+
+
+bool LaneTracks::readLanesConfig(string path, Globals& baseG){
+	ifstream lanesIn(path);
+	if (!lanesIn.good()){
+		cout << "Can't open " << path << "." << endl;
+		return false;
+	}
+	string inLine;
+	while (getline(lanesIn, inLine)){
+		inLine = inLine.substr(0, inLine.find('#'));
+		int equals = inLine.find('=');
+		if (equals == string::npos) continue;  // blank or comment line
+		Lane lane;
+		lane.name = stripped(inLine.substr(0, equals));
+		vector<string> fields;
+		istringstream rhsIn(inLine.substr(equals + 1));
+		string field;
+		while (getline(rhsIn, field, ',')) fields.push_back(stripped(field));
+		if (lane.name.empty() || fields.size() < 5 || (fields[0] != "L2R" && fields[0] != "R2L")){
+			cout << "Each lane needs a name, L2R or R2L, a band top, a hubcap line, calibration frames and a max distance on entry.  Check "
+				<< path << ".  Aborting." << endl;
+			return false;
+		}
+		lane.dir = (fields[0] == "L2R") ? L2R : R2L;
+		if (!readInt(fields[1], lane.bandTop) || !readInt(fields[2], lane.hubcapY)
+			|| !readInt(fields[3], lane.calibrationFrames) || !readInt(fields[4], lane.maxDistOnEntry)){
+			cout << "Lane " << lane.name << " has a band, calibration or distance that isn't a whole number.  Check " << path << ".  Aborting." << endl;
+			return false;
+		}
+		if (lane.calibrationFrames <= 0 || lane.maxDistOnEntry <= 0){
+			cout << "Lane " << lane.name << "'s calibration frames and max distance on entry must be positive.  Check " << path << ".  Aborting." << endl;
+			return false;
+		}
+		lane.heading = (fields.size() > 5 && !fields[5].empty()) ? fields[5] : (lane.dir == L2R ? baseG.L2RDirection : baseG.R2LDirection);
+		lane.group = (fields.size() > 6 && !fields[6].empty()) ? fields[6] : lane.name;
+		if (lane.bandTop < 0 || lane.hubcapY <= lane.bandTop || lane.hubcapY > baseG.AnalysisBoxHeight){
+			cout << "Lane " << lane.name << "'s band must lie within the analysis box, top above hubcap line.  Check " << path << ".  Aborting." << endl;
+			return false;
+		}
+		for (int l = 0; l < lanes.size(); l++){
+			if (lanes[l].name == lane.name){
+				cout << "Lane " << lane.name << " is listed twice.  Check " << path << ".  Aborting." << endl;
+				return false;
+			}
+			if (lanes[l].group == lane.group && lanes[l].dir == lane.dir){
+				cout << "Lanes " << lanes[l].name << " and " << lane.name << " go the same way in one group.  Check " << path << ".  Aborting." << endl;
+				return false;
+			}
+		}
+		lanes.push_back(lane);
+	}
+	lanesIn.close();
+	if (lanes.empty()){
+		cout << "No lanes listed in " << path << "." << endl;
+		return false;
+	}
+
+// Lanes going the same way in different groups would otherwise both track a vehicle whose blob reaches into both bands.  So the rows
+// between hubcap lines are split halfway, and a blob belongs to the one lane whose share holds its bottom edge.
+	vector<int> ownedTop(lanes.size(), 0), ownedBottom(lanes.size(), 0);
+	for (int l = 0; l < lanes.size(); l++){
+		int above = -1, below = -1;  // Nearest same-way hubcap lines above and below this lane's
+		for (int m = 0; m < lanes.size(); m++){
+			if (m == l || lanes[m].dir != lanes[l].dir) continue;
+			if (lanes[m].hubcapY == lanes[l].hubcapY){
+				cout << "Lanes " << lanes[m].name << " and " << lanes[l].name << " go the same way on one hubcap line.  Check " << path << ".  Aborting." << endl;
+				return false;
+			}
+			if (lanes[m].hubcapY < lanes[l].hubcapY && lanes[m].hubcapY > above) above = lanes[m].hubcapY;
+			if (lanes[m].hubcapY > lanes[l].hubcapY && (below < 0 || lanes[m].hubcapY < below)) below = lanes[m].hubcapY;
+		}
+		if (above < 0 && below < 0) continue;  // The only lane going its way:  every blob in its band is its own.
+		ownedTop[l] = (above < 0) ? 0 : (above + lanes[l].hubcapY) / 2;
+		ownedBottom[l] = (below < 0) ? baseG.AnalysisBoxHeight : (lanes[l].hubcapY + below) / 2;
+	}
+
+// One tracker per group.  A direction with no lane in the group gets an empty band, so that tracker never sees a vehicle going that way.
+	for (int l = 0; l < lanes.size(); l++){
+		if (find(groups.begin(), groups.end(), lanes[l].group) != groups.end()) continue;
+		Globals g = baseG;
+		g.L2RBandTop = g.L2RStreetY = 0;
+		g.R2LBandTop = g.R2LStreetY = 0;
+		for (int m = l; m < lanes.size(); m++){
+			if (lanes[m].group != lanes[l].group) continue;
+			if (lanes[m].dir == L2R){
+				g.L2RBandTop = lanes[m].bandTop;
+				g.L2RStreetY = lanes[m].hubcapY;
+				g.CalibrationFramesL2R = lanes[m].calibrationFrames;
+				g.maxL2RDistOnEntry = lanes[m].maxDistOnEntry;
+				g.L2RDirection = lanes[m].heading;
+				g.L2ROwnedTop = ownedTop[m];
+				g.L2ROwnedBottom = ownedBottom[m];
+			}
+			else{
+				g.R2LBandTop = lanes[m].bandTop;
+				g.R2LStreetY = lanes[m].hubcapY;
+				g.CalibrationFramesR2L = lanes[m].calibrationFrames;
+				g.maxR2LDistOnEntry = lanes[m].maxDistOnEntry;
+				g.R2LDirection = lanes[m].heading;
+				g.R2LOwnedTop = ownedTop[m];
+				g.R2LOwnedBottom = ownedBottom[m];
+			}
+		}
+		SpeedTracker* tracker = new SpeedTracker();
+		tracker->configure(g);
+		configurations.push_back(g);
+		trackers.push_back(tracker);
+		groups.push_back(lanes[l].group);
+		AnalysisFrames.push_back(Mat::zeros(tracker->AnalysisBox.size(), CV_8UC3));
+	}
+	masks.resize(trackers.size());
+	detected.resize(trackers.size());
+	trackerMessages.resize(trackers.size());
+	L2RSpeedsSeen.resize(trackers.size());
+	R2LSpeedsSeen.resize(trackers.size());
+	cout << "Lanes: " << lanes.size() << " lanes in " << getNumGroups() << " independently tracked groups." << endl;
+	return true;
+}
+
+
+bool LaneTracks::open(string statsPathPrefix, string summaryPathPrefix, SpeedTracker& settings){
+// Every group gets its own stats file, statsPathPrefix_<group>.csv, and its own speed summaries, with the same reporting thresholds.
+	for (int t = 0; t < trackers.size(); t++){
+		trackers[t]->speedLimit = settings.speedLimit;
+		trackers[t]->egregiousSpeedLowerBound = settings.egregiousSpeedLowerBound;
+		trackers[t]->crazySpeed = settings.crazySpeed;
+		trackers[t]->summaryPrefix = summaryPathPrefix + groups[t] + "_";
+		trackers[t]->statsFile.open(statsPathPrefix + "_" + groups[t] + ".csv");
+		if (!trackers[t]->statsFile.is_open()){
+			cout << "Can't open stats file for lane group " << groups[t] << endl;
+			return false;
+		}
+		trackers[t]->statsFile << "#";
+		for (int l = 0; l < lanes.size(); l++)
+			if (lanes[l].group == groups[t]) trackers[t]->statsFile << " " << lanes[l].name << " (" << (lanes[l].dir == L2R ? "L2R" : "R2L") << ")";
+		trackers[t]->statsFile << endl;
+		trackers[t]->statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
+	}
+	return true;
+}
+
+
+void LaneTracks::scaleTo(int inWidth, int inHeight, double inFPS){
+// Fit every group's configuration to this video's frame size and rate.  The analysis box is VST.cfg's for all of them.
+	for (int t = 0; t < trackers.size(); t++){
+		Globals g = configurations[t];
+		g.scaleTo(inWidth, inHeight, inFPS, g.ProcessingScale);
+		trackers[t]->configure(g);
+		if (AnalysisFrames[t].size() != trackers[t]->AnalysisBox.size()) AnalysisFrames[t] = Mat::zeros(trackers[t]->AnalysisBox.size(), CV_8UC3);
+	}
+}
+
+
+void LaneTracks::startFile(string fileName){
+	for (int t = 0; t < trackers.size(); t++) trackers[t]->startFile(fileName);
+}
+
+
+bool LaneTracks::manageMovers(Mat &thresholdImage, int inFrameNumber){
+// Track this frame pair in every group at once.  True if any group detected something.
+	pairMask = thresholdImage;
+	frameNumber = inFrameNumber;
+	if (trackers.size() == 1) runTrackers(0, 1);
+	else cv::parallel_for_(Range(0, int(trackers.size())), LaneRunner(this));
+	bool anyDetected = false;
+	for (int t = 0; t < trackers.size(); t++){
+		if (detected[t]) anyDetected = true;
+		istringstream messages(trackerMessages[t]);  // Printed now, whole lines, one group after another
+		string line;
+		while (getline(messages, line)) cout << groups[t] << ":  " << line << endl;
+		int numL2R = trackers[t]->getNumSpeeds(L2R);
+		int numR2L = trackers[t]->getNumSpeeds(R2L);
+		if (numL2R > L2RSpeedsSeen[t]) lastL2RSpeed = trackers[t]->getLastSpeed(L2R);
+		if (numR2L > R2LSpeedsSeen[t]) lastR2LSpeed = trackers[t]->getLastSpeed(R2L);
+		L2RSpeedsSeen[t] = numL2R;
+		R2LSpeedsSeen[t] = numR2L;
+	}
+	return anyDetected;
+}
+
+
+void LaneTracks::runTrackers(int first, int last){
+	for (int t = first; t < last; t++){
+		pairMask.copyTo(masks[t]);  // findContours() scribbles on its input, and the mask is shared.
+		ostringstream messages;
+		consoleBuffer = &messages;  // Kept until manageMovers() has finished everywhere;  see Globals.h.
+		detected[t] = trackers[t]->manageMovers(masks[t], AnalysisFrames[t], frameNumber);
+		consoleBuffer = NULL;
+		trackerMessages[t] = messages.str();
+	}
+}
+
+
+void LaneTracks::drawAnnotations(Mat &AnalysisFrame){
+// Every group's lines, boxes and speeds, on the one frame shown.
+	for (int t = 0; t < trackers.size(); t++) trackers[t]->drawAnnotations(AnalysisFrame);
+}
+
+
+void LaneTracks::close(){
+// Finish the last file's summaries, and report each lane's count.
+	cout << endl << "Lane          Dir  Vehicles" << endl;
+	for (int t = 0; t < trackers.size(); t++){
+		trackers[t]->finishFile();
+		trackers[t]->statsFile.close();
+	}
+	for (int l = 0; l < lanes.size(); l++){
+		int t = find(groups.begin(), groups.end(), lanes[l].group) - groups.begin();
+		cout << lanes[l].name << string(max(14 - int(lanes[l].name.size()), 1), ' ') << (lanes[l].dir == L2R ? "L2R" : "R2L")
+			<< "  " << trackers[t]->getSpeeds(lanes[l].dir).size() << endl;
+	}
+}
+
+
+bool LaneTracks::isIdle(){
+	for (int t = 0; t < trackers.size(); t++) if (!trackers[t]->isIdle()) return false;
+	return true;
+}
+
+
+int LaneTracks::getNumGroups(){
+	return trackers.size();
+}
+
+
+int LaneTracks::getBandsBottom(){
+// Lowest hubcap line of any lane, relative to AnalysisBoxTop, as scaled for the current video.
+	int bottom = 0;
+	for (int t = 0; t < trackers.size(); t++) bottom = max(bottom, max(trackers[t]->g.L2RStreetY, trackers[t]->g.R2LStreetY));
+	return bottom;
+}
+
+
+int LaneTracks::getNumInTrack(direction dir){
+	int inTrack = 0;
+	for (int t = 0; t < trackers.size(); t++) inTrack += trackers[t]->getNumInTrack(dir);
+	return inTrack;
+}
+
+
+int LaneTracks::getSpeedAttempts(){
+	int attempts = 0;
+	for (int t = 0; t < trackers.size(); t++) attempts += trackers[t]->getSpeedAttempts();
+	return attempts;
+}
+
+
+int LaneTracks::getLastSpeed(direction dir){
+// Latest speed written to any group's stats file in that direction;  0 if none yet.
+	return (dir == L2R) ? lastL2RSpeed : lastR2LSpeed;
+}
+
+
+string LaneTracks::getFileName(){
+	return trackers.empty() ? string() : trackers[0]->fileName;  // startFile() gives every group the same one
+}
@@ -0,0 +1,100 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include "SpeedTracker.h"
+#include <opencv\cv.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+// LaneTracks tracks the vehicles of any number of lanes, listed in lanes.cfg, instead of VST.cfg's one lane each way.  A lane is a band
+// of the analysis box:  its top, its hubcap line, its direction of travel, its calibration and how far its vehicles may be on entry.
+// Lanes are grouped, and each group has its own SpeedTracker, so the vehicles of one group never make another's tracker bail out.
+// Same-way lanes' bands may overlap;  a blob goes to the one lane whose share of the rows between hubcap lines holds its bottom edge.
+// A group holds at most one lane each way;  putting the two lanes of a narrow two-way street in one group keeps the tracker's
+// passing and occlusion handling between them.  All groups see the same motion mask, and they are run in parallel, one per thread,
+// so a frame pair costs about what the busiest group costs, as long as there are cores to go around.
+//
+// lanes.cfg syntax, one lane per line:
+//      <lane name> = <L2R or R2L>, <band top>, <hubcap line>, <calibration frames>, <max dist on entry> [, <compass heading> [, <group>]]
+// Band top and hubcap line are relative to AnalysisBoxTop, in reference pixels, like VST.cfg's L2RStreetY and R2LStreetY.  Everything
+// else comes from VST.cfg.  A lane without a group is a group by itself.
+
+struct Lane
+{
+	string name;
+	direction dir;
+	int bandTop;			// Top of the lane's band, relative to AnalysisBoxTop ...reference pixels
+	int hubcapY;			// Its hubcap line, the bottom of the band
+	int calibrationFrames;	// Frames a vehicle at the speed limit takes between the speed lines, as CalibrationFramesL2R/R2L
+	int maxDistOnEntry;		// As maxL2RDistOnEntry/maxR2LDistOnEntry
+	string heading;			// Compass direction, written to the stats file
+	string group;
+};
+
+class LaneTracks
+{
+public:
+	LaneTracks();
+	~LaneTracks();
+
+	bool readLanesConfig(string path, Globals& baseG);
+	bool open(string statsPathPrefix, string summaryPathPrefix, SpeedTracker& settings);
+	void scaleTo(int inWidth, int inHeight, double inFPS);
+	void startFile(string fileName);
+	bool manageMovers(Mat &thresholdImage, int inFrameNumber);
+	void drawAnnotations(Mat &AnalysisFrame);
+	void close();
+
+	bool isIdle();
+	int getNumGroups();
+	int getBandsBottom();
+	int getNumInTrack(direction dir);
+	int getSpeedAttempts();
+	int getLastSpeed(direction dir);
+	string getFileName();
+
+	// Used by the parallel loop body
+	void runTrackers(int first, int last);
+
+private:
+
+	vector<Lane> lanes;
+	vector<string> groups;				// Group name per tracker
+	vector<SpeedTracker*> trackers;		// One per group
+	vector<Globals> configurations;		// Each tracker's configuration as read, in reference pixels
+	vector<Mat> masks;					// Each tracker's copy of the pair's motion mask
+	vector<Mat> AnalysisFrames;			// Scratch frame per tracker;  annotations are drawn on the shown frame by drawAnnotations()
+	vector<int> detected;				// manageMovers() answer per tracker.  (Not vector<bool>:  each thread writes its own element.)
+	vector<string> trackerMessages;		// What each tracker printed during the pair, to be shown once they're all done
+	vector<int> L2RSpeedsSeen;			// Each tracker's count of speeds, as of the last pair, to spot which group has a new one
+	vector<int> R2LSpeedsSeen;
+	int lastL2RSpeed = 0;				// Latest speed any group wrote, each way
+	int lastR2LSpeed = 0;
+	Mat pairMask;						// The motion mask of the pair being tracked
+	int frameNumber = 0;
+};
@@ -0,0 +1,146 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "LiveStream.h"
+#include <iostream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+LiveStream::LiveStream()
+{
+}
+
+
+LiveStream::~LiveStream()
+{
+	close();
+}
+
+
+bool LiveStream::open(string source){
+	close();
+	if (!source.empty() && source.find_first_not_of("0123456789") == string::npos) capture.open(stoi(source));  // Camera number
+	else capture.open(source);  // Pipe, URL, or file
+	if (!capture.isOpened()) return false;
+	FPS = capture.get(CV_CAP_PROP_FPS);  // Asked now:  once the grabber is running, only it may touch capture.
+	if (FPS <= 0.0) FPS = 30.0;  // Cameras and pipes often don't say.
+	frameWidth = capture.get(CV_CAP_PROP_FRAME_WIDTH);
+	frameHeight = capture.get(CV_CAP_PROP_FRAME_HEIGHT);
+
+	struct _stat64 info;
+	paceToTimestamps = (_stat64(source.c_str(), &info) == 0) && (info.st_mode & _S_IFREG);  // A regular file, not a pipe or device.
+	useArrivalTimes = false;
+	lastMsec = -1.0;
+	framesDropped = 0;
+	ended = false;
+	waiting.clear();
+	startTime = chrono::steady_clock::now();
+	running = true;
+	grabber = thread(&LiveStream::grabLoop, this);
+	return true;
+}
+
+
+void LiveStream::close(){
+	{
+		lock_guard<mutex> lock(queueLock);
+		running = false;
+	}
+	if (grabber.joinable()) grabber.join();
+	capture.release();
+	waiting.clear();
+}
+
+
+void LiveStream::grabLoop(){
+	while (true){
+		{
+			lock_guard<mutex> lock(queueLock);
+			if (!running) break;
+		}
+		TimedFrame timedFrame;
+		if (!capture.read(timedFrame.frame) || timedFrame.frame.empty()) break;
+		double arrivalMsec = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+		timedFrame.msec = capture.get(CV_CAP_PROP_POS_MSEC);
+		if (!useArrivalTimes && lastMsec >= 0.0 && timedFrame.msec <= lastMsec) useArrivalTimes = true;  // No usable stream timestamps.
+		if (useArrivalTimes) timedFrame.msec = arrivalMsec;
+		lastMsec = timedFrame.msec;
+		if (paceToTimestamps && timedFrame.msec > arrivalMsec)  // File standing in for a camera: deliver frames as a camera would.
+			this_thread::sleep_for(chrono::duration<double, milli>(timedFrame.msec - arrivalMsec));
+
+		lock_guard<mutex> lock(queueLock);
+		if (waiting.size() >= LIVE_QUEUE_FRAMES){  // Analysis is behind:  drop the stalest frame rather than fall further behind.
+			waiting.pop_front();
+			framesDropped++;
+		}
+		waiting.push_back(timedFrame);
+		frameArrived.notify_one();
+	}
+	lock_guard<mutex> lock(queueLock);
+	ended = true;
+	frameArrived.notify_one();
+}
+
+
+bool LiveStream::next(TimedFrame &timedFrame){
+	unique_lock<mutex> lock(queueLock);
+	frameArrived.wait(lock, [this]{ return !waiting.empty() || ended; });
+	if (waiting.empty()) return false;
+	timedFrame = waiting.front();
+	waiting.pop_front();
+	return true;
+}
+
+
+bool LiveStream::readPair(Mat &frame1, double &msec1, Mat &frame2, double &msec2){
+// Two successive frames still waiting to be analyzed.  If frames were dropped in between, their times show it.
+	TimedFrame first, second;
+	if (!next(first) || !next(second)) return false;
+	frame1 = first.frame;
+	msec1 = first.msec;
+	frame2 = second.frame;
+	msec2 = second.msec;
+	return true;
+}
+
+
+double LiveStream::getFPS(){
+	return FPS;
+}
+
+
+double LiveStream::getFrameWidth(){
+	return frameWidth;
+}
+
+
+double LiveStream::getFrameHeight(){
+	return frameHeight;
+}
+
+
+int LiveStream::getFramesDropped(){
+	lock_guard<mutex> lock(queueLock);
+	return framesDropped;
+}
@@ -0,0 +1,86 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+using namespace std;
+using namespace cv;
+
+// A LiveStream reads frames from a camera (by number), a named pipe, or any URL OpenCV can open, on its own thread, so analysis never
+// waits on the source and the source never waits on analysis.  Frames wait in a short queue;  when analysis falls behind, the
+// oldest waiting frames are dropped, which bounds the delay between a frame arriving and it being analyzed.  Each frame carries a
+// presentation time in milliseconds: the stream's own timestamp when it has one, otherwise the time the frame arrived.
+// An ordinary video file can stand in for a live source;  it is played back no faster than real time.
+
+const int LIVE_QUEUE_FRAMES = 6;  // Frames allowed to wait for analysis.  200 ms at 30 fps.
+
+struct TimedFrame
+{
+	Mat frame;
+	double msec;	// Presentation time, relative to the start of the stream
+};
+
+class LiveStream
+{
+public:
+	LiveStream();
+	~LiveStream();
+
+	bool open(string source);
+	void close();
+	bool readPair(Mat &frame1, double &msec1, Mat &frame2, double &msec2);
+
+	double getFPS();
+	double getFrameWidth();
+	double getFrameHeight();
+	int getFramesDropped();
+
+private:
+
+	void grabLoop();
+	bool next(TimedFrame &timedFrame);
+
+	VideoCapture capture;			// Used only by the grabber thread once it has started
+	thread grabber;
+	mutex queueLock;
+	condition_variable frameArrived;
+	deque<TimedFrame> waiting;
+	bool running = false;
+	bool ended = false;				// Source has no more frames.
+	bool paceToTimestamps = false;	// Source is a file standing in for a live one.
+	bool useArrivalTimes = false;	// Source doesn't timestamp its frames.
+	double lastMsec = -1.0;
+	int framesDropped = 0;
+	chrono::steady_clock::time_point startTime;
+	double FPS = 30.0;				// As the source gave them at open()
+	double frameWidth = 0.0;
+	double frameHeight = 0.0;
+};
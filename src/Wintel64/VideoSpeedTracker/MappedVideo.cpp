@@ -0,0 +1,253 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "MappedVideo.h"
+#include <windows.h>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+
+// PrefetchVirtualMemory() came with Windows 8;  on Windows 7, VST does without it and relies on the file cache's own read ahead.
+struct PrefetchRange
+{
+	void* VirtualAddress;
+	size_t NumberOfBytes;
+};
+typedef BOOL(WINAPI *PrefetchFunction)(HANDLE, ULONG_PTR, PrefetchRange*, ULONG);
+static PrefetchFunction prefetchVirtualMemory = (PrefetchFunction)GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory");
+
+
+MappedVideo::MappedVideo()
+{
+}
+
+
+MappedVideo::~MappedVideo()
+{
+	release();
+}
+
+
+bool MappedVideo::handles(string videoPath){
+	string extension = videoPath.substr(videoPath.find_last_of('.') + 1);
+	for (int i = 0; i < extension.size(); i++) extension[i] = tolower(extension[i]);
+	return extension == "y4m" || extension == "gray";
+}
+
+
+bool MappedVideo::open(string videoPath, int inLumaTop, int inLumaHeight){
+// inLumaTop and inLumaHeight are the rows luma() hands out;  inLumaHeight of 0 means down to the bottom of the frame.
+	release();
+	file = CreateFileA(videoPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE){
+		file = NULL;
+		return false;
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	fileSize = size.QuadPart;
+	mapping = (fileSize > 0) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	view = (mapping != NULL) ? (const uchar*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (view == NULL){
+		cout << "Can't map " << videoPath << endl;
+		release();
+		return false;
+	}
+
+	isY4M = (fileSize >= 10 && memcmp(view, "YUV4MPEG2 ", 10) == 0);
+	if (isY4M){
+		if (!readY4MHeader()){
+			cout << videoPath << " has a Y4M header VST can't use." << endl;
+			release();
+			return false;
+		}
+	}
+	else{
+		width = 1280;
+		height = 720;
+		FPS = 30.0;
+		chroma = "mono";
+		size_t sizeAt = videoPath.find_last_of('_');
+		int namedWidth = 0, namedHeight = 0;  // Locals:  the part after the last '_' may be a date, not a size.
+		if (sizeAt != string::npos && sscanf(videoPath.substr(sizeAt + 1).c_str(), "%dx%d", &namedWidth, &namedHeight) == 2
+			&& namedWidth > 0 && namedHeight > 0){
+			width = namedWidth;
+			height = namedHeight;
+		}
+		else cout << videoPath << " doesn't give its frame size as _<W>x<H>.gray;  assuming " << width << "x" << height << "." << endl;
+		headerBytes = 0;
+		frameBytes = int64_t(width) * height;
+	}
+	if (!findFrames()){
+		cout << videoPath << " frames aren't where expected." << endl;
+		release();
+		return false;
+	}
+	setLumaRows(inLumaTop, inLumaHeight);
+	prefetchedTo = 0;
+	return true;
+}
+
+
+void MappedVideo::release(){
+	if (view != NULL) UnmapViewOfFile(view);
+	if (mapping != NULL) CloseHandle(mapping);
+	if (file != NULL) CloseHandle(file);
+	view = NULL;
+	mapping = NULL;
+	file = NULL;
+	frameOffsets.clear();
+}
+
+
+bool MappedVideo::isOpened(){
+	return view != NULL;
+}
+
+
+bool MappedVideo::readY4MHeader(){
+// e.g.  YUV4MPEG2 W1280 H720 F30:1 Ip A1:1 C420jpeg
+	const uchar* end = (const uchar*)memchr(view, '\n', size_t(min(fileSize, int64_t(1024))));
+	if (end == NULL) return false;
+	headerBytes = (end - view) + 1;
+	istringstream header(string((const char*)view + 10, (const char*)end));
+	string field;
+	chroma = "420";
+	while (header >> field){
+		if (field[0] == 'W') width = stoi(field.substr(1));
+		else if (field[0] == 'H') height = stoi(field.substr(1));
+		else if (field[0] == 'C') chroma = field.substr(1);
+		else if (field[0] == 'F'){
+			int numerator = 30, denominator = 1;
+			sscanf(field.c_str() + 1, "%d:%d", &numerator, &denominator);
+			if (numerator > 0 && denominator > 0) FPS = double(numerator) / denominator;
+		}
+	}
+	int64_t lumaBytes = int64_t(width) * height;
+	if (chroma.substr(0, 4) == "mono") frameBytes = lumaBytes;
+	else if (chroma.substr(0, 3) == "420") frameBytes = lumaBytes + 2 * (int64_t((width + 1) / 2) * ((height + 1) / 2));
+	else if (chroma.substr(0, 3) == "422") frameBytes = lumaBytes + 2 * (int64_t((width + 1) / 2) * height);
+	else if (chroma.substr(0, 3) == "444") frameBytes = 3 * lumaBytes;
+	else return false;  // Higher bit depths, alpha
+	return width > 0 && height > 0;
+}
+
+
+bool MappedVideo::findFrames(){
+// Headerless frames, and Y4M frames whose headers are all a plain "FRAME\n" (as ffmpeg writes them), are a fixed distance apart,
+// so they are found without reading the file;  only the first and last FRAME headers are checked.  Otherwise walk the headers.
+	frameOffsets.clear();
+	if (!isY4M){
+		for (int64_t at = 0; at + frameBytes <= fileSize; at += frameBytes) frameOffsets.push_back(at);
+		return true;
+	}
+	int64_t at = headerBytes;
+	if (at + 6 <= fileSize && memcmp(view + at, "FRAME\n", 6) == 0){
+		int64_t frameStride = 6 + frameBytes;
+		int64_t numFrames = (fileSize - headerBytes) / frameStride;  // A truncated last frame is left out.
+		if (numFrames > 0 && memcmp(view + headerBytes + (numFrames - 1) * frameStride, "FRAME\n", 6) == 0){
+			for (int64_t f = 0; f < numFrames; f++) frameOffsets.push_back(headerBytes + f * frameStride + 6);
+			return true;
+		}
+	}
+	while (at + 5 <= fileSize){
+		if (memcmp(view + at, "FRAME", 5) != 0) return false;
+		const uchar* newline = (const uchar*)memchr(view + at, '\n', size_t(min(fileSize - at, int64_t(1024))));
+		if (newline == NULL) return false;
+		int64_t dataAt = (newline - view) + 1;
+		if (dataAt + frameBytes > fileSize) break;  // Truncated last frame
+		frameOffsets.push_back(dataAt);
+		at = dataAt + frameBytes;
+	}
+	return true;
+}
+
+
+const uchar* MappedVideo::frameData(int frameNum){
+	if (frameNum < 0 || frameNum >= int(frameOffsets.size())) return NULL;
+	prefetch(frameNum);
+	return view + frameOffsets[frameNum];
+}
+
+
+void MappedVideo::prefetch(int frameNum){
+// Ask for the next MAPPED_PREFETCH_FRAMES frames in one go, whenever the frames already asked for are half used up.
+	if (prefetchVirtualMemory == NULL || frameNum + MAPPED_PREFETCH_FRAMES / 2 < prefetchedTo) return;
+	int from = max(frameNum, prefetchedTo);
+	int to = min(frameNum + MAPPED_PREFETCH_FRAMES, int(frameOffsets.size()));
+	if (to <= from) return;
+	PrefetchRange range;
+	range.VirtualAddress = (void*)(view + frameOffsets[from]);
+	range.NumberOfBytes = size_t(frameOffsets[to - 1] + frameBytes - frameOffsets[from]);
+	prefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	prefetchedTo = to;
+}
+
+
+bool MappedVideo::luma(int frameNum, Mat &lumaRows){
+// The rows asked for at open(), in place in the mapping.  Read only.
+	const uchar* data = frameData(frameNum);
+	if (data == NULL) return false;
+	lumaRows = Mat(lumaHeight, width, CV_8UC1, (void*)(data + int64_t(lumaTop) * width));
+	return true;
+}
+
+
+bool MappedVideo::toBGR(int frameNum, Mat &frame){
+// The whole frame in color, for highlights.  Luma only files (and chroma layouts OpenCV can't convert) come out gray.
+	const uchar* data = frameData(frameNum);
+	if (data == NULL) return false;
+	if (chroma.substr(0, 3) == "420" && (width % 2) == 0 && (height % 2) == 0)
+		cv::cvtColor(Mat(height * 3 / 2, width, CV_8UC1, (void*)data), frame, COLOR_YUV2BGR_I420);  // Y4M 4:2:0 is laid out as I420.
+	else
+		cv::cvtColor(Mat(height, width, CV_8UC1, (void*)data), frame, COLOR_GRAY2BGR);
+	return true;
+}
+
+
+int MappedVideo::getFrameCount(){
+	return int(frameOffsets.size());
+}
+
+
+double MappedVideo::getFPS(){
+	return FPS;
+}
+
+
+int MappedVideo::getFrameWidth(){
+	return width;
+}
+
+
+int MappedVideo::getFrameHeight(){
+	return height;
+}
+
+
+void MappedVideo::setLumaRows(int inLumaTop, int inLumaHeight){
+// Change the rows luma() hands out, e.g. once the frame size is known.  A height of 0 means to the bottom.
+	lumaTop = min(max(inLumaTop, 0), height);
+	lumaHeight = (inLumaHeight > 0) ? min(inLumaHeight, height - lumaTop) : height - lumaTop;
+}
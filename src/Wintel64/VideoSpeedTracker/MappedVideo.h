@@ -0,0 +1,86 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+using namespace cv;
+
+// A MappedVideo reads pre-decoded video, either a Y4M file (.y4m) or headerless 8 bit luma frames (.gray, as made by
+// ffmpeg -i <in.avi> -f rawvideo -pix_fmt gray <out.gray>), through a read only mapping of the whole file.  Frames are handed
+// out as Mats pointing right into the mapping:  nothing is decoded, converted or copied.  Windows reads ahead of the frames
+// being used, and every process analyzing the same file at the same time shares the one copy in the file cache.
+//
+// Headerless luma frames are 1280 x 720 unless the name ends in _<width>x<height>.gray, e.g. manual_20160114120000_1280x720.gray,
+// and are taken to be 30 frames per second.
+
+const int MAPPED_PREFETCH_FRAMES = 30;  // How far ahead of the frame in use to ask Windows to read.
+
+class MappedVideo
+{
+public:
+	MappedVideo();
+	~MappedVideo();
+
+	static bool handles(string videoPath);
+	bool open(string videoPath, int inLumaTop, int inLumaHeight);
+	void release();
+	bool isOpened();
+
+	bool luma(int frameNum, Mat &lumaRows);
+	bool toBGR(int frameNum, Mat &frame);
+	void setLumaRows(int inLumaTop, int inLumaHeight);
+
+	int getFrameCount();
+	double getFPS();
+	int getFrameWidth();
+	int getFrameHeight();
+
+private:
+
+	bool readY4MHeader();
+	bool findFrames();
+	const uchar* frameData(int frameNum);
+	void prefetch(int frameNum);
+
+	void* file = NULL;			// Windows handles
+	void* mapping = NULL;
+	const uchar* view = NULL;	// The whole file
+	int64_t fileSize = 0;
+
+	bool isY4M = false;
+	int64_t headerBytes = 0;	// Y4M stream header
+	int64_t frameBytes = 0;		// Picture data per frame, after any FRAME header
+	string chroma = "mono";		// Y4M C parameter: 420jpeg, 420mpeg2, 420paldv, 420, 422, 444 or mono
+	vector<int64_t> frameOffsets;  // Where each frame's picture data starts
+	int width = 1280;
+	int height = 720;
+	double FPS = 30.0;
+	int lumaTop = 0;
+	int lumaHeight = 0;
+	int prefetchedTo = 0;		// Frames before this one have been asked for.
+};
@@ -0,0 +1,217 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "MotionMask.h"
+#include "VideoFile.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+
+void thresholdDifference(const Mat &differenceImage, Mat &thresholdImage, int sensitivity, int blurSize){
+	cv::threshold(differenceImage, thresholdImage, sensitivity, 255, THRESH_BINARY);  //threshold intensity image at a given sensitivity value
+	cv::blur(thresholdImage, thresholdImage, cv::Size(blurSize, blurSize));  //blur the image to reduce noise.
+	cv::threshold(thresholdImage, thresholdImage, sensitivity, 255, THRESH_BINARY);	//threshold again to obtain binary image from blur output
+}
+
+
+Mat atProcessingScale(const Mat &inputRegion, Size processingSize){
+	if (inputRegion.size() == processingSize) return inputRegion;
+	Mat shrunk;
+	cv::resize(inputRegion, shrunk, processingSize, 0, 0, INTER_AREA);  // Averages, so noise shrinks with the picture.
+	return shrunk;
+}
+
+
+bool quietPair(const Mat &frame1, const Mat &frame2, Rect region, int sensitivity){
+	int channels = frame1.channels();
+	for (int row = region.y; row < region.y + region.height; row += MOTION_PROBE_STRIDE){
+		const uchar* pixel1 = frame1.ptr<uchar>(row) + channels * region.x;
+		const uchar* pixel2 = frame2.ptr<uchar>(row) + channels * region.x;
+		for (int col = 0; col < region.width; col += MOTION_PROBE_STRIDE){
+			for (int channel = 0; channel < channels; channel++){
+				if (abs(int(pixel1[channels * col + channel]) - int(pixel2[channels * col + channel])) > sensitivity) return false;  // Motion; no need to look further.
+			}
+		}
+	}
+	return true;
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * M a s k   C a c h e * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+const char maskCacheMagic[4] = { 'V', 'S', 'T', 'M' };
+const int32_t maskCacheVersion = 1;
+const int maskCachePairCountOffset = 4 + 4 + 8 + 8 + 4 * 4 + 4 + 4 + 4;  // Where the number of frame pairs sits in the header.
+
+
+MaskCache::MaskCache()
+{
+}
+
+
+MaskCache::~MaskCache()
+{
+	close();
+}
+
+
+string MaskCache::pathFor(string videoPath, int sensitivity, int blurSize){
+	return videoPath.substr(0, videoPath.find_last_of('.')) + "_S" + to_string(sensitivity) + "_B" + to_string(blurSize) + ".vsm";
+}
+
+
+bool MaskCache::openForRead(string videoPath, Rect box, int sensitivity, int blurSize, int startFrame){
+// Returns true only if a completed cache made from this very video, with these parameters, covers startFrame.
+	close();
+	int64_t videoSize, videoModified;
+	if (!fileIdentity(videoPath, videoSize, videoModified)) return false;
+	cachePath = pathFor(videoPath, sensitivity, blurSize);
+	cacheIn.open(cachePath, ios::in | ios::binary);
+	if (!cacheIn.is_open()) return false;
+
+	char magic[4];
+	int32_t version, header[8], numPairs;
+	int64_t size, modified;
+	cacheIn.read(magic, 4);
+	cacheIn.read((char *)&version, sizeof(version));
+	cacheIn.read((char *)&size, sizeof(size));
+	cacheIn.read((char *)&modified, sizeof(modified));
+	cacheIn.read((char *)header, sizeof(header));
+	cacheIn.read((char *)&numPairs, sizeof(numPairs));
+	bool keyMatches = cacheIn.good() && memcmp(magic, maskCacheMagic, 4) == 0 && version == maskCacheVersion
+		&& size == videoSize && modified == videoModified
+		&& header[0] == box.x && header[1] == box.y && header[2] == box.width && header[3] == box.height
+		&& header[4] == sensitivity && header[5] == blurSize;
+	int firstFrame = header[6];
+	if (!keyMatches || numPairs <= 0 || firstFrame > startFrame || ((startFrame - firstFrame) % 2) != 0){
+		cacheIn.close();  // Stale, incomplete, or doesn't line up with the frame pairs asked for: rebuild it.
+		return false;
+	}
+	maskSize = box.size();
+	return true;
+}
+
+
+bool MaskCache::openForWrite(string videoPath, Rect box, int sensitivity, int blurSize, int startFrame){
+	close();
+	int64_t videoSize, videoModified;
+	if (!fileIdentity(videoPath, videoSize, videoModified)) return false;
+	cachePath = pathFor(videoPath, sensitivity, blurSize);
+	cacheOut.open(cachePath, ios::out | ios::binary | ios::trunc);
+	if (!cacheOut.is_open()){
+		cout << "Can't open mask cache " << cachePath << " for writing." << endl;
+		return false;
+	}
+	int32_t version = maskCacheVersion;
+	int32_t header[8] = { box.x, box.y, box.width, box.height, sensitivity, blurSize, startFrame, 0 };
+	cacheOut.write(maskCacheMagic, 4);
+	cacheOut.write((const char *)&version, sizeof(version));
+	cacheOut.write((const char *)&videoSize, sizeof(videoSize));
+	cacheOut.write((const char *)&videoModified, sizeof(videoModified));
+	cacheOut.write((const char *)header, sizeof(header));
+	maskSize = box.size();
+	pairsWritten = 0;
+	return cacheOut.good();
+}
+
+
+void MaskCache::write(int frameNum, const Mat &mask){
+	runs.clear();
+	uchar current = 0;
+	int runLength = 0;
+	for (int row = 0; row < mask.rows; row++){
+		const uchar* pixel = mask.ptr<uchar>(row);
+		for (int col = 0; col < mask.cols; col++){
+			uchar value = pixel[col] ? 255 : 0;
+			if (value != current || runLength == 65535){
+				runs.push_back(uint16_t(runLength));
+				if (value == current) runs.push_back(0);  // Overlong run: zero length run of the other value.
+				current = value;
+				runLength = 0;
+			}
+			runLength++;
+		}
+	}
+	runs.push_back(uint16_t(runLength));
+
+	int32_t pairHeader[2] = { frameNum, int32_t(runs.size()) };
+	cacheOut.write((const char *)pairHeader, sizeof(pairHeader));
+	cacheOut.write((const char *)&runs[0], runs.size() * sizeof(uint16_t));
+	pairsWritten++;
+}
+
+
+bool MaskCache::read(int &frameNum, Mat &mask){
+	int32_t pairHeader[2];
+	cacheIn.read((char *)pairHeader, sizeof(pairHeader));
+	if (!cacheIn.good()) return false;
+	runs.resize(pairHeader[1]);
+	cacheIn.read((char *)&runs[0], runs.size() * sizeof(uint16_t));
+	if (!cacheIn.good()) return false;
+
+	mask.create(maskSize, CV_8UC1);  // Continuous, so runs can cross row ends.
+	uchar* pixel = mask.ptr<uchar>(0);
+	uchar* end = pixel + maskSize.area();
+	uchar value = 0;
+	for (int r = 0; r < runs.size() && pixel < end; r++){
+		int runLength = min(int(runs[r]), int(end - pixel));
+		memset(pixel, value, runLength);
+		pixel += runLength;
+		value = 255 - value;
+	}
+	if (pixel < end) memset(pixel, 0, end - pixel);
+	frameNum = pairHeader[0];
+	return true;
+}
+
+
+void MaskCache::finish(){
+// Mark the cache complete.  Only for a run that wrote every frame pair through to the end of the file.
+	if (!cacheOut.is_open()) return;
+	int32_t numPairs = pairsWritten;
+	cacheOut.seekp(maskCachePairCountOffset);
+	cacheOut.write((const char *)&numPairs, sizeof(numPairs));
+	cacheOut.close();
+}
+
+
+void MaskCache::close(){
+	if (cacheOut.is_open()){
+		// Not finish()ed, so the run was cut short.  What was written would never be used;  don't leave it lying about.
+		cacheOut.close();
+		remove(cachePath.c_str());
+	}
+	if (cacheIn.is_open()) cacheIn.close();
+}
+
+
+bool MaskCache::isReading(){
+	return cacheIn.is_open();
+}
+
+
+bool MaskCache::isWriting(){
+	return cacheOut.is_open();
+}
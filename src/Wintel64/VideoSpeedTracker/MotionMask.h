@@ -0,0 +1,86 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+using namespace cv;
+
+// Turn an absdiff() image of two consecutive gray frames into the binary motion mask the tracker looks for blobs in:
+// threshold at sensitivity, blur to knit nearby pieces together, threshold again.
+void thresholdDifference(const Mat &differenceImage, Mat &thresholdImage, int sensitivity, int blurSize);
+
+// The analysis box of an input frame at the size the tracker works at (see ProcessingScale in Globals.h):  the region itself,
+// uncopied, if it is that size already, else a shrunken copy.  Shrinking before differencing saves the differencing and blurring too.
+Mat atProcessingScale(const Mat &inputRegion, Size processingSize);
+
+// Cheap test for an idle frame pair.  Samples every MOTION_PROBE_STRIDE'th pixel of every MOTION_PROBE_STRIDE'th row of region in
+// two color (or gray) frames, and returns true if no sample differs by more than sensitivity in any channel.  A gray level difference
+// can't exceed the largest channel difference, so any pixel the probe calls quiet would also be below threshold in the full pipeline.
+const int MOTION_PROBE_STRIDE = 4;
+bool quietPair(const Mat &frame1, const Mat &frame2, Rect region, int sensitivity);
+
+
+// A MaskCache holds the motion mask of every frame pair of one video file, run length encoded, in a .vsm file next to the video.
+// The mask depends only on the video, AnalysisBox, SENSITIVITY_VALUE and BLUR_SIZE, so the cache is keyed on the video's size and
+// modification time plus those parameters.  SENSITIVITY_VALUE and BLUR_SIZE are also in the cache file name, so caches for several
+// preprocessing variants can sit side by side.  A cache is only used if it was completed, i.e. the recording run reached end of file.
+//
+// File layout (little endian):
+//   header:  "VSTM", int32 version, int64 video size, int64 video modification time, int32 AnalysisBox x, y, width, height,
+//            int32 SENSITIVITY_VALUE, BLUR_SIZE, int32 first frame number, int32 number of frame pairs (0 until completed)
+//   per frame pair:  int32 frame number, int32 number of runs, then uint16 run lengths, in row order.  Runs alternate between
+//            0 and 255, starting with 0.  Runs longer than 65535 are split by a zero length run of the other value.
+
+class MaskCache
+{
+public:
+	MaskCache();
+	~MaskCache();
+
+	static string pathFor(string videoPath, int sensitivity, int blurSize);
+
+	bool openForRead(string videoPath, Rect box, int sensitivity, int blurSize, int startFrame);
+	bool openForWrite(string videoPath, Rect box, int sensitivity, int blurSize, int startFrame);
+	bool read(int &frameNum, Mat &mask);
+	void write(int frameNum, const Mat &mask);
+	void finish();
+	void close();
+
+	bool isReading();
+	bool isWriting();
+
+private:
+
+	ifstream cacheIn;
+	ofstream cacheOut;
+	string cachePath;
+	Size maskSize;
+	int pairsWritten = 0;
+	vector<uint16_t> runs;  // Scratch run buffer, reused for every frame pair.
+};
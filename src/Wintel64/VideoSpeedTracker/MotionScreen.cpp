@@ -0,0 +1,185 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "MotionScreen.h"
+#include "FFmpegDecoder.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+
+MotionScreen::MotionScreen()
+{
+}
+
+
+MotionScreen::~MotionScreen()
+{
+}
+
+
+void MotionScreen::clear(){
+	stretches.clear();
+	frameCount = 0;
+}
+
+
+void MotionScreen::addMotion(int frameNum){
+// Camera streams have no B frames, so frames arrive in presentation order, and a stretch either extends the last one or follows it.
+// A frame out of order just widens the last stretch.
+	int first = max(frameNum - SCREEN_LEAD_FRAMES, 0);
+	int last = frameNum + SCREEN_TAIL_FRAMES;
+	if (!stretches.empty() && first <= stretches.back().second + 1){
+		stretches.back().first = min(stretches.back().first, first);
+		stretches.back().second = max(stretches.back().second, last);
+	}
+	else stretches.push_back(make_pair(first, last));
+}
+
+
+int MotionScreen::nextActive(int frameNum){
+// The first frame at or after frameNum in a stretch with motion;  getFrameCount() if there's none.
+	for (int s = 0; s < stretches.size(); s++){
+		if (stretches[s].second >= frameNum) return max(stretches[s].first, frameNum);
+	}
+	return frameCount;
+}
+
+
+int MotionScreen::getFrameCount(){
+	return frameCount;
+}
+
+
+int MotionScreen::getActiveFrames(){
+	int active = 0;
+	for (int s = 0; s < stretches.size(); s++) active += min(stretches[s].second, frameCount - 1) - stretches[s].first + 1;
+	return active;
+}
+
+
+#ifdef VST_FFMPEG
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/motion_vector.h>
+}
+
+
+bool MotionScreen::screen(string videoPath, Rect laneRegion){
+// laneRegion is in input pixels.  False if the file can't be screened;  it must then be analyzed whole.
+	clear();
+	AVFormatContext* format = NULL;
+	if (avformat_open_input(&format, videoPath.c_str(), NULL, NULL) < 0) return false;
+	const AVCodec* decoder = NULL;
+	int streamIndex = (avformat_find_stream_info(format, NULL) < 0) ? -1 : av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+	AVCodecID codecId = (streamIndex < 0) ? AV_CODEC_ID_NONE : format->streams[streamIndex]->codecpar->codec_id;
+	if (codecId != AV_CODEC_ID_H264 && codecId != AV_CODEC_ID_MPEG4 && codecId != AV_CODEC_ID_MPEG2VIDEO && codecId != AV_CODEC_ID_H263){
+		cout << "No motion vectors to screen in " << videoPath << endl;
+		avformat_close_input(&format);
+		return false;
+	}
+	AVStream* stream = format->streams[streamIndex];
+	AVCodecContext* codec = avcodec_alloc_context3(decoder);
+	avcodec_parameters_to_context(codec, stream->codecpar);
+	codec->thread_count = FFmpegDecoder::decodeThreads;
+	codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+	codec->skip_idct = AVDISCARD_ALL;			// The vectors are all that's wanted;  the pictures can be garbage.
+	codec->skip_loop_filter = AVDISCARD_ALL;
+	codec->skip_frame = AVDISCARD_NONREF;
+	AVDictionary* options = NULL;
+	av_dict_set(&options, "flags2", "+export_mvs", 0);
+	bool opened = (avcodec_open2(codec, decoder, &options) >= 0);
+	av_dict_free(&options);
+	if (!opened){
+		avcodec_free_context(&codec);
+		avformat_close_input(&format);
+		return false;
+	}
+
+	AVRational rate = av_guess_frame_rate(format, stream, NULL);
+	double FPS = (rate.num > 0 && rate.den > 0) ? av_q2d(rate) : 30.0;
+	double timeBase = av_q2d(stream->time_base);
+	int64_t startPts = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+	AVPacket* packet = av_packet_alloc();
+	AVFrame* frame = av_frame_alloc();
+	int frameIndex = -1;
+	int framesWithVectors = 0;
+	bool moving = false;  // Carried over keyframes
+	bool draining = false;
+	while (true){
+		int result = avcodec_receive_frame(codec, frame);
+		if (result == AVERROR(EAGAIN)){
+			if (draining) break;
+			if (av_read_frame(format, packet) < 0){
+				avcodec_send_packet(codec, NULL);  // End of file:  drain the frames still in the decoder threads.
+				draining = true;
+			}
+			else{
+				if (packet->stream_index == streamIndex) avcodec_send_packet(codec, packet);
+				av_packet_unref(packet);
+			}
+			continue;
+		}
+		if (result != 0) break;  // End of file, or a decoding error.
+
+		int64_t pts = frame->best_effort_timestamp;
+		frameIndex = (pts == AV_NOPTS_VALUE) ? frameIndex + 1 : int(floor((pts - startPts) * timeBase * FPS + 0.5));
+		AVFrameSideData* vectors = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+		if (vectors != NULL){
+			framesWithVectors++;
+			const AVMotionVector* mv = (const AVMotionVector*)vectors->data;
+			int numVectors = int(vectors->size / sizeof(AVMotionVector));
+			int movedBlocks = 0;
+			for (int v = 0; v < numVectors && movedBlocks < SCREEN_MIN_BLOCKS; v++){
+				int scale = max(int(mv[v].motion_scale), 1);
+				if (laneRegion.contains(Point(mv[v].dst_x, mv[v].dst_y))
+					&& (abs(mv[v].motion_x) + abs(mv[v].motion_y)) >= SCREEN_MIN_MOTION * scale) movedBlocks++;
+			}
+			moving = (movedBlocks >= SCREEN_MIN_BLOCKS);
+		}
+		else if (frame->pict_type != AV_PICTURE_TYPE_I) moving = false;  // Nothing moved from the frame it was predicted from.
+		if (moving && frameIndex >= 0) addMotion(frameIndex);
+		frameCount = max(frameCount, frameIndex + 1);
+		av_frame_unref(frame);
+	}
+	av_frame_free(&frame);
+	av_packet_free(&packet);
+	avcodec_free_context(&codec);
+	avformat_close_input(&format);
+	if (framesWithVectors == 0){  // Every frame a keyframe, or the decoder exported nothing:  can't tell idle from busy.
+		clear();
+		return false;
+	}
+	return true;
+}
+
+#else  // Built without FFmpeg:  nothing is screened.
+
+bool MotionScreen::screen(string videoPath, Rect laneRegion){
+	clear();
+	return false;
+}
+
+#endif
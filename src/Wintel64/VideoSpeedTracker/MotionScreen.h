@@ -0,0 +1,68 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+// A MotionScreen finds the stretches of a video file in which anything moves in the lane bands, from the motion vectors the
+// camera's encoder already put in the stream (H.264, MPEG-4), before the file is analyzed.  The screening pass asks libavcodec to
+// export each frame's motion vectors and to skip everything it can while still producing them:  the inverse transform, the
+// deblocking filter and non-reference frames.  No picture is reconstructed or converted.  A frame moves if at least
+// SCREEN_MIN_BLOCKS blocks ending in the lane bands moved SCREEN_MIN_MOTION pixels or more.  Keyframes carry no vectors, and
+// take the state of the frame before them.  Each moving frame makes its own stretch, from SCREEN_LEAD_FRAMES before it (so the
+// tracker sees a vehicle coming in) to SCREEN_TAIL_FRAMES after it.  While nothing is in track, VST seeks straight past the rest.
+//
+// Built only when VST_FFMPEG is defined, as FFmpegDecoder is.  Otherwise, or for video with no motion vectors (e.g. MJPEG),
+// screen() fails, and every frame is analyzed as before.
+
+const int SCREEN_MIN_BLOCKS = 3;		// Moved blocks in the lane bands that make a frame move
+const int SCREEN_MIN_MOTION = 2;		// Least movement of a block that counts, in input pixels
+const int SCREEN_LEAD_FRAMES = 10;		// Frames analyzed before motion starts
+const int SCREEN_TAIL_FRAMES = 10;		// and after it stops
+const int SCREEN_MIN_SKIP_FRAMES = 30;	// Idle stretches shorter than this are analyzed anyway;  seeking costs decoding from a keyframe.
+
+class MotionScreen
+{
+public:
+	MotionScreen();
+	~MotionScreen();
+
+	bool screen(string videoPath, Rect laneRegion);
+	void clear();
+
+	int nextActive(int frameNum);
+	int getFrameCount();
+	int getActiveFrames();
+
+private:
+
+	void addMotion(int frameNum);
+
+	vector<pair<int, int>> stretches;	// First and last frame of each stretch with motion, in order, not overlapping
+	int frameCount = 0;
+};
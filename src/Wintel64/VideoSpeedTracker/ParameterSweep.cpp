@@ -0,0 +1,378 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "ParameterSweep.h"
+#include "MotionMask.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+
+ParameterSweep::ParameterSweep()
+{
+}
+
+
+ParameterSweep::~ParameterSweep()
+{
+	for (int i = 0; i < trackers.size(); i++) delete trackers[i];
+	for (int i = 0; i < maskCaches.size(); i++) delete maskCaches[i];
+}
+
+
+// Parallel loop bodies.  Each index belongs to exactly one thread, and each writes only its own masks or its own tracker.
+
+class MaskBuilder : public ParallelLoopBody
+{
+public:
+	MaskBuilder(ParameterSweep* inSweep) : sweep(inSweep) {}
+	virtual void operator()(const Range& range) const { sweep->buildMasks(range.start, range.end); }
+private:
+	ParameterSweep* sweep;
+};
+
+class CacheAccessor : public ParallelLoopBody
+{
+public:
+	CacheAccessor(ParameterSweep* inSweep) : sweep(inSweep) {}
+	virtual void operator()(const Range& range) const { sweep->accessCaches(range.start, range.end); }
+private:
+	ParameterSweep* sweep;
+};
+
+class TrackerRunner : public ParallelLoopBody
+{
+public:
+	TrackerRunner(ParameterSweep* inSweep) : sweep(inSweep) {}
+	virtual void operator()(const Range& range) const { sweep->runTrackers(range.start, range.end); }
+private:
+	ParameterSweep* sweep;
+};
+
+
+bool ParameterSweep::setParameter(Globals& g, string name, int value){
+	if (name == "SENSITIVITY_VALUE") g.SENSITIVITY_VALUE = value;
+	else if (name == "BLUR_SIZE") g.BLUR_SIZE = value;
+	else if (name == "SLOP") g.SLOP = value;
+	else if (name == "maxL2RDistOnEntry") g.maxL2RDistOnEntry = value;
+	else if (name == "maxR2LDistOnEntry") g.maxR2LDistOnEntry = value;
+	else if (name == "entryLookBack") g.entryLookBack = value;
+	else if (name == "obstruction_extent") g.obstruction_extent = value;
+	else if (name == "largeVehicleArea") g.largeVehicleArea = value;
+	else if (name == "nextHeight") g.nextHeight = value;
+	else return false;
+	return true;
+}
+
+
+bool ParameterSweep::readSweepConfig(string path, Globals& baseG){
+	ifstream sweepIn(path);
+	if (!sweepIn.good()){
+		cout << "Can't open " << path << "." << endl;
+		return false;
+	}
+	Globals scratch;
+	string inLine;
+	while (getline(sweepIn, inLine)){
+		inLine = inLine.substr(0, inLine.find('#'));
+		int equals = inLine.find('=');
+		if (equals == string::npos) continue;  // blank or comment line
+		SweepParameter parameter;
+		istringstream lhsIn(inLine.substr(0, equals));
+		lhsIn >> parameter.name;
+		if (!setParameter(scratch, parameter.name, 0)){
+			cout << "Can't sweep <" << parameter.name << ">.  Check sweep.cfg.  Aborting." << endl;
+			return false;
+		}
+		string rhs = inLine.substr(equals + 1);
+		replace(rhs.begin(), rhs.end(), '[', ' ');
+		replace(rhs.begin(), rhs.end(), ']', ' ');
+		replace(rhs.begin(), rhs.end(), ',', ' ');
+		istringstream rhsIn(rhs);
+		int value;
+		while (rhsIn >> value) parameter.values.push_back(value);
+		if (parameter.values.empty()){
+			cout << "No values given for " << parameter.name << ".  Check sweep.cfg.  Aborting." << endl;
+			return false;
+		}
+		parameters.push_back(parameter);
+	}
+	sweepIn.close();
+
+// Cartesian product of all parameter values; the last parameter listed varies fastest.
+	int numConfigurations = 1;
+	for (int p = 0; p < parameters.size(); p++) numConfigurations *= parameters[p].values.size();
+	for (int c = 0; c < numConfigurations; c++){
+		SpeedTracker* tracker = new SpeedTracker();
+		Globals g = baseG;
+		string label;
+		int remainder = c;
+		for (int p = parameters.size() - 1; p >= 0; p--){
+			int value = parameters[p].values[remainder % parameters[p].values.size()];
+			remainder /= parameters[p].values.size();
+			setParameter(g, parameters[p].name, value);
+			label = parameters[p].name + "=" + intToString(value) + (label.empty() ? "" : " ") + label;
+		}
+		tracker->configure(g);
+		configurations.push_back(g);
+		Point variant(g.SENSITIVITY_VALUE, g.BLUR_SIZE);
+		int v = find(maskVariants.begin(), maskVariants.end(), variant) - maskVariants.begin();
+		if (v == maskVariants.size()) maskVariants.push_back(variant);
+		trackers.push_back(tracker);
+		labels.push_back(label.empty() ? "VST.cfg" : label);
+		trackerVariant.push_back(v);
+		AnalysisFrames.push_back(Mat::zeros(tracker->AnalysisBox.size(), CV_8UC3));
+	}
+	masks.resize(maskVariants.size());
+	trackerMessages.resize(trackers.size());
+	scaledBlurs.resize(maskVariants.size());
+	for (int v = 0; v < maskVariants.size(); v++) maskCaches.push_back(new MaskCache());
+	pairsRead.resize(maskVariants.size());
+	cacheFrameNumbers.resize(maskVariants.size());
+	cout << "Sweep: " << getNumConfigurations() << " configurations, " << getNumMaskVariants() << " distinct motion masks per frame pair." << endl;
+	return true;
+}
+
+
+bool ParameterSweep::open(string statsPathPrefix, SpeedTracker& settings){
+// Every configuration gets its own stats file, statsPathPrefix_<configuration number>.csv, with the same reporting thresholds.
+	for (int c = 0; c < trackers.size(); c++){
+		trackers[c]->speedLimit = settings.speedLimit;
+		trackers[c]->egregiousSpeedLowerBound = settings.egregiousSpeedLowerBound;
+		trackers[c]->crazySpeed = settings.crazySpeed;
+		trackers[c]->statsFile.open(statsPathPrefix + "_" + intToString(c) + ".csv");
+		if (!trackers[c]->statsFile.is_open()){
+			cout << "Can't open stats file for sweep configuration " << c << endl;
+			return false;
+		}
+		trackers[c]->statsFile << "# " << labels[c] << endl;
+		trackers[c]->statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
+	}
+	return true;
+}
+
+
+void ParameterSweep::startFile(string fileName){
+	for (int c = 0; c < trackers.size(); c++) trackers[c]->startFile(fileName);
+}
+
+
+void ParameterSweep::scaleTo(VideoFile &capture){
+// Fit every configuration to this video's frame size and rate.  The analysis box isn't swept, so it comes out the same for all of them.
+	for (int c = 0; c < trackers.size(); c++){
+		Globals g = configurations[c];
+		g.scaleTo(int(capture.getFrameWidth()), int(capture.getFrameHeight()), capture.getFPS(), g.ProcessingScale);
+		trackers[c]->configure(g);
+		scaledBlurs[trackerVariant[c]] = g.BLUR_SIZE;
+		if (AnalysisFrames[c].size() != trackers[c]->AnalysisBox.size()) AnalysisFrames[c] = Mat::zeros(trackers[c]->AnalysisBox.size(), CV_8UC3);
+	}
+}
+
+
+bool ParameterSweep::processFile(string FName, int inStartFrame, bool useMaskCache){
+	VideoFile capture;
+	if (!capture.open(FName)){  // Opened first, for its frame size and rate.  Nothing is decoded if the masks are all cached.
+		cout << "ERROR ACQUIRING VIDEO FEED\n";
+		return false;
+	}
+	scaleTo(capture);
+	Rect AnalysisBox = trackers[0]->AnalysisBox;
+	Rect inputBox = trackers[0]->inputBox;
+
+	startFrame = inStartFrame;
+	masksFromCache = useMaskCache;
+	for (int v = 0; v < maskVariants.size() && masksFromCache; v++)
+		masksFromCache = maskCaches[v]->openForRead(FName, AnalysisBox, maskVariants[v].x, scaledBlurs[v], startFrame);
+	differences.clear();
+	batchFrameNumbers.clear();
+
+	if (masksFromCache){
+		capture.release();
+		cout << "Reading motion masks for all " << maskVariants.size() << " variants from cache." << endl;
+		while (readBatch()) processBatch();
+		for (int v = 0; v < maskVariants.size(); v++) maskCaches[v]->close();
+		return true;
+	}
+
+	capture.setLumaRows(inputBox.y, inputBox.height);  // Only the AnalysisBox rows are ever looked at.
+	for (int v = 0; v < maskVariants.size() && useMaskCache; v++)
+		maskCaches[v]->openForWrite(FName, AnalysisBox, maskVariants[v].x, scaledBlurs[v], startFrame);
+
+	Mat luma1, luma2;
+	Rect lumaBox(inputBox.x, 0, inputBox.width, inputBox.height);  // AnalysisBox, within the rows readLuma() returns
+	int frameNumber = startFrame;
+
+	bool decodeFailed = false;
+
+	capture.seek(startFrame);
+	while (capture.getPosition() < capture.getFrameCount() - 2){ // minus 2 to prevent reading empty frame at end.
+		// Decoding stays on this thread; it is the one step every configuration shares.
+		if (!capture.readLuma(luma1) || !capture.readLuma(luma2)){  // Index promised more frames than the file has.
+			cout << "<" << frameNumber << ">  Can't decode frame " << capture.getPosition() << ".  Rest of file skipped." << endl;
+			decodeFailed = true;
+			break;
+		}
+		Mat differenceImage;
+		cv::absdiff(atProcessingScale(luma1(lumaBox), AnalysisBox.size()), atProcessingScale(luma2(lumaBox), AnalysisBox.size()), differenceImage);
+		differences.push_back(differenceImage);
+		batchFrameNumbers.push_back(frameNumber);
+		frameNumber += 2;
+		if (differences.size() == SWEEP_BATCH_PAIRS) processBatch();
+	}
+	processBatch();
+	capture.release();
+	for (int v = 0; v < maskVariants.size(); v++){
+		if (!decodeFailed) maskCaches[v]->finish();  // Every pair written, so the caches are complete.
+		maskCaches[v]->close();
+	}
+	return true;
+}
+
+
+bool ParameterSweep::readBatch(){
+// Fill the next batch from the mask caches, one variant per thread.  All caches were made from the same video, so they line up.
+	cv::parallel_for_(Range(0, int(maskVariants.size())), CacheAccessor(this));
+	int batchPairs = *min_element(pairsRead.begin(), pairsRead.end());
+	batchFrameNumbers.assign(cacheFrameNumbers[0].begin(), cacheFrameNumbers[0].begin() + batchPairs);
+	return batchPairs > 0;
+}
+
+
+void ParameterSweep::processBatch(){
+	if (batchFrameNumbers.empty()) return;
+	if (!masksFromCache){
+		for (int v = 0; v < masks.size(); v++) masks[v].resize(differences.size());
+		cv::parallel_for_(Range(0, int(maskVariants.size() * differences.size())), MaskBuilder(this));
+		if (maskCaches[0]->isWriting()) cv::parallel_for_(Range(0, int(maskVariants.size())), CacheAccessor(this));
+	}
+	cv::parallel_for_(Range(0, int(trackers.size())), TrackerRunner(this));
+	for (int c = 0; c < trackers.size(); c++){  // Printed now, whole lines, one configuration after another
+		istringstream messages(trackerMessages[c]);
+		string line;
+		while (getline(messages, line)) cout << "Config " << c << ":  " << line << endl;
+	}
+	differences.clear();
+	batchFrameNumbers.clear();
+}
+
+
+void ParameterSweep::accessCaches(int first, int last){
+	for (int v = first; v < last; v++){
+		if (maskCaches[v]->isWriting()){  // Write this batch's masks, before any tracker gets at them.
+			for (int pair = 0; pair < batchFrameNumbers.size(); pair++) maskCaches[v]->write(batchFrameNumbers[pair], masks[v][pair]);
+			continue;
+		}
+		masks[v].resize(SWEEP_BATCH_PAIRS);
+		cacheFrameNumbers[v].resize(SWEEP_BATCH_PAIRS);
+		pairsRead[v] = 0;
+		int frameNum;
+		while (pairsRead[v] < SWEEP_BATCH_PAIRS && maskCaches[v]->read(frameNum, masks[v][pairsRead[v]])){
+			if (frameNum < startFrame) continue;
+			cacheFrameNumbers[v][pairsRead[v]++] = frameNum;
+		}
+	}
+}
+
+
+void ParameterSweep::buildMasks(int first, int last){
+	for (int i = first; i < last; i++){
+		int v = i / differences.size();
+		int pair = i % differences.size();
+		thresholdDifference(differences[pair], masks[v][pair], maskVariants[v].x, scaledBlurs[v]);
+	}
+}
+
+
+void ParameterSweep::runTrackers(int first, int last){
+	for (int c = first; c < last; c++){
+		ostringstream messages;
+		consoleBuffer = &messages;  // See Globals.h
+		for (int pair = 0; pair < batchFrameNumbers.size(); pair++){
+			Mat thresholdImage = masks[trackerVariant[c]][pair].clone();  // findContours() scribbles on its input, and the mask is shared.
+			trackers[c]->manageMovers(thresholdImage, AnalysisFrames[c], batchFrameNumbers[pair]);
+		}
+		consoleBuffer = NULL;
+		trackerMessages[c] = messages.str();
+	}
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * R e p o r t i n g * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+double percentile(vector<int>& sortedSpeeds, double fraction){
+	if (sortedSpeeds.empty()) return 0.0;
+	int index = min(int(fraction * sortedSpeeds.size()), int(sortedSpeeds.size()) - 1);
+	return sortedSpeeds[index];
+}
+
+
+void ParameterSweep::report(string reportPath){
+// One row per configuration.  A speed attempt is a vehicle tracked across the first speed line;  it yields a valid speed if it made it into
+// the stats file with 0 <= speed <= crazySpeed.  Speed distribution columns are over valid speeds, both directions.
+	ofstream reportFile(reportPath);
+	reportFile << "Config, Parameters, L2R, R2L, Attempts, Invalid %, Mean, Median, 85th, Over Limit %, Egregious %" << endl;
+	cout << endl << "Config     L2R    R2L  Invalid%   Mean  Median   85th  >Limit%  Egregious%   Parameters" << endl;
+	for (int c = 0; c < trackers.size(); c++){
+		vector<int> L2RSpeeds = trackers[c]->getSpeeds(L2R);
+		vector<int> R2LSpeeds = trackers[c]->getSpeeds(R2L);
+		vector<int> valid;
+		for (int i = 0; i < L2RSpeeds.size(); i++) if (L2RSpeeds[i] >= 0 && L2RSpeeds[i] <= trackers[c]->crazySpeed) valid.push_back(L2RSpeeds[i]);
+		for (int i = 0; i < R2LSpeeds.size(); i++) if (R2LSpeeds[i] >= 0 && R2LSpeeds[i] <= trackers[c]->crazySpeed) valid.push_back(R2LSpeeds[i]);
+		sort(valid.begin(), valid.end());
+
+		int attempts = trackers[c]->getSpeedAttempts();
+		double invalidPct = attempts > 0 ? 100.0 * max(attempts - int(valid.size()), 0) / attempts : 0.0;
+		double mean = 0.0;
+		int overLimit = 0, egregious = 0;
+		for (int i = 0; i < valid.size(); i++){
+			mean += valid[i];
+			if (valid[i] > trackers[c]->speedLimit) overLimit++;
+			if (valid[i] >= trackers[c]->egregiousSpeedLowerBound) egregious++;
+		}
+		if (!valid.empty()) mean /= valid.size();
+		double overLimitPct = valid.empty() ? 0.0 : 100.0 * overLimit / valid.size();
+		double egregiousPct = valid.empty() ? 0.0 : 100.0 * egregious / valid.size();
+
+		reportFile << c << ", " << labels[c] << ", " << L2RSpeeds.size() << ", " << R2LSpeeds.size() << ", " << attempts << ", "
+			<< fixed << setprecision(1) << invalidPct << ", " << mean << ", " << percentile(valid, 0.5) << ", " << percentile(valid, 0.85) << ", "
+			<< overLimitPct << ", " << egregiousPct << endl;
+		cout << setw(6) << c << setw(7) << L2RSpeeds.size() << setw(7) << R2LSpeeds.size()
+			<< fixed << setprecision(1) << setw(10) << invalidPct << setw(7) << mean << setw(8) << percentile(valid, 0.5) << setw(7) << percentile(valid, 0.85)
+			<< setw(9) << overLimitPct << setw(12) << egregiousPct << "   " << labels[c] << endl;
+		trackers[c]->statsFile.close();
+	}
+	reportFile.close();
+	cout << endl << "Sweep comparison written to " << reportPath << endl;
+}
+
+
+int ParameterSweep::getNumConfigurations(){
+	return trackers.size();
+}
+
+
+int ParameterSweep::getNumMaskVariants(){
+	return maskVariants.size();
+}
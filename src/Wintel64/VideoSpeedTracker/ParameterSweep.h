@@ -0,0 +1,102 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include "SpeedTracker.h"
+#include "MotionMask.h"
+#include "VideoFile.h"
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+// A ParameterSweep runs one SpeedTracker per combination of the parameter values listed in sweep.cfg, all over the same footage.
+// Each frame pair is decoded and differenced once.  The difference is thresholded once per distinct SENSITIVITY_VALUE/BLUR_SIZE
+// combination, and configurations that differ only in tracker parameters (SLOP, maxL2RDistOnEntry, ...) share that mask.  Frame
+// pairs are handled in batches: masks for the batch are built in parallel, then the trackers run in parallel, one per configuration.
+// With the mask cache on, each mask variant is read from (or written to) its own .vsm file; if all of them are cached, the video
+// isn't decoded at all.
+//
+// sweep.cfg syntax, one parameter per line, any order, any subset of the parameters below:
+//      <name> = [<value>,<value>,...]  #  Anything can follow the #
+// Parameters not listed keep their VST.cfg values.  Like VST.cfg's, values are in reference pixels, and are scaled to each file's video.
+
+const int SWEEP_BATCH_PAIRS = 32;  // Frame pairs buffered per batch.  Bounded so the masks for every variant fit comfortably in memory.
+
+struct SweepParameter
+{
+	string name;
+	vector<int> values;
+};
+
+class ParameterSweep
+{
+public:
+	ParameterSweep();
+	~ParameterSweep();
+
+	bool readSweepConfig(string path, Globals& baseG);
+	bool open(string statsPathPrefix, SpeedTracker& settings);
+	void startFile(string fileName);
+	bool processFile(string FName, int startFrame, bool useMaskCache);
+	void report(string reportPath);
+
+	int getNumConfigurations();
+	int getNumMaskVariants();
+
+	// Used by the parallel loop bodies
+	void buildMasks(int first, int last);
+	void accessCaches(int first, int last);
+	void runTrackers(int first, int last);
+
+private:
+
+	bool setParameter(Globals& g, string name, int value);
+	void processBatch();
+	bool readBatch();
+	void scaleTo(VideoFile &capture);
+
+	vector<SweepParameter> parameters;
+	vector<SpeedTracker*> trackers;		// One per configuration
+	vector<Globals> configurations;		// Each tracker's configuration as read, in reference pixels
+	vector<string> labels;				// "SENSITIVITY_VALUE=30 BLUR_SIZE=20 ..." per configuration
+	vector<int> trackerVariant;			// Index into maskVariants per configuration
+	vector<Mat> AnalysisFrames;			// Scratch frame per tracker;  never drawn on, as nothing is shown
+	vector<string> trackerMessages;		// What each tracker printed during the batch, to be shown once they're all done
+	vector<Point> maskVariants;			// x = SENSITIVITY_VALUE, y = BLUR_SIZE
+	vector<int> scaledBlurs;			// BLUR_SIZE of each mask variant, scaled to the video being processed
+
+	vector<Mat> differences;			// absdiff() of each frame pair in the batch
+	vector<int> batchFrameNumbers;		// First frame number of each frame pair in the batch
+	vector<vector<Mat> > masks;			// [mask variant][frame pair in batch]
+
+	vector<MaskCache*> maskCaches;		// One per mask variant
+	bool masksFromCache = false;		// Reading all masks from cache rather than decoding?
+	int startFrame = 0;
+	vector<int> pairsRead;				// Frame pairs read into the batch, per mask variant
+	vector<vector<int> > cacheFrameNumbers;	// [mask variant][frame pair in batch], when reading from cache
+};
@@ -1,60 +1,60 @@
-//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
-//                                     All rights reserved.
-
-//                                     License Agreement
-//                                For VideoSpeedTracker (VST)
-//                                 (3 - clause BSD License)
-
-// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
-// conditions are met :
-
-// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
-// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
-//      in the documentation and / or other materials provided with the distribution.
-// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-
-// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
-// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
-// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
-// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
-// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
-// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
-
-
-#include "Projection.h"
-//  #include "VehicleDynamics.h"
-
-
-Projection::Projection()
-{
-}
-
-Projection::Projection(Rect inBox, vehicleStatus inVState, int inVelocity, int inFrameNum)
-{
-	Projection::box = inBox;
-	Projection::vState = inVState;
-	Projection::velocity = inVelocity;
-	Projection::frameNum = inFrameNum;
-}
-
-Projection::~Projection()
-{
-}
-
-Rect Projection::getBox(){
-	return Projection::box;
-}
-
-vehicleStatus Projection::getVState(){
-	return Projection::vState;
-}
-
-int Projection::getVelocity(){
-	return Projection::velocity;
-}
-
-int Projection::getFrameNum(){
-	return Projection::frameNum;
-}
-
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+
+#include "Projection.h"
+//  #include "VehicleDynamics.h"
+
+
+Projection::Projection()
+{
+}
+
+Projection::Projection(Rect inBox, vehicleStatus inVState, int inVelocity, int inFrameNum)
+{
+	Projection::box = inBox;
+	Projection::vState = inVState;
+	Projection::velocity = inVelocity;
+	Projection::frameNum = inFrameNum;
+}
+
+Projection::~Projection()
+{
+}
+
+Rect Projection::getBox(){
+	return Projection::box;
+}
+
+vehicleStatus Projection::getVState(){
+	return Projection::vState;
+}
+
+int Projection::getVelocity(){
+	return Projection::velocity;
+}
+
+int Projection::getFrameNum(){
+	return Projection::frameNum;
+}
+
@@ -0,0 +1,105 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "RawVideo.h"
+#include <iostream>
+#include <io.h>
+#include <fcntl.h>
+
+
+RawVideo::RawVideo()
+{
+}
+
+
+RawVideo::~RawVideo()
+{
+	close();
+}
+
+
+bool RawVideo::open(string source, rawLayout inLayout, int inWidth, int inHeight){
+// source is the name of a named pipe (e.g. \\.\pipe\vst) or file, or "-" for stdin.
+	close();
+	if (inWidth <= 0 || inHeight <= 0 || (inWidth % 2) != 0 || (inHeight % 2) != 0){  // 4:2:0 chroma needs even dimensions.
+		cout << "Raw video frame size must be positive and even: " << inWidth << "x" << inHeight << endl;
+		return false;
+	}
+	layout = inLayout;
+	width = inWidth;
+	height = inHeight;
+	fromStdin = (source == "-");
+	if (fromStdin){  // Video comes in on stdin;  the setup questions are answered at the console instead.
+		int videoHandle = _dup(_fileno(stdin));
+		_setmode(videoHandle, _O_BINARY);
+		input = _fdopen(videoHandle, "rb");
+		freopen("CONIN$", "r", stdin);
+	}
+	else input = fopen(source.c_str(), "rb");
+	if (input == NULL){
+		cout << "Can't open raw video input " << source << endl;
+		return false;
+	}
+	setvbuf(input, NULL, _IOFBF, 1 << 20);  // Pipes deliver in small pieces;  read in big ones.
+	return true;
+}
+
+
+void RawVideo::close(){
+	if (input != NULL) fclose(input);
+	input = NULL;
+}
+
+
+bool RawVideo::isOpened(){
+	return input != NULL;
+}
+
+
+bool RawVideo::read(Mat &rawFrame){
+// One whole frame: height rows of luma, then height/2 rows' worth of chroma.  Reuses rawFrame's buffer when it can.
+	if (input == NULL) return false;
+	rawFrame.create(height * 3 / 2, width, CV_8UC1);
+	size_t frameBytes = rawFrame.total();
+	return fread(rawFrame.data, 1, frameBytes, input) == frameBytes;  // A short read means the writer is done.
+}
+
+
+Mat RawVideo::luma(const Mat &rawFrame){
+	return rawFrame.rowRange(0, height);  // Shares rawFrame's data.
+}
+
+
+void RawVideo::toBGR(const Mat &rawFrame, Mat &BGRFrame){
+	cv::cvtColor(rawFrame, BGRFrame, (layout == NV12) ? COLOR_YUV2BGR_NV12 : COLOR_YUV2BGR_I420);
+}
+
+
+int RawVideo::getFrameWidth(){
+	return width;
+}
+
+
+int RawVideo::getFrameHeight(){
+	return height;
+}
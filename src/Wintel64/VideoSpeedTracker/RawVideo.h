@@ -0,0 +1,62 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+using namespace cv;
+
+// A RawVideo reads uncompressed planar YUV frames, as written by e.g.  ffmpeg -i <camera> -f rawvideo -pix_fmt yuv420p -,
+// from stdin or a named pipe.  Each frame is read whole into one buffer:  the Y plane (luma) on top, chroma below it.  Motion
+// detection only needs luma, and luma() hands back the Y plane in place, with no copy and no color conversion.  Chroma is
+// only looked at when a color frame is really needed (highlights), by toBGR().
+
+enum rawLayout { I420, NV12 };  // I420 (yuv420p):  Y, then U, then V planes.  NV12:  Y, then interleaved UV.
+
+class RawVideo
+{
+public:
+	RawVideo();
+	~RawVideo();
+
+	bool open(string source, rawLayout inLayout, int inWidth, int inHeight);
+	void close();
+	bool isOpened();
+	bool read(Mat &rawFrame);
+	Mat luma(const Mat &rawFrame);
+	void toBGR(const Mat &rawFrame, Mat &BGRFrame);
+
+	int getFrameWidth();
+	int getFrameHeight();
+
+private:
+
+	FILE* input = NULL;
+	bool fromStdin = false;
+	rawLayout layout = I420;
+	int width = 0;
+	int height = 0;
+};
@@ -0,0 +1,245 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "SiteEngine.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+
+
+SiteEngine::SiteEngine()
+{
+}
+
+
+SiteEngine::~SiteEngine()
+{
+	for (int s = 0; s < sites.size(); s++) delete sites[s];
+}
+
+
+bool SiteEngine::readSitesConfig(string path){
+	ifstream sitesIn(path);
+	if (!sitesIn.good()){
+		cout << "Can't open " << path << "." << endl;
+		return false;
+	}
+	time_t now = time(0);
+	char stamp[16];
+	strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+	runName = stamp;
+
+	string inLine;
+	while (getline(sitesIn, inLine)){
+		inLine = inLine.substr(0, inLine.find('#'));
+		int equals = inLine.find('=');
+		if (equals == string::npos) continue;  // blank or comment line
+		Site* site = new Site();
+		sites.push_back(site);  // Deleted with the engine, whatever happens below.
+		site->name = stripped(inLine.substr(0, equals));
+		vector<string> fields;
+		istringstream rhsIn(inLine.substr(equals + 1));
+		string field;
+		while (getline(rhsIn, field, ',')) fields.push_back(stripped(field));
+		if (site->name.empty() || fields.size() < 2 || fields[0].empty() || fields[1].empty()){
+			cout << "Each site needs a name, a config file and an input directory.  Check " << path << ".  Aborting." << endl;
+			return false;
+		}
+		for (int s = 0; s < sites.size() - 1; s++){
+			if (sites[s]->name == site->name){
+				cout << "Site " << site->name << " is listed twice.  Check " << path << ".  Aborting." << endl;
+				return false;
+			}
+		}
+
+		cout << endl << "Site " << site->name << ":" << endl;
+		if (!site->g.readConfig(fields[0])) return false;
+		site->inputPath = fields[1];
+		SpeedTracker &tracker = site->tracker;
+		tracker.configure(site->g);
+		tracker.headless = true;
+		if (fields.size() > 2 && (!readInt(fields[2], tracker.speedLimit) || tracker.speedLimit <= 0)){
+			cout << "Site " << site->name << "'s speed limit isn't a positive whole number.  Check " << path << ".  Aborting." << endl;
+			return false;
+		}
+		tracker.egregiousSpeedLowerBound = tracker.speedLimit + 10;
+		tracker.crazySpeed = tracker.egregiousSpeedLowerBound + 20;  // Stats reporting will flag anything faster than this.
+		if (fields.size() > 3){
+			if (!readInt(fields[3], tracker.highLightsSpeedLower) || tracker.highLightsSpeedLower < 0){
+				cout << "Site " << site->name << "'s highlights speed isn't a whole number.  Check " << path << ".  Aborting." << endl;
+				return false;
+			}
+			site->hiLitePath = site->g.dataPathPrefix + "\\HiLites\\Hilites_" + site->name + "_" + runName + ".avi";
+		}
+		tracker.statsFile.open(site->g.dataPathPrefix + "\\stats\\stats_" + site->name + "_" + runName + ".csv");
+		tracker.summaryPrefix = site->g.dataPathPrefix + "\\stats\\summary_" + site->name + "_";
+		if (!tracker.statsFile.is_open()){
+			cout << "Can't open the stats file for site " << site->name << "." << endl;
+			return false;
+		}
+		tracker.statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
+		if (!listFiles(*site)) return false;
+	}
+	sitesIn.close();
+	if (sites.empty()){
+		cout << "No sites listed in " << path << "." << endl;
+		return false;
+	}
+	return true;
+}
+
+
+bool SiteEngine::listFiles(Site &site){
+// Every video file in the site's input directory, in name order (which, for camera files, is time order).
+	string listPath = site.inputPath + "\\files.txt";
+	string sysString = "dir " + site.inputPath + "\\*.avi " + site.inputPath + "\\*.y4m " + site.inputPath + "\\*.gray /b > " + listPath;
+	system(sysString.c_str());
+	ifstream filesIn(listPath);
+	string fileName;
+	while (getline(filesIn, fileName)){
+		if (!fileName.empty()) site.files.push_back(site.inputPath + "\\" + fileName);
+	}
+	filesIn.close();
+	sort(site.files.begin(), site.files.end());
+	if (site.files.empty()){
+		cout << "No video files in " << site.inputPath << " for site " << site.name << "." << endl;
+		return false;
+	}
+	cout << site.files.size() << " files to analyze for site " << site.name << "." << endl;
+	return true;
+}
+
+
+bool Site::openNextFile(){
+// Open the site's next input file, and fit the site's configuration to it.  False once all files are done.
+	capture.release();
+	while (nextFile < files.size()){
+		string FName = files[nextFile++];
+		if (!capture.open(FName)){
+			cout << name << ":  can't open " << FName << ".  Skipping it." << endl;
+			continue;
+		}
+		Globals scaled = g;
+		scaled.scaleTo(int(capture.getFrameWidth()), int(capture.getFrameHeight()), capture.getFPS(), g.ProcessingScale);
+		tracker.configure(scaled);
+		tracker.startFile(FName.substr(FName.find_last_of('\\') + 1));  // The stats file takes date and time from the file name.
+		capture.setLumaRows(tracker.inputBox.y, tracker.inputBox.height);  // readLuma() returns just the AnalysisBox rows.
+		lumaBox = Rect(tracker.inputBox.x, 0, tracker.inputBox.width, tracker.inputBox.height);
+		AnalysisFrame = Mat::zeros(tracker.AnalysisBox.size(), CV_8UC3);  // Never shown, so drawn on only for highlights.
+		frameNumber = 0;
+
+		Size frameSize(scaled.frameWidth, scaled.frameHeight);
+		if (!hiLitePath.empty() && hiLiteSize.area() == 0){  // Highlights file is opened for the first file, at its size.
+			if (tracker.openHiLites(hiLitePath, CV_FOURCC('M', 'J', 'P', 'G'), scaled.inputFPS, tracker.hiLiteFrameSize())) hiLiteSize = frameSize;  // No one to pick a codec from a list.
+			else{
+				cout << name << ":  can't open " << hiLitePath << ".  No highlights." << endl;
+				hiLitePath.clear();
+			}
+		}
+		tracker.highLightsPlease = (hiLiteSize.area() > 0 && frameSize == hiLiteSize);  // Every highlights frame is the same size.
+		cout << name << ":  analyzing " << FName << endl;
+		return true;
+	}
+	return false;
+}
+
+
+bool Site::takeTurn(){
+// Analyze the site's next SITE_TURN_PAIRS frame pairs, going on to its next file as each ends.  False once the site has no more.
+	for (int pair = 0; pair < SITE_TURN_PAIRS; pair++){
+		while (!capture.isOpened() || capture.getPosition() >= capture.getFrameCount() - 2){ // minus 2 to prevent reading empty frame at end.
+			if (!openNextFile()) return false;
+		}
+		bool pairRead = tracker.highLightsPlease  // Highlights are in color.  Otherwise luma is all that's needed, and only the AnalysisBox rows of it.
+			? capture.read(frame1) && capture.read(frame2) : capture.readLuma(luma1) && capture.readLuma(luma2);
+		if (!pairRead){  // Truncated or damaged file:  on to the next one.
+			cout << name << ":  can't decode frame " << capture.getPosition() << ".  Rest of file skipped." << endl;
+			capture.release();
+			continue;
+		}
+		if (tracker.highLightsPlease){
+			tracker.frame1 = frame1;  // Its date/time stamp goes into highlights.
+			tracker.differencePair(frame1, frame2, thresholdImage, AnalysisFrame);
+		}
+		else tracker.differenceLuma(luma1, luma2, lumaBox, thresholdImage);
+		tracker.manageMovers(thresholdImage, AnalysisFrame, frameNumber);
+		frameNumber += 2;
+	}
+	return true;
+}
+
+
+void SiteEngine::work(){
+// One worker thread:  give the site that has waited longest a turn, then send it to the back of the line, until every site is done.
+	while (true){
+		Site* site;
+		{
+			unique_lock<mutex> lock(turnLock);
+			while (waiting.empty() && sitesLeft > 0) turnReady.wait(lock);  // Every unfinished site is on another thread.
+			if (waiting.empty()) return;  // Every site is done.
+			site = waiting.front();
+			waiting.pop_front();
+		}
+		bool more = site->takeTurn();
+		{
+			lock_guard<mutex> lock(turnLock);
+			if (more) waiting.push_back(site);
+			else sitesLeft--;
+		}
+		turnReady.notify_all();
+	}
+}
+
+
+bool SiteEngine::run(int numThreads){
+// Analyze every site, on numThreads worker threads (0 for one per core), and close each site's outputs.
+	int cores = max(int(thread::hardware_concurrency()), 1);
+	if (numThreads <= 0) numThreads = cores;
+	numThreads = min(numThreads, int(sites.size()));  // A site is only ever on one thread, so extra threads would only wait.
+	cv::setNumThreads(0);  // The workers are all the threads there should be;  OpenCV's parallel loops would compete with them.
+	FFmpegDecoder::decodeThreads = max(cores / numThreads, 1);  // Cores the workers don't cover (fewer sites than cores) go to decoding.
+
+	cout << endl << "Analyzing " << sites.size() << " sites on " << numThreads << " threads." << endl;
+	waiting.assign(sites.begin(), sites.end());
+	sitesLeft = sites.size();
+	vector<thread> workers;
+	for (int i = 0; i < numThreads; i++) workers.push_back(thread(&SiteEngine::work, this));
+	for (int i = 0; i < numThreads; i++) workers[i].join();
+
+	for (int s = 0; s < sites.size(); s++){
+		SpeedTracker &tracker = sites[s]->tracker;
+		tracker.finishFile();
+		tracker.statsFile.close();
+		if (sites[s]->hiLiteSize.area() > 0) tracker.closeHiLites();
+		cout << sites[s]->name << ":  " << tracker.getSpeeds(L2R).size() << " L2R and " << tracker.getSpeeds(R2L).size() << " R2L speeds from "
+			<< sites[s]->files.size() << " files." << endl;
+	}
+	return true;
+}
+
+
+int SiteEngine::getNumSites(){
+	return sites.size();
+}
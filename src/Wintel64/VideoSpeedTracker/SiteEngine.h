@@ -0,0 +1,103 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include "SpeedTracker.h"
+#include "VideoFile.h"
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+using namespace cv;
+
+// A SiteEngine analyzes several sites (streets) at once in one process, each with its own VST.cfg and its own input files, without
+// questions or windows.  Every site has its own SpeedTracker, so tracker state, stats file and highlights file are never shared.
+// Sites take turns on a pool of worker threads, one thread per core:  a turn is SITE_TURN_PAIRS frame pairs, after which the site
+// goes to the back of the line.  So every site gets an even share of the cores however many there are, and there are never more
+// busy threads than cores.  A site's frame pairs must be tracked in order, so a site is never on more than one thread at a time.
+// OpenCV's own threading is turned off, and each FFmpeg decoder gets an even share of the cores, for the same reason.
+//
+// sites.cfg syntax, one site per line:
+//      <site name> = <config file>, <input directory> [, <speed limit> [, <highlights speed>]]  #  Anything can follow the #
+// Every .avi, .y4m and .gray file in the input directory is analyzed, in name order.  Stats go to
+// <dataPathPrefix>\Stats\stats_<site name>_<run>.csv, with dataPathPrefix from the site's config file.  If a highlights speed is
+// given, vehicles at least that fast go to <dataPathPrefix>\HiLites\Hilites_<site name>_<run>.avi.
+
+const int SITE_TURN_PAIRS = 16;  // Frame pairs a site analyzes per turn on a worker thread.
+
+// A Site is one street's configuration, tracker and input files, and where it is in them.  takeTurn() analyzes the next few
+// frame pairs, opening each input file in turn as the one before it ends.  Files may be added to the list at any time.
+
+struct Site
+{
+	bool openNextFile();
+	bool takeTurn();
+
+	string name;
+	Globals g;				// As read from the site's config file, in reference pixels
+	SpeedTracker tracker;
+	string inputPath;		// Directory holding the site's input files
+	vector<string> files;	// Input files (full paths), in the order they are analyzed
+	int nextFile = 0;		// Index into files of the next file to open
+	string hiLitePath;		// Highlights file, opened at the frame size of the first file after it is set;  empty for none
+	VideoFile capture;		// File being analyzed;  not open between files
+	int frameNumber = 0;
+	Rect lumaBox;			// AnalysisBox, in readLuma() rows
+	Mat frame1, frame2;		// Color frames, when making highlights
+	Mat luma1, luma2;		// AnalysisBox rows of luma, otherwise
+	Mat thresholdImage;
+	Mat AnalysisFrame;
+	Size hiLiteSize;		// Frame size of the highlights file, once opened
+};
+
+class SiteEngine
+{
+public:
+	SiteEngine();
+	~SiteEngine();
+
+	bool readSitesConfig(string path);
+	bool run(int numThreads);
+
+	int getNumSites();
+
+private:
+
+	bool listFiles(Site &site);
+	void work();
+
+	vector<Site*> sites;
+	string runName;			// yyyymmdd_hhmmss the run started, in output file names
+
+	deque<Site*> waiting;	// Sites waiting for a turn, first come first served
+	int sitesLeft = 0;		// Sites not finished yet, waiting or taking a turn
+	mutex turnLock;
+	condition_variable turnReady;
+};
@@ -0,0 +1,189 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "SpeedSummary.h"
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+SpeedSummary::SpeedSummary()
+{
+}
+
+
+SpeedSummary::~SpeedSummary()
+{
+}
+
+
+void SpeedSummary::clear(){
+	histograms.clear();
+}
+
+
+bool SpeedSummary::empty(){
+	return histograms.empty();
+}
+
+
+void SpeedSummary::add(string direction, int hour, int speed){
+	direction.erase(remove(direction.begin(), direction.end(), '"'), direction.end());  // As quoted in VST.cfg
+	vector<int> &histogram = histograms[make_pair(direction, ((hour % 24) + 24) % 24)];
+	if (histogram.empty()) histogram.assign(MAX_SUMMARY_SPEED + 1, 0);
+	histogram[min(max(speed, 0), MAX_SUMMARY_SPEED)]++;
+}
+
+
+void SpeedSummary::merge(const SpeedSummary& other){
+	if (!thresholdsSet && empty()){
+		speedLimit = other.speedLimit;
+		egregiousSpeedLowerBound = other.egregiousSpeedLowerBound;
+		thresholdsSet = true;
+	}
+	for (map<pair<string, int>, vector<int> >::const_iterator cell = other.histograms.begin(); cell != other.histograms.end(); cell++){
+		vector<int> &histogram = histograms[cell->first];
+		if (histogram.empty()) histogram.assign(MAX_SUMMARY_SPEED + 1, 0);
+		for (int speed = 0; speed <= MAX_SUMMARY_SPEED; speed++) histogram[speed] += cell->second[speed];
+	}
+}
+
+
+bool SpeedSummary::write(string path){
+	ofstream out(path, ios::out | ios::trunc);
+	if (!out.is_open()){
+		cout << "Can't write speed summary " << path << endl;
+		return false;
+	}
+	write(out);
+	return out.good();
+}
+
+
+bool SpeedSummary::read(string path){
+// Replaces what the summary held.
+	ifstream in(path);
+	if (!read(in)){
+		cout << path << " is not a speed summary of this version." << endl;
+		return false;
+	}
+	return true;
+}
+
+
+void SpeedSummary::write(ostream& out){
+	out << "VST speed summary, 1" << endl;
+	out << "speedLimit, " << speedLimit << endl;
+	out << "egregiousSpeedLowerBound, " << egregiousSpeedLowerBound << endl;
+	for (map<pair<string, int>, vector<int> >::iterator cell = histograms.begin(); cell != histograms.end(); cell++){
+		for (int speed = 0; speed <= MAX_SUMMARY_SPEED; speed++){
+			if (cell->second[speed] > 0) out << cell->first.first << ", " << cell->first.second << ", " << speed << ", " << cell->second[speed] << endl;
+		}
+	}
+	out << "end" << endl;
+}
+
+
+bool SpeedSummary::read(istream& in){
+// Up to its "end" line, so a summary can be embedded in another file.
+	string line;
+	if (!getline(in, line) || line != "VST speed summary, 1") return false;
+	clear();
+	while (getline(in, line) && line != "end"){
+		vector<string> fields;
+		istringstream row(line);
+		string field;
+		while (getline(row, field, ',')){
+			size_t first = field.find_first_not_of(" ");
+			fields.push_back((first == string::npos) ? "" : field.substr(first));
+		}
+		if (fields.size() == 2 && fields[0] == "speedLimit") speedLimit = stoi(fields[1]);
+		else if (fields.size() == 2 && fields[0] == "egregiousSpeedLowerBound") egregiousSpeedLowerBound = stoi(fields[1]);
+		else if (fields.size() == 4){
+			vector<int> &histogram = histograms[make_pair(fields[0], stoi(fields[1]))];
+			if (histogram.empty()) histogram.assign(MAX_SUMMARY_SPEED + 1, 0);
+			histogram[min(max(stoi(fields[2]), 0), MAX_SUMMARY_SPEED)] += stoi(fields[3]);
+		}
+	}
+	thresholdsSet = true;
+	return true;
+}
+
+
+int SpeedSummary::mergeFiles(string pattern){
+// Merge in every summary file matching pattern (e.g. g:\locustdata\stats\summary_*20160114*.vss).  Returns how many there were.
+	string dirPath = pattern.substr(0, pattern.find_last_of('\\') + 1);
+	int merged = 0;
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA(pattern.c_str(), &found);
+	if (search == INVALID_HANDLE_VALUE) return 0;
+	do{
+		SpeedSummary one;
+		if (one.read(dirPath + found.cFileName)){
+			merge(one);
+			merged++;
+		}
+	} while (FindNextFileA(search, &found));
+	FindClose(search);
+	return merged;
+}
+
+
+void reportRow(ostream& out, string direction, string hour, const vector<int>& histogram, int speedLimit, int egregiousSpeedLowerBound){
+	int vehicles = 0, over = 0, egregious = 0;
+	double speedSum = 0.0;
+	for (int speed = 0; speed <= MAX_SUMMARY_SPEED; speed++){
+		vehicles += histogram[speed];
+		speedSum += double(speed) * histogram[speed];
+		if (speed > speedLimit) over += histogram[speed];
+		if (speed >= egregiousSpeedLowerBound) egregious += histogram[speed];
+	}
+	int median = 0, p85 = 0, seen = 0;  // Lowest speeds at or below which half, and 85%, of the vehicles went
+	int half = (vehicles + 1) / 2, most = (vehicles * 85 + 99) / 100;
+	for (int speed = 0; speed <= MAX_SUMMARY_SPEED; speed++){
+		if (seen < half && seen + histogram[speed] >= half) median = speed;
+		if (seen < most && seen + histogram[speed] >= most) p85 = speed;
+		seen += histogram[speed];
+	}
+	vehicles = max(vehicles, 1);  // For the divisions;  a cell is only there if it has a vehicle.
+	out << direction << ", " << hour << ", " << seen << ", " << fixed << setprecision(1) << speedSum / vehicles << ", " << median << ", " << p85
+		<< ", " << over << ", " << 100.0 * over / vehicles << ", " << egregious << ", " << 100.0 * egregious / vehicles << endl;
+}
+
+
+void SpeedSummary::report(ostream& out){
+// One csv row per direction and hour, then one per direction for all hours.
+	out << "Direction, Hour, Vehicles, Mean, Median, 85th Percentile, Over " << speedLimit << ", % Over " << speedLimit
+		<< ", " << egregiousSpeedLowerBound << " or Over, % " << egregiousSpeedLowerBound << " or Over" << endl;
+	map<string, vector<int> > allHours;
+	for (map<pair<string, int>, vector<int> >::iterator cell = histograms.begin(); cell != histograms.end(); cell++){
+		reportRow(out, cell->first.first, to_string(cell->first.second), cell->second, speedLimit, egregiousSpeedLowerBound);
+		vector<int> &total = allHours[cell->first.first];
+		if (total.empty()) total.assign(MAX_SUMMARY_SPEED + 1, 0);
+		for (int speed = 0; speed <= MAX_SUMMARY_SPEED; speed++) total[speed] += cell->second[speed];
+	}
+	for (map<string, vector<int> >::iterator direction = allHours.begin(); direction != allHours.end(); direction++)
+		reportRow(out, direction->first, "All", direction->second, speedLimit, egregiousSpeedLowerBound);
+}
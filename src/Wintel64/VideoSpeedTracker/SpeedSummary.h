@@ -0,0 +1,68 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+
+using namespace std;
+
+// A SpeedSummary is the per-day summary published from the stats:  for each direction and hour, a histogram of the speeds written
+// to the stats file, to the mile per hour.  Speeds are whole numbers, so the histogram is the whole distribution, not an estimate of
+// it:  vehicle counts, means, medians, 85th percentiles and shares over any speed come out of it exactly, and summaries merge exactly
+// by adding histograms.  The tracker keeps one per input file as it logs vehicles, and writes it next to the stats file, as
+// summary_<input file name>.vss, when the file is done.  "VideoSpeedTracker -summary <files>" merges any set of them (several sites,
+// workers or days) and reports.
+//
+// A .vss file is text:  a version line, speedLimit and egregiousSpeedLowerBound lines, then "direction, hour, speed, vehicles"
+// for every speed seen, then "end".
+
+const int MAX_SUMMARY_SPEED = 255;  // Faster speeds count as this.
+
+class SpeedSummary
+{
+public:
+	SpeedSummary();
+	~SpeedSummary();
+
+	void clear();
+	bool empty();
+	void add(string direction, int hour, int speed);
+	void merge(const SpeedSummary& other);
+
+	bool write(string path);
+	bool read(string path);
+	void write(ostream& out);
+	bool read(istream& in);
+	int mergeFiles(string pattern);
+	void report(ostream& out);
+
+	int speedLimit = 25;				// Thresholds the report gives shares over.  Merging keeps the first summary's.
+	int egregiousSpeedLowerBound = 35;
+
+private:
+	map<pair<string, int>, vector<int> > histograms;  // (direction, hour) -> vehicles at each speed
+	bool thresholdsSet = false;  // By a summary read or merged in
+};
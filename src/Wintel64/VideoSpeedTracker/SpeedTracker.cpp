@@ -0,0 +1,1025 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "SpeedTracker.h"
+#include "MotionMask.h"
+#include <iostream>
+#include <sstream>
+
+
+SpeedTracker::SpeedTracker()
+{
+}
+
+
+SpeedTracker::~SpeedTracker()
+{
+}
+
+
+//int to string helper function
+string intToString(int number){
+	std::stringstream ss;
+	ss << number;
+	return ss.str();
+}
+
+
+void SpeedTracker::configure(const Globals& inG){
+// Take on a configuration, normally the one read from VST.cfg, scaled to the video about to be processed.
+	g = inG;
+// PixelLeft is always zero relative to AnalysisBoxLeft;  PixelRight depends on AnalysisBoxWidth/
+	g.pixelRight = g.AnalysisBoxWidth; // index of rightmost pixel in AnalysisBox.
+	AnalysisBox = Rect(g.AnalysisBoxLeft, g.AnalysisBoxTop, g.AnalysisBoxWidth, g.AnalysisBoxHeight);  // For use when performing speed analysis in cropped region
+	inputBox = Rect(g.inputBoxLeft, g.inputBoxTop, g.inputBoxWidth, g.inputBoxHeight);
+	minObjectArea = max(int(MIN_OBJECT_AREA * g.scaleX * g.scaleY), 1);
+}
+
+
+void SpeedTracker::differencePair(Mat &inFrame1, Mat &inFrame2, Mat &thresholdImage, Mat &AnalysisFrame){
+// Carve the analysis box out of both frames, difference them in gray scale, and make the binary motion mask manageMovers() works on.
+	Mat grayImage1, grayImage2; // for absdiff() function
+	Mat differenceImage;
+	Mat ROIFr1 = atProcessingScale(inFrame1(inputBox), AnalysisBox.size());  // Carve out the analysis box for motion detection
+	cv::cvtColor(ROIFr1, grayImage1, COLOR_BGR2GRAY);  //convert ROIFr1 to gray scale for frame differencing
+	Mat ROIFr2 = atProcessingScale(inFrame2(inputBox), AnalysisBox.size());  // Carve out the analysis box for motion detection
+	cv::cvtColor(ROIFr2, grayImage2, COLOR_BGR2GRAY);   //convert ROIFr2 to gray scale for frame differencing
+	cv::absdiff(grayImage1, grayImage2, differenceImage);   			//perform frame differencing
+	thresholdDifference(differenceImage, thresholdImage, g.SENSITIVITY_VALUE, g.BLUR_SIZE);  //threshold, blur, threshold again to obtain binary image
+	AnalysisFrame = (ROIFr2.size() == inputBox.size()) ? ROIFr2.clone() : ROIFr2;  // Drawn on, so not left pointing into inFrame2.
+}
+
+
+void SpeedTracker::differenceLuma(const Mat &luma1, const Mat &luma2, Rect lumaBox, Mat &thresholdImage){
+// As differencePair(), for frames that are already gray scale.  lumaBox (the analysis box, in luma's coordinates) is differenced in place;
+// nothing is copied or converted, unless it has to be shrunk to processing scale.
+	Mat differenceImage;
+	cv::absdiff(atProcessingScale(luma1(lumaBox), AnalysisBox.size()), atProcessingScale(luma2(lumaBox), AnalysisBox.size()), differenceImage);  //perform frame differencing
+	thresholdDifference(differenceImage, thresholdImage, g.SENSITIVITY_VALUE, g.BLUR_SIZE);  //threshold, blur, threshold again to obtain binary image
+}
+
+
+void SpeedTracker::stampDateTime(Mat &canvas){
+// Copy the date/time stamp at the top left of the input frame to just below the ROI, scaled as the analysis box is.
+	Rect stamp(0, 0, min(240 * frame1.cols / g.ReferenceWidth, frame1.cols), min(29 * frame1.rows / g.ReferenceHeight, frame1.rows));
+	Rect below(int(500 * g.scaleX), int(440 * g.scaleY), max(int(240 * g.scaleX), 1), max(int(29 * g.scaleY), 1));
+	if (compactHiLites) below = Rect(0, 0, below.width, below.height);  // Top left of the caption band
+	below &= Rect(0, 0, canvas.cols, canvas.rows);
+	if (stamp.area() == 0 || below.area() == 0) return;
+	if (stamp.size() == below.size()) frame1(stamp).copyTo(canvas(below));
+	else resize(frame1(stamp), canvas(below), below.size(), 0, 0, INTER_AREA);
+}
+
+
+void SpeedTracker::writeHiLite(const Mat &frame){
+// Frames written are counted, so a checkpoint can say how long the highlights file was.
+	hiLiteVideo.write(frame);
+	hiLiteFramesWritten++;
+}
+
+
+int SpeedTracker::secondOfDay(int inFrame){
+// Time of day at frame inFrame of the input file, in seconds:  the file's start time, from its name, plus the time since.
+// -1 if the file's name doesn't say when it starts (not a camera file).
+	if (fileStartSecond < 0) return -1;
+	return int(fileStartSecond + inFrame / g.inputFPS) % (24 * 3600);
+}
+
+
+Rect SpeedTracker::hiLiteBox(){
+// Where the analysis box goes in a highlights frame:  where it is in the input frame, or under the caption band of a compact one.
+	if (!compactHiLites) return AnalysisBox;
+	return Rect(0, max(int(29 * g.scaleY), 1) + HILITE_CAPTION_HEIGHT, AnalysisBox.width, AnalysisBox.height);
+}
+
+
+Size SpeedTracker::hiLiteFrameSize(){
+// Compact frames are rounded up to even sizes, as encoders want.
+	if (!compactHiLites) return Size(g.frameWidth, g.frameHeight);
+	Rect box = hiLiteBox();
+	return Size((box.width + 1) & ~1, (box.y + box.height + 1) & ~1);
+}
+
+
+Mat& SpeedTracker::startHiLiteClip(){
+// A black highlights frame with just the date/time stamp on it, for a new clip to be composed on.
+	hiLiteCanvas.create(hiLitePartition.size(), hiLitePartition.type());
+	hiLiteCanvas.setTo(Scalar::all(0));
+	stampDateTime(hiLiteCanvas);
+	return hiLiteCanvas;
+}
+
+
+bool SpeedTracker::openHiLites(string path, int fourcc, double fps, Size frameSize){
+// The highlights file, and its index of clips.
+	hiLiteVideo.open(path, fourcc, fps, frameSize, true);
+	if (!hiLiteVideo.isOpened()) return false;
+	hiLiteFramesWritten = 0;
+	hiLitePartition = Mat::zeros(frameSize, CV_8UC3);
+	hiLiteIndex.open(HiLiteIndex::pathFor(path));
+	return true;
+}
+
+
+void SpeedTracker::closeHiLites(){
+	hiLiteVideo.release();
+	hiLiteIndex.close();
+	deferredHiLites.close();
+}
+
+
+void SpeedTracker::addHiLiteClip(int firstFrame, string direction, int speed, int area, int trackStartFrame){
+// List the clip just written, from firstFrame through the partition frame, in the highlights index.
+	HiLiteClip clip;
+	clip.firstFrame = firstFrame;
+	clip.lastFrame = hiLiteFramesWritten - 1;
+	clip.direction = direction;
+	clip.speed = speed;
+	clip.area = area;
+	clip.date = fileDate;
+	int second = secondOfDay(trackStartFrame);
+	if (second >= 0){
+		char hhmmss[7];
+		sprintf(hhmmss, "%02d%02d%02d", second / 3600, (second / 60) % 60, second % 60);
+		clip.time = hhmmss;
+	}
+	clip.sourceFile = fileName;
+	clip.sourceFrame = trackStartFrame;
+	hiLiteIndex.add(clip);
+}
+
+
+void SpeedTracker::finishFile(){
+// Write the speed summary of the input file just done, if summaries are wanted.
+	if (summaryPending && !summaryPrefix.empty()){
+		summary.speedLimit = speedLimit;
+		summary.egregiousSpeedLowerBound = egregiousSpeedLowerBound;
+		summary.write(summaryPrefix + fileName.substr(0, fileName.find_last_of('.')) + ".vss");
+	}
+	summary.clear();
+	summaryPending = false;
+}
+
+
+void SpeedTracker::startFile(string inFileName){
+// Forget all vehicles from the previous input file.
+	finishFile();  // If the caller hasn't already
+	fileName = inFileName;
+	fileDate = (fileName.size() > 7) ? fileName.substr(7, 8) : "";
+	fileTime = (fileName.size() > 15) ? fileName.substr(15, 6) : "";
+	fileStartSecond = -1;
+	if (fileTime.size() == 6 && fileTime.find_first_not_of("0123456789") == string::npos){
+		int hh = stoi(fileTime.substr(0, 2)), mm = stoi(fileTime.substr(2, 2)), ss = stoi(fileTime.substr(4, 2));
+		if (hh < 24 && mm < 60 && ss < 60) fileStartSecond = hh * 3600 + mm * 60 + ss;
+	}
+	summaryPending = true;
+	vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());  // Reinitialize
+	vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());   // Reinitialize  
+	bailing = false;  // Reinitialize
+}
+
+
+bool SpeedTracker::isIdle(){
+// Nothing in track and not bailing: manageMovers() given a mask with no OK-size blobs in it would change nothing.
+	return vehiclesGoingRight.empty() && vehiclesGoingLeft.empty() && !bailing;
+}
+
+
+int SpeedTracker::getSpeedAttempts(){
+	return speedAttempts;
+}
+
+
+vector<int> SpeedTracker::getSpeeds(direction dir){
+	if (dir == L2R) return L2RSpeeds;
+	return R2LSpeeds;
+}
+
+
+int SpeedTracker::getLastSpeed(direction dir){
+// Latest speed written to the stats file in that direction;  0 if none yet.
+	vector<int> &speeds = (dir == L2R) ? L2RSpeeds : R2LSpeeds;
+	return speeds.empty() ? 0 : speeds.back();
+}
+
+
+int SpeedTracker::getNumSpeeds(direction dir){
+	return int((dir == L2R) ? L2RSpeeds.size() : R2LSpeeds.size());
+}
+
+
+int SpeedTracker::getNumInTrack(direction dir){
+	return int((dir == L2R) ? vehiclesGoingRight.size() : vehiclesGoingLeft.size());
+}
+
+
+string vStateString(vehicleStatus inState){
+	// {entering, inMiddle, exiting, exited};
+	if (inState == entering) return "entering";
+	else if (inState == inMiddle) return "inMiddle";
+	else if (inState == exiting) return "exiting";
+	else return "exited";
+}
+
+
+string statusString(statusTypes inStatus){
+	// statusTypes {ImOK, deleteWithStats, lostTrack, negVelocity }
+	if (inStatus == ImOK) return "ImOK";
+	else if (inStatus == deleteWithStats) return "deleteWithStats";
+	else if (inStatus == lostTrack) return "lostTrack";
+	else return "negVelocity";
+
+}
+
+
+string overlapString(OverlapType inOverlap){
+	//	none, rearOnly, frontOnly, bothOverlap
+	if (inOverlap == none) return "none";
+	else if (inOverlap == rearOnly) return "rearOnly";
+	else if (inOverlap == frontOnly) return "frontOnly";
+	else return "bothOverlap";
+}
+
+
+
+Rect SpeedTracker::coalesce(Rect rectangles[], int numRects, int loX, int hiX, grabType how){
+	// For a specified region of interest, put a single rectangle around all of the external contours the contours funtion found.
+	Rect retRect;
+	int firstOK = -1;
+	for (int i = 0; i < numRects; i++){ // find first if any rectangle that is in spec'd bounds
+		if (rectangles[i].x <= hiX && (rectangles[i].x + rectangles[i].width) >= loX){ // Any overlap at all?
+			retRect = rectangles[i];
+			if (how == strict) {  // Keep it inside LoX...HiX
+				retRect.x = max(rectangles[i].x, loX);
+				retRect.width = min(rectangles[i].x + rectangles[i].width, (loX + hiX)) - retRect.x;
+			}
+			firstOK = i;
+			break;
+		}
+	}
+	if (firstOK == -1){
+		if(pleaseTrace) traceFile << "<" << frameNumber << "> Coalesce finds no acceptable objects between loX:  " << loX << " and  hiX:  " << hiX << endl;
+		return Rect{ -1, 0, 0, 0 };
+	}
+	for (int i = (firstOK + 1); i < numRects; i++){
+		if (rectangles[i].x <= hiX && (rectangles[i].x + rectangles[i].width) >= loX){    // overlap with requested bounded area
+			int leftMore = min(retRect.x, rectangles[i].x);
+			int rightMore = max(retRect.x + retRect.width, rectangles[i].x + rectangles[i].width);
+			if (how == strict) {  // Keep it inside LoX...HiX
+				leftMore = max(leftMore, loX);
+				rightMore = min(rightMore, (loX + hiX));
+			}
+			retRect.x = leftMore;
+			retRect.width = rightMore - retRect.x;
+
+			int topMore = min(retRect.y, rectangles[i].y);
+			int bottomMore = max(retRect.y + retRect.height, rectangles[i].y + rectangles[i].height);
+			retRect.y = topMore;
+			retRect.height = bottomMore - retRect.y;
+		}
+	}
+	if (pleaseTrace) traceFile << "<" << frameNumber << "> Coalesce finds object in [" << loX << ", " << hiX << "] --> Rect:   " << retRect.x << ", "
+		<< retRect.y << ", " << retRect.width << ",   " << retRect.height;// << endl;
+	return retRect;
+
+}
+
+bool SpeedTracker::meetsHLRCriterion(int inSpeed, int inArea){ // Does the vehicle speed meet criterion for HiLites reel?
+	return highLightsPlease 
+		&& (   ((inSpeed >= highLightsSpeedLower) && (inSpeed <= highLightsSpeedUpper))
+		||    /* ((inSpeed >= (highLightsSpeedLower - 8)) && */ (inArea >= g.largeVehicleArea) /*)*/);
+}
+
+Scalar SpeedTracker::speedColor(int estSpeed){
+// Green up to the speed limit, yellow over it, red at egregious speeds.
+	if (estSpeed <= speedLimit) return Scalar(CVGreen);
+	if (estSpeed < egregiousSpeedLowerBound) return Scalar(CVYellow);
+	return Scalar(CVRed);
+}
+
+
+void SpeedTracker::markVehicleBox(Annotations &marks, Rect rectangle, OverlapType Olap, int estSpeed, direction dir){
+// The green rectangle with the leading blue vertical line (hopefully on the front bumper) representng the *predicted* area occupied by
+// the vehicle, a side drawn red where it overlaps a vehicle going the other way, and the vehicle's speed once it is known.
+	int x = rectangle.x;
+	int y = rectangle.y;
+	int wd = rectangle.width;
+	int ht = rectangle.height;
+	int rearX = (dir == L2R) ? x : x + wd;
+	int frontX = (dir == L2R) ? x + wd : x;
+	marks.addLine(Point(x, y), Point(x + wd, y), Scalar(CVGreen));
+	marks.addLine(Point(x, y + ht), Point(x + wd, y + ht), Scalar(CVGreen));
+	if (Olap == rearOnly || Olap == bothOverlap)
+		marks.addLine(Point(rearX, y), Point(rearX, y + ht), Scalar(CVRed));
+	else
+		marks.addLine(Point(rearX, y), Point(rearX, y + ht), Scalar(CVGreen));
+	if (Olap == frontOnly || Olap == bothOverlap)
+		marks.addLine(Point(frontX, y), Point(frontX, y + ht), Scalar(CVRed));
+	else
+		marks.addLine(Point(frontX, y), Point(frontX, y + ht), Scalar(CVBlue));
+	if (estSpeed > 0)
+		marks.addText(intToString(estSpeed) + " MPH", Point((dir == L2R) ? g.pixelRight - 180 : g.pixelLeft, 30), speedColor(estSpeed));
+}
+
+
+void SpeedTracker::drawAnnotations(Mat &AnalysisFrame){
+// Rasterize the current pair's annotations onto its AnalysisFrame, when it is about to be shown.  Once only:  manageMovers() will have
+// drawn them already if the frame was kept for highlights.
+	if (annotationsDrawn || AnalysisFrame.empty()) return;
+	annotations.draw(AnalysisFrame);
+	annotationsDrawn = true;
+}
+
+
+void SpeedTracker::saveForHiLites(VehicleDynamics &vehicle, Mat &AnalysisFrame, HiLiteMark mark){
+// Save frame until it's known whether this vehicle will be added to highlights video.  Deferred highlights save just a mark for it.
+	if (vehicle.getTrackStartPixel() == 0){  // if vehicle hasnt passed start post yet, keep last frame in case about to cross into speed zone.
+		if (deferHiLites) vehicle.holdMark(mark);
+		else vehicle.holdFrame(AnalysisFrame);
+		hiLiteFrameSaved = !deferHiLites;
+		return;
+	}
+	if (vehicle.getNumberSavedFrames() == 0){ // First time to save a frame for hilites reel?  then start up saving frames to possibly copy to hilites file later on.
+		if (deferHiLites) vehicle.saveMark(vehicle.getHeldMark());
+		else vehicle.saveFrame(vehicle.getHeldFrame());
+	}
+	bool saving = (mark.estSpeed <= 0);  // Be saving frames past the start post.
+	if (!saving)  // estSpeed is > 0 meaning vehicle has passed end post.  No use saving frames if vehicle doesn't meet hilites Reel criterion
+		saving = meetsHLRCriterion(mark.estSpeed, vehicle.getArea(g)) && vehicle.getTrackEndFrame() == frameNumber;
+	if (!saving) return;
+	if (deferHiLites) vehicle.saveMark(mark);
+	else vehicle.saveFrame(AnalysisFrame);
+	hiLiteFrameSaved = !deferHiLites;
+}
+
+
+void SpeedTracker::displayAnalysisGoingRight(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed){
+// Display the predicted area occupied by the vehicle, and its velocity after it has has passed its second white post delineating the end
+// of the L2R speed measuring zone.  Also, save frame until it's known whether this vehicle will be added to highlights video.
+	markVehicleBox(annotations, rectangle, Olap, estSpeed, L2R);
+	if (highLightsPlease) saveForHiLites(vehiclesGoingRight[index], AnalysisFrame, HiLiteMark{ frameNumber + 1, rectangle, Olap, estSpeed });  // AnalysisFrame is the pair's newer frame
+	if (pleaseTrace) traceFile << "<" << frameNumber << "> DisplayGoingRight... Rect:  " << rectangle.x << ", " << rectangle.y << ", " << rectangle.width << ",  " << rectangle.height
+		<<endl << endl;
+}
+
+
+void SpeedTracker::displayAnalysisGoingLeft(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed){
+// Display the predicted area occupied by the vehicle, and its velocity after it has has passed its second white post, delineating the end
+// of the R2L speed measuring zone.  Also, save frame until it's known whether this vehicle will be added to highlights video.
+	markVehicleBox(annotations, rectangle, Olap, estSpeed, R2L);
+	if (highLightsPlease) saveForHiLites(vehiclesGoingLeft[index], AnalysisFrame, HiLiteMark{ frameNumber + 1, rectangle, Olap, estSpeed });
+	if (pleaseTrace) traceFile << "<" << frameNumber << "> DisplayGoingLeft... Rect:  " << rectangle.x << ", " << rectangle.y << ", " << rectangle.width << ",  " << rectangle.height
+		<< endl << endl;
+}
+
+
+void SpeedTracker::writeHiLiteClip(vector<Mat> &clipFrames, direction dir, int estSpeed, int area, int trackStartFrame){
+// A vehicle's clip in the highlights file:  its first frame held under an arrow at the start post, its frames through the speed zone
+// under an arrow in the middle, its last frame held under an arrow at the end post and its speed, then the partition frame.
+	if (clipFrames.empty()) return;
+	Rect box = hiLiteBox();
+	int speedleft = box.x + g.speedLineLeft; // Left boundary may have moved right for ROI boundary.
+	int speedRight = box.x + g.speedLineRight;
+	int midPoint = (speedleft + speedRight) / 2;
+	int arrowY = box.y - g.arrowRise;
+	Point arrows[3][2];  // From, to:  at the start post, mid zone, and end post
+	if (dir == L2R){
+		arrows[0][0] = Point(speedleft + 10, arrowY);	arrows[0][1] = Point(speedleft + 60, arrowY);
+		arrows[1][0] = Point(midPoint - 25, arrowY);	arrows[1][1] = Point(midPoint + 25, arrowY);
+		arrows[2][0] = Point(speedRight - 60, arrowY);	arrows[2][1] = Point(speedRight - 10, arrowY);
+	}
+	else{
+		arrows[0][0] = Point(speedRight - 10, arrowY);	arrows[0][1] = Point(speedRight - 60, arrowY);
+		arrows[1][0] = Point(midPoint + 25, arrowY);	arrows[1][1] = Point(midPoint - 25, arrowY);
+		arrows[2][0] = Point(speedleft + 60, arrowY);	arrows[2][1] = Point(speedleft + 10, arrowY);
+	}
+	Scalar arrowColor = (dir == L2R) ? Scalar(CVPurple) : Scalar(CVOrange);
+	Point speedAt = (dir == L2R) ? Point(speedRight - 125, box.y - 55) : Point(speedleft, box.y - 55);
+	int last = int(clipFrames.size()) - 1;
+	int firstHiLiteFrame = hiLiteFramesWritten;
+	Mat &zero = startHiLiteClip();  // Only the analysis box changes from frame to frame.
+	arrowedLine(zero, arrows[0][0], arrows[0][1], arrowColor, 5);
+	for (int i = 0; i < 5; i++){
+		clipFrames[0].copyTo(zero(box));
+		writeHiLite(zero);
+		if (!headless) waitKey(10);
+	}
+	arrowedLine(zero, arrows[0][0], arrows[0][1], Scalar(CVBlack), 5);
+	arrowedLine(zero, arrows[1][0], arrows[1][1], arrowColor, 5);
+	for (int i = 0; i <= last; i++){
+		clipFrames[i].copyTo(zero(box));
+		if (i == last){
+			arrowedLine(zero, arrows[1][0], arrows[1][1], Scalar(CVBlack), 5);
+			arrowedLine(zero, arrows[2][0], arrows[2][1], arrowColor, 5);
+			putText(zero, intToString(estSpeed) + " MPH", speedAt, 2, 1, speedColor(estSpeed), 2);
+		}
+		writeHiLite(zero);
+		if (!headless) waitKey(10);
+	}
+	for (int i = 0; i < 5; i++){
+		clipFrames[last].copyTo(zero(box));
+		writeHiLite(zero);
+		if (!headless) waitKey(10);
+	}
+	writeHiLite(hiLitePartition); //  write a partition between vehicles for HiLites processor to detect.
+	addHiLiteClip(firstHiLiteFrame, (dir == L2R) ? g.L2RDirection : g.R2LDirection, estSpeed, area, trackStartFrame);
+}
+
+
+void SpeedTracker::writeHiLiteClip(VehicleDynamics &vehicle, direction dir, int estSpeed){
+// A qualifying vehicle's clip, from the frames saved as it was tracked, or, when highlights are deferred, listed for VideoSpeedTracker -hilites.
+	if (!deferHiLites){
+		writeHiLiteClip(vehicle.getSavedFrames(), dir, estSpeed, vehicle.getArea(g), vehicle.getTrackStartFrame());
+		return;
+	}
+	DeferredClip clip;
+	clip.sourceFile = fileName;
+	clip.dir = dir;
+	clip.speed = estSpeed;
+	clip.area = vehicle.getArea(g);
+	clip.trackStartFrame = vehicle.getTrackStartFrame();
+	clip.stampFrame = frameNumber;  // frame1, as the stamp would have been copied from
+	clip.marks = vehicle.getSavedMarks();
+	deferredHiLites.add(clip);
+}
+
+
+bool SpeedTracker::writeDeferredClip(const DeferredClip &clip, VideoFile &source){
+// Read the frames a deferred clip's marks name from its input file, configured for, redraw the vehicle on them, and write the clip.
+	int m = 0;
+	while (m < clip.marks.size() && clip.marks[m].frame < 0) m++;  // Unset marks name no frame;  don't seek back to the start for them.
+	if (m == clip.marks.size()) return false;
+	int lastFrame = max(clip.marks.back().frame, clip.stampFrame);
+	if (!source.seek(min(clip.marks[m].frame, clip.stampFrame))) return false;  // Via the keyframe index, when the file has one.
+	vector<Mat> clipFrames;
+	Mat frame;
+	Annotations marks;
+	while (source.getPosition() <= lastFrame){
+		int frameNum = source.getPosition();
+		if (!source.read(frame)) return false;
+		if (frameNum == clip.stampFrame) frame1 = frame.clone();
+		for (; m < clip.marks.size() && clip.marks[m].frame == frameNum; m++){  // The held frame may be marked twice.
+			clipFrames.push_back(atProcessingScale(frame(inputBox), AnalysisBox.size()).clone());
+			marks.clear();
+			markVehicleBox(marks, clip.marks[m].box, clip.marks[m].olap, clip.marks[m].estSpeed, clip.dir);
+			marks.draw(clipFrames.back());
+		}
+	}
+	if (m < clip.marks.size()) return false;
+	writeHiLiteClip(clipFrames, clip.dir, clip.speed, clip.area, clip.trackStartFrame);
+	return true;
+}
+
+
+void SpeedTracker::logL2Rstats(bool isOK, int index){
+// Final entries for L2R vehicle just completing speed analysis are placed in trace file and in stats files.  Video output to highlights
+//	file for qualifying vehicles is performed.
+	int frames = max(vehiclesGoingRight[index].getTrackEndFrame() - vehiclesGoingRight[index].getTrackStartFrame(), 1);
+	int estSpeed = vehiclesGoingRight[index].getFinalSpeed();
+	if (vehiclesGoingRight[index].getTrackStartPixel() != 0) speedAttempts++;
+	if (pleaseTrace) traceFile << "<" << frameNumber << ">   Entry frame: " << vehiclesGoingRight[index].getTrackStartFrame()
+		<< "   Exit frame : " << vehiclesGoingRight[index].getTrackEndFrame()
+		<< "   # frames: " << (vehiclesGoingRight[index].getTrackEndFrame() - vehiclesGoingRight[index].getTrackStartFrame())
+		<< endl
+		<< "         Entry pixel: " << vehiclesGoingRight[index].getTrackStartPixel()
+		<< "   Exit pixel: " << vehiclesGoingRight[index].getTrackEndPixel()
+		<< "   # Pixels: " << vehiclesGoingRight[index].getTrackEndPixel() - vehiclesGoingRight[index].getTrackStartPixel()
+		<< "             Est speed: " << estSpeed
+		<< endl << "> > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > >"
+		<< endl << endl << endl;
+	if ((estSpeed >= 18.0) && isOK){
+		statsFile << fileDate << ", " << fileTime << ", "
+			<< frameNumber << ", " << g.L2RDirection << ", " << vehiclesGoingRight[index].getTrackStartFrame() << ", "
+			<< vehiclesGoingRight[index].getTrackEndFrame() << ", "
+			<< frames << ", "
+			<< vehiclesGoingRight[index].getTrackStartPixel() << ", "
+			<< vehiclesGoingRight[index].getTrackEndPixel() << ", "
+			<< vehiclesGoingRight[index].getTrackEndPixel() - vehiclesGoingRight[index].getTrackStartPixel() << ", "
+			<< vehiclesGoingRight[index].getArea(g) << ", , "
+			<< estSpeed;
+		if (estSpeed < 0 || estSpeed > crazySpeed) statsFile << ", *****";
+		statsFile << endl;
+		L2RSpeeds.push_back(estSpeed);
+		int second = secondOfDay(vehiclesGoingRight[index].getTrackStartFrame());
+		if (estSpeed >= 0 && estSpeed <= crazySpeed && second >= 0) summary.add(g.L2RDirection, second / 3600, estSpeed);  // No hour without a file time
+		if (meetsHLRCriterion(estSpeed, vehiclesGoingRight[index].getArea(g))) writeHiLiteClip(vehiclesGoingRight[index], L2R, estSpeed);
+	}
+}
+
+void SpeedTracker::logR2Lstats(bool isOK, int index){
+// Final entries for R2L vehicle just completing speed analysis are placed in trace file and in stats files.  Video output to highlights
+//	file for qualifying vehicles is performed.
+	int frames = max(vehiclesGoingLeft[index].getTrackEndFrame() - vehiclesGoingLeft[index].getTrackStartFrame(), 1);
+	int estSpeed = vehiclesGoingLeft[index].getFinalSpeed();
+	if (vehiclesGoingLeft[index].getTrackStartPixel() != 0) speedAttempts++;
+	if (pleaseTrace) traceFile
+		<< "<" << frameNumber << ">   Start frame: " << vehiclesGoingLeft[index].getTrackStartFrame()
+		<< "   End frame : " << vehiclesGoingLeft[index].getTrackEndFrame()
+		<< "   # frames: " << (vehiclesGoingLeft[index].getTrackEndFrame() - vehiclesGoingLeft[index].getTrackStartFrame())
+		<< endl
+		<< "          Start pixel: " << vehiclesGoingLeft[index].getTrackStartPixel()
+		<< "   End pixel: " << vehiclesGoingLeft[index].getTrackEndPixel()
+		<< "   # Pixels: " << vehiclesGoingLeft[index].getTrackStartPixel() - vehiclesGoingLeft[index].getTrackEndPixel()
+		<< "             Est speed: " << estSpeed
+		<< endl << "< < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < <"
+		<< endl << endl << endl;
+	if ((estSpeed >= 18.0) && isOK){
+		statsFile << fileDate << ", " << fileTime << ", "
+			<< frameNumber << ", " << g.R2LDirection << ", " << vehiclesGoingLeft[index].getTrackStartFrame() << ", "
+			<< vehiclesGoingLeft[index].getTrackEndFrame() << ", "
+			<< frames << ", "
+			<< vehiclesGoingLeft[index].getTrackStartPixel() << ", "
+			<< vehiclesGoingLeft[index].getTrackEndPixel() << ", "
+			<< vehiclesGoingLeft[index].getTrackStartPixel() - vehiclesGoingLeft[index].getTrackEndPixel() << ", "
+			<< vehiclesGoingLeft[index].getArea(g) << ", , "
+			<< estSpeed;
+		if (estSpeed < 0 || estSpeed > crazySpeed) statsFile << ", *****";
+		statsFile << endl;
+		R2LSpeeds.push_back(estSpeed);
+		int second = secondOfDay(vehiclesGoingLeft[index].getTrackStartFrame());
+		if (estSpeed >= 0 && estSpeed <= crazySpeed && second >= 0) summary.add(g.R2LDirection, second / 3600, estSpeed);  // No hour without a file time
+		if (meetsHLRCriterion(estSpeed, vehiclesGoingLeft[index].getArea(g))) writeHiLiteClip(vehiclesGoingLeft[index], R2L, estSpeed);
+	}
+}
+
+
+OverlapType SpeedTracker::doesL2ROverlapAnyR2L(int L2RIndex, vector<Projection> vehiclesL2R, vector<Projection> vehiclesR2L, int projectedR2LSize){
+// Function name tells it all.  Does a selected L2R vehicle overlap any R2L vehicles?  Indicate which bumpers overlap.
+	bool frontOverlap = false;
+	bool rearOverlap = false;
+	int L2RRearBumper = max(vehiclesL2R[L2RIndex].getBox().x - (4 * g.SLOP), g.pixelLeft);
+	int L2RFrontBumper = min(L2RRearBumper + vehiclesL2R[L2RIndex].getBox().width + (5 * g.SLOP), g.pixelRight);  // 5x makes up for SLOP subtracted from rear bumper.
+	for (int R2LIndex = 0; R2LIndex < projectedR2LSize; R2LIndex++){
+		int R2LFrontBumper = vehiclesR2L[R2LIndex].getBox().x;
+		int R2LRearBumper = R2LFrontBumper + vehiclesR2L[R2LIndex].getBox().width;
+		if ((L2RFrontBumper >= R2LFrontBumper) && (L2RFrontBumper <= R2LRearBumper)) frontOverlap = true;
+		if ( ( (L2RRearBumper >= R2LFrontBumper) && (L2RRearBumper <= R2LRearBumper) )
+		/*	|| ((L2RRearBumper <= R2LFrontBumper) && (L2RFrontBumper >= R2LRearBumper)) */ ) rearOverlap = true;  // Handle full obstruction case
+	}
+	// none, rearOnly, frontOnly, bothOverlap
+	if (frontOverlap && rearOverlap) return bothOverlap;
+	if (frontOverlap) return frontOnly;
+	if (rearOverlap) return rearOnly;
+	return none;
+}
+
+
+OverlapType SpeedTracker::doesR2LOverlapAnyL2R(int R2LIndex, vector<Projection> vehiclesR2L, vector<Projection> vehiclesL2R, int projectedL2RSize){
+// Function name tells it all.  Does a selected R2L vehicle overlap any L2R vehicles?  Indicate which bumpers overlap.
+	bool frontOverlap = false;
+	bool rearOverlap = false;
+	int R2LFrontBumper = max(vehiclesR2L[R2LIndex].getBox().x - g.SLOP, g.pixelLeft);
+	int R2LRearBumper = min(R2LFrontBumper + vehiclesR2L[R2LIndex].getBox().width + (5 * g.SLOP), g.pixelRight);  // 4x makes up for SLOP subtracted from front bumper.
+	for (int L2RIndex = 0; L2RIndex < projectedL2RSize; L2RIndex++){
+		int L2RRearBumper = vehiclesL2R[L2RIndex].getBox().x;
+		int L2RFrontBumper = L2RRearBumper + vehiclesL2R[L2RIndex].getBox().width;
+		if ( (R2LFrontBumper <= L2RFrontBumper) && (R2LFrontBumper >= L2RRearBumper)) frontOverlap = true;
+		if ( ( (R2LRearBumper <= L2RFrontBumper) && (R2LRearBumper >= L2RRearBumper) ) 
+		/*	|| ((R2LRearBumper >= L2RFrontBumper) && (R2LFrontBumper <= L2RRearBumper)) */  ) rearOverlap = true;   // Handle full obstruction case
+	}
+	// none, rearOnly, frontOnly, bothOverlap
+	if (frontOverlap && rearOverlap) return bothOverlap;
+	if (frontOverlap) return frontOnly;
+	if (rearOverlap) return rearOnly;
+	return none;
+}
+
+
+int SpeedTracker::findBlobs(Mat wholeScenethreshImage, Rect region, Rect found[], bool rejectCrowds, direction dir){
+// Put bounding rectangles (relative to AnalysisBox) around the OK-size external contours found in a region of the threshold image.
+// If rejectCrowds, return -1 when too many contours are found for the noise filter to have done its job.  When detections are being
+// replayed the answer comes from the detection log instead of the image; when they're being recorded, every answer is logged.
+	if (replayDetections) return detectionLog->lookup(region, found, MAX_NUM_OBJECTS, minObjectArea);
+	if (region.width <= 0 || region.height <= 0) return 0;  // No band to search, e.g. a lane group with no lane in this direction.
+
+	// With several lanes going this way (lanes.cfg), a blob is this lane's only if its bottom edge falls in the rows the lane owns.
+	// So search down to the bottom of the analysis box, where every blob's real bottom edge shows, and clip the ones kept to the band.
+	// Only this lane's blobs count towards a crowd:  a busy neighbouring lane doesn't stop this one.
+	int ownedTop = (dir == L2R) ? g.L2ROwnedTop : g.R2LOwnedTop;
+	int ownedBottom = (dir == L2R) ? g.L2ROwnedBottom : g.R2LOwnedBottom;  // 0:  every blob in the band is this lane's
+	int bandBottom = region.y + region.height;
+	Rect searched = region;
+	if (ownedBottom > 0) searched.height = wholeScenethreshImage.rows - searched.y;
+
+	vector< vector<Point> > contours; // for findContours output
+	vector<Vec4i> hierarchy;  // for findContours output
+	int numOKSizeObjects = 0;
+	int numOwned = 0;
+	Mat ROI = wholeScenethreshImage(searched);
+	findContours(ROI, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);// retrieves external contours
+	// found some objects?
+	if (contours.size() > 0){   // Are both of
+		if (hierarchy.size() > 0) {  // these necessary?
+			for (int index = 0; index >= 0; index = hierarchy[index][0]) {
+				Rect blob = boundingRect(contours.at(index)); 		//make bounding rectangle 
+				blob.x += searched.x;
+				blob.y += searched.y;
+				if (ownedBottom > 0){
+					int blobBottom = blob.y + blob.height;
+					if (blobBottom <= ownedTop || blobBottom > ownedBottom) continue;  // Another lane's vehicle
+					blob.height = min(blobBottom, bandBottom) - blob.y;
+					if (blob.height <= 0) continue;  // Wholly below the band
+				}
+				numOwned++;
+				if (numOKSizeObjects < MAX_NUM_OBJECTS && (blob.width * blob.height) >= minObjectArea) found[numOKSizeObjects++] = blob;
+			} // for
+			//if number of objects greater than MAX_NUM_OBJECTS may need to adjust noise filter
+			if (rejectCrowds && numOwned >= MAX_NUM_OBJECTS) numOKSizeObjects = -1;
+		} // if
+	} // if
+	if (recordDetections) detectionLog->record(region, found, numOKSizeObjects);
+	return numOKSizeObjects;
+}
+
+
+//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  * 
+// Given next differential image, use projections of all known in-track vehicles, as well as information about newly entering vehicles, to identify and process
+// all that are 1) exiting, deleted, entering, overtaking, occluding, occluded, or simply moving forward.  If objects are detected in the region of interest, they
+// are bracketed and associated with entering or already known vehicles, and this new information is preserved for each vehicle in a call to addSnap(), one call for
+// each vehicle maintained in a direction sensitive vector of known to be in track vehicles.  The preservation of observed information enables predictive filter
+// based tracking, done elsewhere.
+//
+//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  * 
+
+bool SpeedTracker::manageMovers(Mat wholeScenethreshImage, Mat &AnalysisFrame, int inFrameNumber, double inFrameMsec){
+
+	frameNumber = inFrameNumber;
+	frameMsec = inFrameMsec;
+	annotations.clear();  // Listed, not drawn;  see drawAnnotations().
+	annotationsDrawn = false;
+	hiLiteFrameSaved = false;
+
+/// < < < < < < < < < < < < < < < < < < < < < < < < < < G e t   P r o j e c t i o n s   f o r   v e h s   a l r e a d y   i n   t r a c k  > > > > > > > > > > > > > > > > 
+// Get all L2R vehicle projections
+	vector<Projection> projectedL2R;  // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+	for (int index = 0; index < vehiclesGoingRight.size(); index++){
+		projectedL2R.push_back(vehiclesGoingRight[index].getBestProjection(g, frameNumber, frameMsec));
+		if (pleaseTrace) traceFile << endl << "<" << frameNumber << "> Project >>L2R>> vehicle[" << index << "]  Rect xywh: [" << projectedL2R[index].getBox().x << ", "
+			<< projectedL2R[index].getBox().y << ", " << projectedL2R[index].getBox().width << ",  " << projectedL2R[index].getBox().height
+			<< "]   vState: " << vStateString(projectedL2R[index].getVState())
+			<< "  Overlap: " << overlapString(vehiclesGoingRight[index].getOverlapStatus())
+			<< ",   pixDelta: " << projectedL2R[index].getVelocity() << endl
+			<< "     FBSlope (+): " << vehiclesGoingRight[index].getFBSlope() << "   FBIntcpt:  " << vehiclesGoingRight[index].getFBIntercept()
+			<< "  RBSlope: " << vehiclesGoingRight[index].getRBSlope() << "  RBIntcpt: " << vehiclesGoingRight[index].getRBIntercept()
+			<< "      projected FB: " << int(vehiclesGoingRight[index].getNextFrontBumper())
+			<< "  projected width: " << projectedL2R[index].getBox().width 
+			<< "  projected RB: " << int(vehiclesGoingRight[index].getNextRearBumper())
+			<< endl;
+	}
+
+// Get all R2L vehicle projections
+	vector<Projection> projectedR2L;  // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	for (int index = 0; index < vehiclesGoingLeft.size(); index++){
+		projectedR2L.push_back(vehiclesGoingLeft[index].getBestProjection(g, frameNumber, frameMsec));
+		if (pleaseTrace) traceFile << endl << "<" << frameNumber << "> Project <<R2L<< vehicle[" << index << "]  Rect xywh: [" << projectedR2L[index].getBox().x << ", "
+			<< projectedR2L[index].getBox().y << ", " << projectedR2L[index].getBox().width << ",  " << projectedR2L[index].getBox().height
+			<< "]   vState: " << vStateString(projectedR2L[index].getVState())
+			<< "  Overlap: " << overlapString(vehiclesGoingLeft[index].getOverlapStatus())
+			<< ",   pixDelta: " << projectedR2L[index].getVelocity() << endl
+			<< "     FBSlope (-): " << vehiclesGoingLeft[index].getFBSlope() << "   FBIntcpt:  " << vehiclesGoingLeft[index].getFBIntercept()
+			<< "  RBSlope: " << vehiclesGoingLeft[index].getRBSlope() << "  RBIntcpt: " << vehiclesGoingLeft[index].getRBIntercept()
+			<< "      projected FB: " << int(vehiclesGoingLeft[index].getNextFrontBumper())
+			<< "  projected width: " << projectedR2L[index].getBox().width 
+			<< "      projected RB: " << int(vehiclesGoingLeft[index].getNextRearBumper())
+			<< endl;
+	}
+
+
+//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Get rid of all exited and deleted vehicles *  *  *  *  *  *  *  *  *  * 
+
+// If front L2R vehicle is exited, remove it from consideration
+	if ((vehiclesGoingRight.size() > 0) && (projectedL2R.front().getVState() == exited)){
+		if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle just exited." << endl;
+//		cout << "<" << frameNumber << ">   # # # # # # # L2R vehicle just exited." << endl;
+		logL2Rstats(true, 0); //
+		vehiclesGoingRight.erase(vehiclesGoingRight.begin());
+		projectedL2R.erase(projectedL2R.begin());
+	}
+
+// If front R2L vehicle is exited, remove it from consideration
+	if ((vehiclesGoingLeft.size() > 0) && (projectedR2L.front().getVState() == exited)){
+		if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle just exited." << endl;
+//		cout << "<" << frameNumber << ">   # # # # # # # R2L vehicle just exited." << endl;
+		logR2Lstats(true, 0);
+		vehiclesGoingLeft.erase(vehiclesGoingLeft.begin());
+		projectedR2L.erase(projectedR2L.begin());
+	}
+
+
+// Check for deleted L2R vehicles
+
+	for (int index = vehiclesGoingRight.size() - 1; index > -1; index--){
+		if (vehiclesGoingRight[index].getAmIOK() != ImOK) {
+			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingRight[index].getAmIOK()) << endl;
+//			cout << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingRight[index].getAmIOK()) << endl;
+			if (vehiclesGoingRight[index].getTrackEndPixel() > 0) logL2Rstats(true, index);
+			else logL2Rstats(false, /*vehiclesGoingRight[index].getAmIOK() == deleteWithStats*/ index);
+			vehiclesGoingRight.erase(vehiclesGoingRight.begin() + index);
+			projectedL2R.erase(projectedL2R.begin() + index);
+		}
+	}
+
+// Check for deleted R2L vehicles
+
+	for (int index = vehiclesGoingLeft.size() - 1; index > -1; index--){
+		if (vehiclesGoingLeft[index].getAmIOK() != ImOK) {
+			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingLeft[index].getAmIOK()) << endl;
+//			cout << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingLeft[index].getAmIOK()) << endl;
+			if (vehiclesGoingLeft[index].getTrackEndPixel() > 0) logR2Lstats(true, index);
+			else logR2Lstats(false, /*vehiclesGoingLeft[index].getAmIOK() == deleteWithStats,*/ index);
+			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin() + index);
+			projectedR2L.erase(projectedR2L.begin() + index);
+		}
+	}
+
+// Check for L2R overrunning, as in a vehicle starting to pass a bicyclist; bail if overrunning detected.
+// This could be modified to delete the overrun vehicle instead, but leapfrogging would have to be dealt with.
+
+	for (int index = vehiclesGoingRight.size() - 1; index > 0; index--){
+		if (index > 0 && (projectedL2R[index].getBox().x + projectedL2R[index].getBox().width) > (projectedL2R[index - 1].getBox().x - g.overrunGap) ) {
+			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted for overrunning: " << endl;
+			console() << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is overrunning: "  << endl;
+			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
+			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
+			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
+			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
+			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
+			bailing = true;
+			annotations.addLine(Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed));
+			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because of overrunning.   All current vehicles being dropped." << endl;
+		}
+	}
+
+// Check for R2L overrunning, as in a vehicle starting to pass a bicyclist; bail if overrunning detected.
+// This could be modified to delete the overrun vehicle instead, but leapfrogging would have to be dealt with.
+
+	for (int index = vehiclesGoingLeft.size() - 1; index > 0; index--){
+		if (index > 0 && ((projectedR2L[index - 1].getBox().x + projectedR2L[index - 1].getBox().width) > (projectedR2L[index].getBox().x - g.overrunGap))) {
+			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted for overrunning: " << endl;
+			console() << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is overrunning: " << endl;
+			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
+			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
+			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
+			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
+			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
+			bailing = true;
+			annotations.addLine(Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed));
+			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because of overrunning.   All current vehicles being dropped." << endl;
+		}
+	}
+	
+
+
+//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Detect places of motion  *  *  *  *  *  *  *  *  *  * 
+	Rect objectBoundingRectangleL2R[MAX_NUM_OBJECTS]; // bounding rectangles, from top of ROI to L2R lane, captured in a given frame
+	Rect objectBoundingRectangleR2L[MAX_NUM_OBJECTS]; // bounding rectangles captured in a given frame
+
+	int numOKSizeObjectsL2R = findBlobs(wholeScenethreshImage, Rect(g.pixelLeft, g.L2RBandTop, g.pixelRight, g.L2RStreetY - g.L2RBandTop), objectBoundingRectangleL2R, true, L2R);  // L2RStreetY is the lowest needed to go to see a rightbound vehicle
+	if (numOKSizeObjectsL2R < 0){
+		console() << "Too many L2R objects!" << endl;
+		numOKSizeObjectsL2R = 0;
+	}
+
+	int numOKSizeObjectsR2L = findBlobs(wholeScenethreshImage, Rect(g.pixelLeft, g.R2LBandTop, g.pixelRight, g.R2LStreetY - g.R2LBandTop), objectBoundingRectangleR2L, true, R2L);  // R2LStreetY is the lowest needed to go for leftbound vehicle
+	if (numOKSizeObjectsR2L < 0){
+		console() << "Too many R2L objects!" << endl;
+		numOKSizeObjectsR2L = 0;
+	}
+
+
+// At this point objectBoundingRectanglexxx[] has numOKSizeObjectsxxx acceptable rectangles in it, possibly zero.  The rectangles are independent, non-overlapping.
+
+
+// This bailing code is used in circumstances where the scene is overwhelming.
+
+	if (((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0) && bailing){
+		annotations.addLine(Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed));
+		if (pleaseTrace) traceFile << "<" << frameNumber << "> Still bailing." << endl;
+		return true;
+	}
+	else if(bailing){ // bailing with no objects detected.
+		bailing = false;
+		if (pleaseTrace) traceFile << "<" << frameNumber << "> Returning to analyzing traffic." << endl;
+	}
+
+
+
+//  Visual bracketing of the left/right ends of the range where speed measuring takes place.
+
+	annotations.addLine(Point(g.speedLineLeft, 180), Point(g.speedLineLeft, 25), Scalar(CVWhite));
+	annotations.addLine(Point(g.speedLineRight, 180), Point(g.speedLineRight, 25), Scalar(CVWhite));
+
+
+	if ((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0) { // rectangles found in areas checked, i.e. motion detected;  See what's up...
+
+//		cout << "<" << frameNumber << "> Num OK objects: " << numOKSizeObjects << "  L2R vehicles: " << vehiclesGoingRight.size() << "  R2L vehicles: " << vehiclesGoingLeft.size() << endl;
+		if (pleaseTrace) traceFile << "<" << frameNumber << "> Num OK L2R objects: " << numOKSizeObjectsL2R
+			<< " Num OK R2L objects: " << numOKSizeObjectsR2L << "  L2R vehicles: " << vehiclesGoingRight.size() << "  R2L vehicles: " << vehiclesGoingLeft.size() << endl;
+
+
+//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Safe to look for newly entering vehicles at the left and right ends of the analysis box? *  *  *  *  *  *  *  *
+//                                                       =========================================================================================
+
+// Left end is safe to check if there are no entering L2R vehicles and no R2L vehicles w/in a couple of frames of exiting left.
+//  > > > > > > > > > > > > > > > > > 
+		int safeL2RZone = g.pixelRight - g.pixelLeft;
+		int safeR2LZone = g.pixelRight - g.pixelLeft;
+		// "6" and "2" in following if statements can be tweaked.  I'm happy with their current values.
+		if (projectedR2L.size() > 0) safeR2LZone = max(projectedR2L.front().getBox().x - (2 * g.maxL2RDistOnEntry), 0);  // Identify safe range to front of oncoming car.
+		if (projectedL2R.size() > 0) safeL2RZone = max(projectedL2R.back().getBox().x - (6 * g.maxL2RDistOnEntry), 0);  // Identify safe range to rear of preceding car.
+
+		if (safeL2RZone > 0 && safeR2LZone > 0){
+			coalescedRectangle = coalesce(objectBoundingRectangleL2R, numOKSizeObjectsL2R,
+				g.pixelLeft, min(min(safeR2LZone, safeL2RZone), (g.pixelLeft + g.pixelRight) / 2), strict);  // Look for vehicle from left (-20 covers projection slop)
+			if (coalescedRectangle.x != -1){ // at least one object is present in coalesced rectangle(s)
+				vehiclesGoingRight.push_back(VehicleDynamics(L2R));
+				vehiclesGoingRight[vehiclesGoingRight.size() - 1].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
+				if (coalescedRectangle.x + coalescedRectangle.width >= g.speedLineLeft)
+					     vehiclesGoingRight[vehiclesGoingRight.size() - 1].markInvalidSpeed();
+				if (pleaseTrace) traceFile << endl << endl << "<" << frameNumber
+					<< ">    >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> Just added rightbound vehicle[" << vehiclesGoingRight.size() - 1 << "] >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>" << endl;
+				displayAnalysisGoingRight(frameNumber, vehiclesGoingRight.size() - 1, coalescedRectangle, none, AnalysisFrame, -1);
+			}
+		}
+
+// Right end is safe if there are no entering R2L vehicles and no L2R vehicles w/in a couple of frames of exiting left.
+// < < < < < < < < < < < < < < < < < < 
+		safeL2RZone = g.pixelRight - g.pixelLeft;
+		safeR2LZone = g.pixelRight - g.pixelLeft;
+		 // "6" and "2" in following if statements can be tweaked.  I'm happy with their current values.
+		if (projectedR2L.size() > 0)  safeR2LZone = max(g.pixelRight - (projectedR2L.back().getBox().x + projectedR2L.back().getBox().width + (6 * g.maxR2LDistOnEntry)), 0);   // Identify safe range to rear of preceding car.
+		if (projectedL2R.size() > 0) safeL2RZone = max(g.pixelRight - (projectedL2R.front().getBox().x + projectedL2R.front().getBox().width + (2 * g.maxR2LDistOnEntry)), 0);  // Identify safe range to front of oncoming car.
+
+		if (safeR2LZone > 0 && safeL2RZone > 0){
+			coalescedRectangle = coalesce(objectBoundingRectangleR2L, numOKSizeObjectsR2L,
+				     max(  max(g.pixelRight - safeL2RZone, g.pixelRight - safeR2LZone),
+				          (g.pixelLeft + g.pixelRight) / 2), g.pixelRight, strict);  // Look for vehicle from right
+			if (coalescedRectangle.x != -1){
+				vehiclesGoingLeft.push_back(VehicleDynamics(R2L));
+				vehiclesGoingLeft[vehiclesGoingLeft.size() - 1].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
+				if (coalescedRectangle.x <= g.speedLineRight)
+					     vehiclesGoingLeft[vehiclesGoingLeft.size() - 1].markInvalidSpeed();
+				if (pleaseTrace) traceFile << endl << endl << "<" << frameNumber
+					<< ">     <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< Just added leftbound vehicle[" << vehiclesGoingLeft.size() - 1 << "] <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl;
+				displayAnalysisGoingLeft(frameNumber, vehiclesGoingLeft.size() - 1, coalescedRectangle, none, AnalysisFrame, -1);
+			}
+		}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * *  P r o c e s s    a l l    p r o j e c t e d    v e h i c l e s * * * * * * * * * * * * * * * * * * * *
+//                                                 ================================================================
+
+// ---------------More than three in analysis zone with opposing traffic......
+		if ((vehiclesGoingRight.size() * vehiclesGoingLeft.size()) > 2){ // Bail on mixed direction, four or more vehicles total (includes just entered vehs)
+			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
+			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
+			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
+			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
+			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
+			bailing = true;
+			annotations.addLine(Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed));
+			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because  > 3 bi-directional traffic detected.  All current vehicles being dropped." << endl;
+		}
+
+
+		else {  // Ok, scene is one that can be handled. Clear past info about passing vehicles, and then check for passing vehicles now.
+			if(vehiclesGoingRight.size() > 0)
+				for (int i = 0; i < vehiclesGoingRight.size(); i++) 
+					vehiclesGoingRight[i].setOverlapStatus(none); // Reset any past L2R overlap determinations.
+			if (vehiclesGoingLeft.size() > 0)
+				for (int i = 0; i < vehiclesGoingLeft.size(); i++)
+					vehiclesGoingLeft[i].setOverlapStatus(none); // Reset any past R2L overlap determinations.
+// -------------- Two or three vehicles in analysis zone, a least one in each direction......
+			if ((projectedL2R.size() * projectedR2L.size()) >= 1) { // Two vehs currently in track (ignoring just entered vehicles now), one in each direction;
+				for (int i = 0; i < projectedL2R.size(); i++)
+					vehiclesGoingRight[i].setOverlapStatus(doesL2ROverlapAnyR2L(i, projectedL2R, projectedR2L, projectedR2L.size()));
+				for (int i = 0; i < projectedR2L.size(); i++)
+					vehiclesGoingLeft[i].setOverlapStatus(doesR2LOverlapAnyL2R(i, projectedR2L, projectedL2R, projectedL2R.size()));
+			}
+
+		}
+
+// > > > > > > > > > > > >  All *current* vehicles from left case (any newly added L2R vehicle not considered) > > > > > > > > > > > > > > > > > > > 
+//		                   ===================================================================================
+//  > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > >
+
+		Rect objectBoundingRectangle[MAX_NUM_OBJECTS]; // bounding rectangles, formed in a direction sensitive manner
+
+		if (projectedL2R.size() > 0){ // All bidirectional cases considered by the time control gets here.
+			for (int index = 0; index < projectedL2R.size(); index++){
+            // First, focus the search for detected blobs to the region the vehicle is projected to occupy
+				int tempX = max(projectedL2R[index].getBox().x - g.searchBehind, g.pixelLeft);  // look behind the predicted rear bumper
+				int tempWidth = min(projectedL2R[index].getBox().width + g.searchBeyond, g.pixelRight - tempX); // Look a little beyond the front bumper;
+				int numOKSizeL2RObjects = findBlobs(wholeScenethreshImage, Rect(tempX, g.L2RBandTop, tempWidth, g.L2RStreetY - g.L2RBandTop), objectBoundingRectangle, false, L2R);
+			if(pleaseTrace) traceFile << "    Number of L2R objects is: " << numOKSizeL2RObjects << "  inside rect[x,y,wid,ht] "
+				<< tempX << ", " << g.L2RBandTop << ", " << tempWidth << ", " << g.L2RStreetY - g.L2RBandTop << endl;
+
+			// Get the best bounding rectangle possible for the vehicle being considered; if no objects were found, skip to display of projected data
+				if (numOKSizeL2RObjects > 0){
+					int projFrontBumper = projectedL2R[index].getBox().x + projectedL2R[index].getBox().width;
+					int projRearBumper = projectedL2R[index].getBox().x;
+					grabType grabRestriction = greedy;
+					if (vehiclesGoingRight[index].getOverlapStatus() == rearOnly)
+						grabRestriction = strict;
+					if (projectedL2R[index].getVState() == entering)
+						// Look a few pixels beyond projections in each direction
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, max(g.pixelLeft, (projRearBumper - 10)), (projFrontBumper + 20), grabRestriction);
+					else if (projectedL2R[index].getVState() == exiting)  // Look a few pixels beyond projections in each direction
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, (projRearBumper - 10), min((projFrontBumper + 10), g.pixelRight), grabRestriction);
+					else  // somewhere in the middle
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, max((projRearBumper - 50),
+						g.pixelLeft), min((projFrontBumper + 10), g.pixelRight), grabRestriction);
+
+					// If no coalesced objects have been found, record no snapshot.
+					//                                        =======================
+					if (coalescedRectangle.x >= 0){    					// Coalesced objects found...
+						vehiclesGoingRight[index].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
+						// draw a purple rectangle around the area where objects related to the vehicle were found ("actual data")
+						annotations.addBox(coalescedRectangle, Scalar(CVPurple));
+						if (pleaseTrace) traceFile << "  Observed FB: " << coalescedRectangle.x + coalescedRectangle.width
+							<< "   Observed width: " << coalescedRectangle.width 
+							<< "  Observed RB: " << coalescedRectangle.x
+							<< endl;
+					}
+				}
+
+				displayAnalysisGoingRight(frameNumber, index, projectedL2R[index].getBox(), vehiclesGoingRight[index].getOverlapStatus(), AnalysisFrame, vehiclesGoingRight[index].getFinalSpeed());
+			}
+		}
+
+//  < < < < < < < < < < < < < < < <   All *current* vehicles from right case (any newly added R2L vehicle not considered) < < < < < < < < < < < < < < < < < < < < < <
+//		                              ===================================================================================
+//  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < < 
+
+
+		if (0 < projectedR2L.size()) { 
+			for (int index = 0; index < projectedR2L.size(); index++){
+				// First, focus the search for detected blobs to the region the vehicle is projectyed to occupy
+				int tempX = max(projectedR2L[index].getBox().x - g.searchAhead, g.pixelLeft);  // look a little ahead of the predicted front bumper
+				int tempWidth = min(projectedR2L[index].getBox().width + g.searchBeyond, g.pixelRight - tempX); // Look behind the rear bumper;
+				int numOKSizeR2LObjects = findBlobs(wholeScenethreshImage, Rect(tempX, g.R2LBandTop, tempWidth, g.R2LStreetY - g.R2LBandTop), objectBoundingRectangle, false, R2L);
+				if (pleaseTrace) traceFile << "    Number of R2L objects is: " << numOKSizeR2LObjects << "  inside rect[x,y,wid,ht] "
+					<< tempX << ", " << g.R2LBandTop << ", " << tempWidth << ", " << g.R2LStreetY - g.R2LBandTop << endl;
+
+
+
+				// Get the best bounding rectangle possible
+				if (numOKSizeR2LObjects > 0){ // Get the best bounding rectangle possible for the vehicle being considered; if no objects were found, skip to display of projected data
+					int projFrontBumper = projectedR2L[index].getBox().x;
+					int projRearBumper = projFrontBumper + projectedR2L[index].getBox().width;
+					grabType grabRestriction = greedy;
+					if (vehiclesGoingLeft[index].getOverlapStatus() == rearOnly)
+						grabRestriction = strict;
+					if (projectedR2L[index].getVState() == entering)
+						// Look a few pixels beyond projections in each direction
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, (projFrontBumper - 20), min((projRearBumper + 10), g.pixelRight), grabRestriction); // minus for R2L vehicle
+					else if (projectedR2L[index].getVState() == exiting)  // Look a few pixels beyond projections in each direction
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, max((projFrontBumper - 10), g.pixelLeft), (projRearBumper + 10), grabRestriction);
+					else  // somewhere in the middle
+						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, max((projFrontBumper - 20), g.pixelLeft),
+						min(projRearBumper + 50, g.pixelRight), grabRestriction);
+
+					// If no coalesced objects have been found, record no snapshot.
+					//                                        =======================
+					if (coalescedRectangle.x >= 0){  					// Coalesced objects found...
+						vehiclesGoingLeft[index].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
+						// draw an orange rectangle around the area where objects related to the vehicle were found ("actual data")
+						annotations.addBox(coalescedRectangle, Scalar(CVOrange));
+						if (pleaseTrace) traceFile << "  Observed FB: " << coalescedRectangle.x
+							<< "   Observed width: " << coalescedRectangle.width 
+							<< "   Observed RB: " << coalescedRectangle.x + coalescedRectangle.width
+							<< endl;
+					}
+				}
+				displayAnalysisGoingLeft(frameNumber, index, projectedR2L[index].getBox(), vehiclesGoingLeft[index].getOverlapStatus(), AnalysisFrame, vehiclesGoingLeft[index].getFinalSpeed());
+
+			}
+		}
+	}
+
+	else; // cout << "<" << frameNumber << ">  . . ." << endl; // This happens if numOKObjects == 0;
+
+	if (hiLiteFrameSaved) drawAnnotations(AnalysisFrame);  // Highlights frames share AnalysisFrame's pixels, so they get every annotation of the pair.
+	return ((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0);
+}
+
@@ -0,0 +1,154 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include "Globals.h"
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include <fstream>
+#include <vector>
+#include "VehicleDynamics.h"
+#include "Projection.h"
+#include "DetectionLog.h"
+#include "SpeedSummary.h"
+#include "HiLiteIndex.h"
+#include "DeferredHiLites.h"
+#include "Annotations.h"
+#include "VideoFile.h"
+
+using namespace std;
+using namespace cv;
+
+const int MAX_NUM_OBJECTS = 30; // Max number of objects allowed to be retunred by contours
+const int MIN_OBJECT_AREA = 30 * 35;  // Very sensitive to pedestrians, bicyclists and other small things.  In reference pixels.
+const int HILITE_CAPTION_HEIGHT = 80;  // Band above the analysis box in compact highlights, below the date/time stamp:  arrows and speed.
+
+string intToString(int number);
+string overlapString(OverlapType inOverlap);
+
+// A SpeedTracker holds everything needed to track the vehicles of one video stream: its configuration, the vehicles in track,
+// and the stats, trace and highlights outputs.  Several can run side by side, e.g. one per configuration in a parameter sweep.
+
+class SpeedTracker
+{
+public:
+	SpeedTracker();
+
+	~SpeedTracker();
+
+	void configure(const Globals& inG);
+	void startFile(string inFileName);
+	void finishFile();
+	bool openHiLites(string path, int fourcc, double fps, Size frameSize);
+	void closeHiLites();
+	Size hiLiteFrameSize();
+	bool writeDeferredClip(const DeferredClip &clip, VideoFile &source);
+	bool manageMovers(Mat wholeScenethreshImage, Mat &AnalysisFrame, int inFrameNumber, double inFrameMsec = -1.0);
+	void drawAnnotations(Mat &AnalysisFrame);
+	void differencePair(Mat &inFrame1, Mat &inFrame2, Mat &thresholdImage, Mat &AnalysisFrame);
+	void differenceLuma(const Mat &luma1, const Mat &luma2, Rect lumaBox, Mat &thresholdImage);
+
+	bool isIdle();
+	int getSpeedAttempts();
+	vector<int> getSpeeds(direction dir);
+	int getLastSpeed(direction dir);
+	int getNumSpeeds(direction dir);
+	int getNumInTrack(direction dir);
+
+	Globals g;
+	Rect AnalysisBox;  // the coordinates and extents of the region beng analyzed for vehicle motion.  Subregion of frames read in.
+	Rect inputBox;  // AnalysisBox in pixels of the frames read in, before any shrinking to processing scale.
+	string fileName;  // Name of avi file currently being processed.
+	string fileDate;  // yyyymmdd and hhmmss from a camera file's name (e.g. 0123456yyyymmddhhmmss.avi), as written to the stats file
+	string fileTime;
+	int fileStartSecond = -1;  // Time of day the file starts, in seconds;  -1 if its name doesn't carry one
+	Mat frame1;  // Latest full frame read; source of the date/time stamp copied into highlights.
+
+	bool pleaseTrace = false;  // If you want a trace file (lots of debug info)
+	bool highLightsPlease = false;
+	bool compactHiLites = false;  // Highlights frames are just the analysis box under a caption band, not the whole input frame.
+	bool headless = false;  // No windows to service, so no waitKey() pauses while writing highlights.
+	int speedLimit = 25;  // User supplied speed limit, used for color choice when posting speed
+	int egregiousSpeedLowerBound = 35;    // User supplied egregious speed lower bound, used for color choice when posting speed
+	int crazySpeed = 55;
+	int highLightsSpeedLower = 35; // Default lower threshold for including vehicles in the highlights file
+	int highLightsSpeedUpper = 100; // Default upper threshold for including vehicles in the highlights file
+	int minimumProfileArea = 100;  // Default lower bound on size of large vehicle to be added to highlights if speeding over speed limit.
+
+	ofstream traceFile;
+	ofstream statsFile;
+	VideoWriter hiLiteVideo; // For writing highlights...the Scofflaws
+	int hiLiteFramesWritten = 0;  // Frames in the highlights file so far
+	HiLiteIndex hiLiteIndex;  // Lists the clips in the highlights file
+	bool deferHiLites = false;  // List qualifying vehicles' clips in deferredHiLites, to be made later, instead of writing them.
+	DeferredHiLites deferredHiLites;
+
+	SpeedSummary summary;  // Speeds logged from the current input file, by direction and hour
+	string summaryPrefix;  // Each input file's summary goes to summaryPrefix + <file name>.vss when it is done;  empty for none.
+
+	bool recordDetections = false;  // Write every contour finder answer to detectionLog.
+	bool replayDetections = false;  // Take every contour finder answer from detectionLog.
+	DetectionLog* detectionLog = NULL;
+
+private:
+
+	Rect coalesce(Rect rectangles[], int numRects, int loX, int hiX, grabType how);
+	bool meetsHLRCriterion(int inSpeed, int inArea);
+	Scalar speedColor(int estSpeed);
+	void markVehicleBox(Annotations &marks, Rect rectangle, OverlapType Olap, int estSpeed, direction dir);
+	void saveForHiLites(VehicleDynamics &vehicle, Mat &AnalysisFrame, HiLiteMark mark);
+	void displayAnalysisGoingRight(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed);
+	void displayAnalysisGoingLeft(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed);
+	void logL2Rstats(bool isOK, int index);
+	void logR2Lstats(bool isOK, int index);
+	OverlapType doesL2ROverlapAnyR2L(int L2RIndex, vector<Projection> vehiclesL2R, vector<Projection> vehiclesR2L, int projectedR2LSize);
+	OverlapType doesR2LOverlapAnyL2R(int R2LIndex, vector<Projection> vehiclesR2L, vector<Projection> vehiclesL2R, int projectedL2RSize);
+	int findBlobs(Mat wholeScenethreshImage, Rect region, Rect found[], bool rejectCrowds, direction dir);
+	void stampDateTime(Mat &canvas);
+	Rect hiLiteBox();
+	Mat& startHiLiteClip();
+	void writeHiLite(const Mat &frame);
+	void writeHiLiteClip(vector<Mat> &clipFrames, direction dir, int estSpeed, int area, int trackStartFrame);
+	void writeHiLiteClip(VehicleDynamics &vehicle, direction dir, int estSpeed);
+	void addHiLiteClip(int firstFrame, string direction, int speed, int area, int trackStartFrame);
+	int secondOfDay(int inFrame);
+
+	vector<VehicleDynamics> vehiclesGoingRight;
+	vector<VehicleDynamics> vehiclesGoingLeft;
+	bool bailing = false;
+	int frameNumber = 0; // Current framenumber being processed, relative to beginning of file "fileName"
+	double frameMsec = -1.0;  // Presentation time of frameNumber, if known (live input), for timing speeds by the clock.
+	Rect coalescedRectangle;  //  The collection of blobs that represent a vehicles projected area.
+	Annotations annotations;  // What manageMovers() would draw on the current pair's AnalysisFrame
+	bool annotationsDrawn = false;  // annotations already rasterized onto AnalysisFrame
+	bool hiLiteFrameSaved = false;  // AnalysisFrame of the current pair held or saved for highlights, so it must be rasterized
+	int minObjectArea = MIN_OBJECT_AREA;  // MIN_OBJECT_AREA in processing pixels.
+	bool summaryPending = false;  // An input file has been started, and its summary not written yet.
+	Mat hiLiteCanvas;  // Highlights frame being composed;  reused from clip to clip.
+	Mat hiLitePartition;  // Black frame that ends every clip
+
+// for comparing runs
+	int speedAttempts = 0;  // Vehicles whose front bumper crossed the first speed line.
+	vector<int> L2RSpeeds;  // Speeds written to the stats file
+	vector<int> R2LSpeeds;
+};
@@ -0,0 +1,454 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "VideoFile.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+bool fileIdentity(string path, int64_t &size, int64_t &modified){
+	struct _stat64 info;
+	if (_stat64(path.c_str(), &info) != 0) return false;
+	size = info.st_size;
+	modified = info.st_mtime;
+	return true;
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * K e y f r a m e   I n d e x * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+const char keyframeIndexMagic[4] = { 'V', 'S', 'T', 'K' };
+const int32_t keyframeIndexVersion = 1;
+const uint32_t AVIIF_KEYFRAME = 0x10;			// idx1 flag: chunk is a keyframe
+const uint32_t AVI_DELTA_FRAME = 0x80000000;	// Standard index size bit: chunk is NOT a keyframe
+
+
+KeyframeIndex::KeyframeIndex()
+{
+}
+
+
+KeyframeIndex::~KeyframeIndex()
+{
+}
+
+
+bool KeyframeIndex::load(string videoPath){
+	keyframes.clear();
+	frameCount = 0;
+	int64_t size, modified;
+	if (!fileIdentity(videoPath, size, modified)) return false;
+	string cachePath = videoPath.substr(0, videoPath.find_last_of('.')) + ".vsk";
+	if (readCache(cachePath, size, modified)) return true;
+	if (!scanAvi(videoPath)){
+		keyframes.clear();
+		frameCount = 0;
+		return false;
+	}
+	writeCache(cachePath, size, modified);
+	return true;
+}
+
+
+bool KeyframeIndex::readCache(string cachePath, int64_t size, int64_t modified){
+	ifstream cacheIn(cachePath, ios::in | ios::binary);
+	if (!cacheIn.is_open()) return false;
+	char magic[4];
+	int32_t version, count, numKeyframes;
+	int64_t cachedSize, cachedModified;
+	cacheIn.read(magic, 4);
+	cacheIn.read((char *)&version, sizeof(version));
+	cacheIn.read((char *)&cachedSize, sizeof(cachedSize));
+	cacheIn.read((char *)&cachedModified, sizeof(cachedModified));
+	cacheIn.read((char *)&count, sizeof(count));
+	cacheIn.read((char *)&numKeyframes, sizeof(numKeyframes));
+	if (!cacheIn.good() || memcmp(magic, keyframeIndexMagic, 4) != 0 || version != keyframeIndexVersion
+		|| cachedSize != size || cachedModified != modified || numKeyframes <= 0)
+		return false;  // Not ours, or the avi has changed since: rescan it.
+	keyframes.resize(numKeyframes);
+	cacheIn.read((char *)&keyframes[0], numKeyframes * sizeof(int32_t));
+	if (!cacheIn.good()){
+		keyframes.clear();
+		return false;
+	}
+	frameCount = count;
+	return true;
+}
+
+
+void KeyframeIndex::writeCache(string cachePath, int64_t size, int64_t modified){
+	ofstream cacheOut(cachePath, ios::out | ios::binary | ios::trunc);
+	if (!cacheOut.is_open()) return;  // No cache this time; the index is still good for this run.
+	int32_t version = keyframeIndexVersion;
+	int32_t count = frameCount;
+	int32_t numKeyframes = keyframes.size();
+	cacheOut.write(keyframeIndexMagic, 4);
+	cacheOut.write((const char *)&version, sizeof(version));
+	cacheOut.write((const char *)&size, sizeof(size));
+	cacheOut.write((const char *)&modified, sizeof(modified));
+	cacheOut.write((const char *)&count, sizeof(count));
+	cacheOut.write((const char *)&numKeyframes, sizeof(numKeyframes));
+	cacheOut.write((const char *)&keyframes[0], numKeyframes * sizeof(int32_t));
+}
+
+
+bool KeyframeIndex::scanAvi(string videoPath){
+// Walk the top level chunks of the avi.  The header list says which stream is video, and where its OpenDML super index is, if any.
+	ifstream avi(videoPath, ios::in | ios::binary);
+	if (!avi.is_open()) return false;
+	avi.seekg(0, ios::end);
+	int64_t fileEnd = avi.tellg();
+
+	int64_t superIndexAt = -1, idx1At = -1;
+	uint32_t superIndexSize = 0, idx1Size = 0;
+	string videoChunkId;
+	int64_t at = 0;
+	while (at + 12 <= fileEnd){
+		char fourcc[4], type[4];
+		uint32_t chunkSize;
+		avi.seekg(at);
+		avi.read(fourcc, 4);
+		avi.read((char *)&chunkSize, 4);
+		if (!avi.good()) break;
+		if (memcmp(fourcc, "RIFF", 4) == 0){  // "AVI " or, past the first gigabyte, "AVIX":  step inside.
+			at += 12;
+			continue;
+		}
+		if (memcmp(fourcc, "LIST", 4) == 0){
+			avi.read(type, 4);
+			if (memcmp(type, "hdrl", 4) == 0 && !scanHeaderList(avi, at + 8 + chunkSize, superIndexAt, superIndexSize, videoChunkId)) return false;
+		}
+		else if (memcmp(fourcc, "idx1", 4) == 0){
+			idx1At = at + 8;
+			idx1Size = chunkSize;
+		}
+		at += 8 + chunkSize + (chunkSize & 1);  // Chunks are padded to even length.
+	}
+
+	if (superIndexAt >= 0 && scanSuperIndex(avi, superIndexAt, superIndexSize)) return !keyframes.empty();
+	if (idx1At >= 0 && !videoChunkId.empty() && scanIdx1(avi, idx1At, idx1Size, videoChunkId)) return !keyframes.empty();
+	return false;
+}
+
+
+bool KeyframeIndex::scanHeaderList(ifstream &avi, int64_t end, int64_t &superIndexAt, uint32_t &superIndexSize, string &videoChunkId){
+	int64_t at = avi.tellg();
+	int streamNumber = -1;
+	bool inVideoStream = false;
+	while (at + 8 <= end){
+		char fourcc[4], type[4];
+		uint32_t chunkSize;
+		avi.seekg(at);
+		avi.read(fourcc, 4);
+		avi.read((char *)&chunkSize, 4);
+		if (!avi.good()) return false;
+		if (memcmp(fourcc, "LIST", 4) == 0){
+			avi.read(type, 4);
+			if (memcmp(type, "strl", 4) == 0){  // One stream's headers:  step inside.
+				streamNumber++;
+				inVideoStream = false;
+				at += 12;
+				continue;
+			}
+		}
+		else if (memcmp(fourcc, "strh", 4) == 0){
+			avi.read(type, 4);  // fccType
+			if (memcmp(type, "vids", 4) == 0 && videoChunkId.empty()){
+				inVideoStream = true;
+				videoChunkId = string(1, char('0' + streamNumber / 10)) + char('0' + streamNumber % 10);
+			}
+		}
+		else if (memcmp(fourcc, "indx", 4) == 0 && inVideoStream){
+			superIndexAt = at + 8;
+			superIndexSize = chunkSize;
+		}
+		at += 8 + chunkSize + (chunkSize & 1);
+	}
+	return true;
+}
+
+
+bool KeyframeIndex::scanSuperIndex(ifstream &avi, int64_t at, uint32_t size){
+// AVISUPERINDEX: points at one AVISTDINDEX ("ix00") per RIFF segment, each listing the frames in that segment.
+	uint16_t longsPerEntry;
+	uint8_t subType, indexType;
+	uint32_t entriesInUse;
+	avi.clear();
+	avi.seekg(at);
+	avi.read((char *)&longsPerEntry, 2);
+	avi.read((char *)&subType, 1);
+	avi.read((char *)&indexType, 1);
+	avi.read((char *)&entriesInUse, 4);
+	if (!avi.good() || indexType != 0 || longsPerEntry != 4 || 24 + entriesInUse * 16 > size) return false;  // 0 == AVI_INDEX_OF_INDEXES
+
+	vector<int64_t> stdIndexOffsets(entriesInUse);
+	for (uint32_t e = 0; e < entriesInUse; e++){
+		uint32_t entrySizeAndDuration[2];
+		avi.seekg(at + 24 + e * 16);
+		avi.read((char *)&stdIndexOffsets[e], 8);
+		avi.read((char *)entrySizeAndDuration, 8);
+	}
+	if (!avi.good()) return false;
+
+	keyframes.clear();
+	frameCount = 0;
+	for (uint32_t e = 0; e < entriesInUse; e++){
+		uint32_t entries;
+		avi.seekg(stdIndexOffsets[e] + 8 + 4);  // Skip fourcc, size, wLongsPerEntry, bIndexSubType, bIndexType.
+		avi.read((char *)&entries, 4);
+		avi.seekg(stdIndexOffsets[e] + 8 + 24);  // Skip nEntriesInUse, dwChunkId, qwBaseOffset, dwReserved.
+		vector<uint32_t> offsetsAndSizes(2 * entries);
+		if (entries > 0) avi.read((char *)&offsetsAndSizes[0], 8 * entries);
+		if (!avi.good()) return false;
+		for (uint32_t i = 0; i < entries; i++){
+			if (!(offsetsAndSizes[2 * i + 1] & AVI_DELTA_FRAME)) keyframes.push_back(frameCount);
+			frameCount++;
+		}
+	}
+	return true;
+}
+
+
+bool KeyframeIndex::scanIdx1(ifstream &avi, int64_t at, uint32_t size, string videoChunkId){
+// idx1: ckid, flags, offset, size for every chunk in the movi list.  Video frames are "NNdc" (compressed) or "NNdb" (uncompressed).
+	vector<uint32_t> entries(size / 4);
+	avi.clear();
+	avi.seekg(at);
+	if (!entries.empty()) avi.read((char *)&entries[0], (size / 16) * 16);
+	if (!avi.good()) return false;
+
+	keyframes.clear();
+	frameCount = 0;
+	for (uint32_t e = 0; e + 4 <= entries.size(); e += 4){
+		const char* ckid = (const char *)&entries[e];
+		if (ckid[0] != videoChunkId[0] || ckid[1] != videoChunkId[1] || ckid[2] != 'd' || (ckid[3] != 'c' && ckid[3] != 'b')) continue;
+		if (entries[e + 1] & AVIIF_KEYFRAME) keyframes.push_back(frameCount);
+		frameCount++;
+	}
+	return true;
+}
+
+
+int KeyframeIndex::keyframeAtOrBefore(int frameNum){
+	vector<int>::iterator after = upper_bound(keyframes.begin(), keyframes.end(), frameNum);
+	if (after == keyframes.begin()) return 0;
+	return *(after - 1);
+}
+
+
+int KeyframeIndex::getFrameCount(){
+	return frameCount;
+}
+
+
+bool KeyframeIndex::isEmpty(){
+	return keyframes.empty();
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * V i d e o   F i l e * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+VideoFile::VideoFile()
+{
+}
+
+
+VideoFile::~VideoFile()
+{
+}
+
+
+bool VideoFile::open(string videoPath, int lumaTop, int lumaHeight){
+// lumaTop and lumaHeight are the rows readLuma() returns (normally the AnalysisBox rows);  lumaHeight of 0 means to the bottom.
+	lumaRowsTop = lumaTop;
+	lumaRowsHeight = lumaHeight;
+	usingMapping = MappedVideo::handles(videoPath);
+	if (usingMapping){  // Pre-decoded:  nothing to decode, and every frame is where the mapping says it is.
+		position = 0;
+		frameCount = 0;
+		if (!mappedVideo.open(videoPath, lumaTop, lumaHeight)) return false;
+		frameCount = mappedVideo.getFrameCount();
+		return true;
+	}
+	usingDecoder = decoder.open(videoPath, lumaTop, lumaHeight);
+	if (usingDecoder){
+		position = 0;
+		frameCount = decoder.getFrameCount();
+		return true;
+	}
+	capture.open(videoPath);
+	if (!capture.isOpened()) return false;
+	position = 0;
+	frameCount = int(capture.get(CV_CAP_PROP_FRAME_COUNT));  // Asked once per file.
+	if (keyframeIndex.load(videoPath)) frameCount = keyframeIndex.getFrameCount();
+	return true;
+}
+
+
+void VideoFile::release(){
+	if (usingDecoder) decoder.release();
+	if (usingMapping) mappedVideo.release();
+	usingDecoder = false;
+	usingMapping = false;
+	capture.release();
+}
+
+
+bool VideoFile::isOpened(){
+	return usingDecoder || (usingMapping && mappedVideo.isOpened()) || capture.isOpened();
+}
+
+
+bool VideoFile::seek(int frameNum){
+	if (frameNum == position) return true;
+	if (usingMapping){
+		position = frameNum;
+		return frameNum <= frameCount;
+	}
+	if (usingDecoder){  // The decoder seeks by timestamp, to the exact frame.
+		if (!decoder.seek(frameNum)) return false;
+		position = frameNum;
+		return true;
+	}
+	if (keyframeIndex.isEmpty()){  // Not an indexed avi: leave it to the backend, as VST always has.
+		capture.set(CV_CAP_PROP_POS_FRAMES, frameNum);
+		position = frameNum;
+		return true;
+	}
+	int keyframe = keyframeIndex.keyframeAtOrBefore(frameNum);
+	if (position > frameNum || position < keyframe){  // Can't get there by decoding forward from here without passing a keyframe.
+		capture.set(CV_CAP_PROP_POS_FRAMES, keyframe);
+		position = keyframe;
+	}
+	while (position < frameNum){
+		if (!grab()) return false;
+	}
+	return true;
+}
+
+
+bool VideoFile::read(Mat &frame){
+	if (usingMapping){
+		if (!mappedVideo.toBGR(position, frame)) return false;
+		position++;
+		return true;
+	}
+	if (usingDecoder){
+		if (!decoder.readBGR(frame)) return false;
+		position = decoder.getFrameIndex() + 1;
+		return true;
+	}
+	if (!capture.read(frame)) return false;
+	position++;
+	return true;
+}
+
+
+bool VideoFile::readLuma(Mat &luma){
+// Gray scale rows chosen at open(), full width.  From the decoder, they are its own buffer:  good until the read after next.
+// From a mapped file they are the file itself:  good until release(), and read only.
+	if (usingMapping){
+		if (!mappedVideo.luma(position, luma)) return false;
+		position++;
+		return true;
+	}
+	if (usingDecoder){
+		if (!decoder.readLuma(luma)) return false;
+		position = decoder.getFrameIndex() + 1;
+		return true;
+	}
+	if (!capture.read(decodedFrame)) return false;
+	position++;
+	int rows = (lumaRowsHeight > 0) ? lumaRowsHeight : decodedFrame.rows - lumaRowsTop;
+	cv::cvtColor(decodedFrame.rowRange(lumaRowsTop, lumaRowsTop + rows), luma, COLOR_BGR2GRAY);  // Only the rows wanted.
+	return true;
+}
+
+
+bool VideoFile::grab(){
+	if (usingMapping){
+		if (position >= frameCount) return false;
+		position++;
+		return true;
+	}
+	if (usingDecoder){
+		Mat skipped;
+		if (!decoder.readLuma(skipped)) return false;  // Decoded, not converted.
+		position = decoder.getFrameIndex() + 1;
+		return true;
+	}
+	if (!capture.grab()) return false;
+	position++;
+	return true;
+}
+
+
+int VideoFile::getPosition(){
+	return position;
+}
+
+
+bool VideoFile::seekIsExact(){
+	return usingMapping || usingDecoder || !keyframeIndex.isEmpty();
+}
+
+
+int VideoFile::getFrameCount(){
+	return frameCount;
+}
+
+
+double VideoFile::getMsec(){
+	if (usingMapping) return (position - 1) * 1000.0 / mappedVideo.getFPS();
+	return usingDecoder ? decoder.getMsec() : capture.get(CV_CAP_PROP_POS_MSEC);
+}
+
+
+double VideoFile::getFPS(){
+	if (usingMapping) return mappedVideo.getFPS();
+	return usingDecoder ? decoder.getFPS() : capture.get(CV_CAP_PROP_FPS);
+}
+
+
+double VideoFile::getFrameWidth(){
+	if (usingMapping) return double(mappedVideo.getFrameWidth());
+	return usingDecoder ? double(decoder.getFrameWidth()) : capture.get(CV_CAP_PROP_FRAME_WIDTH);
+}
+
+
+double VideoFile::getFrameHeight(){
+	if (usingMapping) return double(mappedVideo.getFrameHeight());
+	return usingDecoder ? double(decoder.getFrameHeight()) : capture.get(CV_CAP_PROP_FRAME_HEIGHT);
+}
+
+
+void VideoFile::setLumaRows(int lumaTop, int lumaHeight){
+// Change the rows readLuma() returns, e.g. to the AnalysisBox rows once getFrameWidth() and getFrameHeight() have told where they are.
+	lumaRowsTop = lumaTop;
+	lumaRowsHeight = lumaHeight;
+	if (usingMapping) mappedVideo.setLumaRows(lumaTop, lumaHeight);
+	else if (usingDecoder) decoder.setLumaRows(lumaTop, lumaHeight);
+}
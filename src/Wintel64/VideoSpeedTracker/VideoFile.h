@@ -0,0 +1,115 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <opencv\highgui.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "FFmpegDecoder.h"
+#include "MappedVideo.h"
+
+using namespace std;
+using namespace cv;
+
+// Size and last modification time of a file, used to tell whether a cache made from it is still good.
+bool fileIdentity(string path, int64_t &size, int64_t &modified);
+
+// A KeyframeIndex lists the frame numbers of the keyframes in an avi file, read straight from the file's index (the OpenDML
+// super index and its standard indexes if present, idx1 otherwise), so nothing is decoded to build it.  It is cached in a .vsk
+// file next to the avi, keyed on the avi's size and modification time.
+//
+// File layout (little endian):  "VSTK", int32 version, int64 avi size, int64 avi modification time, int32 frame count,
+//                                int32 number of keyframes, then int32 frame number of each keyframe.
+
+class KeyframeIndex
+{
+public:
+	KeyframeIndex();
+	~KeyframeIndex();
+
+	bool load(string videoPath);  // From the .vsk cache if it matches, else from the avi (and then cached).
+	int keyframeAtOrBefore(int frameNum);
+	int getFrameCount();
+	bool isEmpty();
+
+private:
+
+	bool readCache(string cachePath, int64_t size, int64_t modified);
+	void writeCache(string cachePath, int64_t size, int64_t modified);
+	bool scanAvi(string videoPath);
+	bool scanHeaderList(ifstream &avi, int64_t end, int64_t &superIndexAt, uint32_t &superIndexSize, string &videoChunkId);
+	bool scanSuperIndex(ifstream &avi, int64_t at, uint32_t size);
+	bool scanIdx1(ifstream &avi, int64_t at, uint32_t size, string videoChunkId);
+
+	vector<int> keyframes;
+	int frameCount = 0;
+};
+
+// A VideoFile reads frames from an avi, keeping track of its own position rather than asking the capture backend every frame.
+// seek() goes to the nearest keyframe at or before the frame asked for, then grabs (decodes, but doesn't convert) forward to it,
+// so starting deep into a long file costs at most one GOP of decoding, and lands on exactly the frame asked for.
+// When built with FFmpeg (see FFmpegDecoder.h), frames are decoded by libavcodec instead, and readLuma() hands back just the
+// decoder's luma rows asked for at open(), in place.  Without FFmpeg, readLuma() converts just those rows of each frame to gray.
+// Pre-decoded files (.y4m, .gray) are read through a MappedVideo, and readLuma() hands back rows of the file mapping itself.
+
+class VideoFile
+{
+public:
+	VideoFile();
+	~VideoFile();
+
+	bool open(string videoPath, int lumaTop = 0, int lumaHeight = 0);
+	void release();
+	bool isOpened();
+
+	bool seek(int frameNum);
+	bool seekIsExact();		// False for an avi with no keyframe index:  the backend's seek may land near the frame, not on it.
+	bool read(Mat &frame);
+	bool readLuma(Mat &luma);
+	bool grab();
+	void setLumaRows(int lumaTop, int lumaHeight);
+
+	int getPosition();		// Number of the next frame read() will return.
+	double getMsec();		// Presentation time of the frame last read.
+	int getFrameCount();
+	double getFPS();
+	double getFrameWidth();
+	double getFrameHeight();
+
+private:
+
+	VideoCapture capture;
+	FFmpegDecoder decoder;
+	bool usingDecoder = false;
+	MappedVideo mappedVideo;
+	bool usingMapping = false;
+	KeyframeIndex keyframeIndex;
+	Mat decodedFrame;	// Whole color frame, when readLuma() has to make luma from it.
+	int lumaRowsTop = 0;
+	int lumaRowsHeight = 0;
+	int position = 0;
+	int frameCount = 0;
+};
@@ -0,0 +1,275 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#include "ViewerRing.h"
+#include <windows.h>
+#include <iostream>
+#include <cstring>
+
+// Ring layout:  the header, then VIEWER_SLOTS slots, each a ViewerSlot followed by room for a BGR AnalysisFrame and a mask.
+
+const LONG viewerRingMagic = 0x56535456;  // "VSTV"
+
+struct ViewerHeader
+{
+	LONG magic;
+	volatile LONG running;		// The run is still publishing.
+	volatile LONG latest;		// Sequence number of the newest whole pair;  0 for none yet
+	volatile LONG viewerTick;	// GetTickCount() when the viewer last checked in;  0 if it never has
+	volatile LONG keysSent;		// Keys the viewer has queued
+	volatile LONG keysTaken;	// Keys the run has taken
+	volatile LONG keys[VIEWER_KEYS];
+};
+
+struct ViewerSlot
+{
+	volatile LONG sequence;		// Pair's sequence number;  0 while being written
+	int frameNumber;
+	int objectDetected;
+	int L2RInTrack;
+	int R2LInTrack;
+	int speedAttempts;
+	int lastL2RSpeed;
+	int lastR2LSpeed;
+	char fileName[VIEWER_NAME_CHARS];
+	int frameWidth;				// AnalysisFrame, BGR
+	int frameHeight;
+	int maskWidth;				// Mask, one byte per pixel;  0 x 0 for none
+	int maskHeight;
+};
+
+const size_t viewerHeaderBytes = (sizeof(ViewerHeader) + 63) & ~size_t(63);
+const size_t viewerSlotBytes = ((sizeof(ViewerSlot) + 63) & ~size_t(63)) + size_t(VIEWER_MAX_PIXELS) * 4;  // 3 bytes a pixel, plus 1 of mask
+const size_t viewerRingBytes = viewerHeaderBytes + VIEWER_SLOTS * viewerSlotBytes;
+
+
+ViewerRing::ViewerRing()
+{
+}
+
+
+ViewerRing::~ViewerRing()
+{
+	close();
+}
+
+
+ViewerHeader* ViewerRing::header(){
+	return (ViewerHeader*)view;
+}
+
+ViewerSlot* ViewerRing::slot(long sequence){
+	return (ViewerSlot*)(view + viewerHeaderBytes + (sequence % VIEWER_SLOTS) * viewerSlotBytes);
+}
+
+uchar* slotPixels(ViewerSlot* s){
+	return (uchar*)s + ((sizeof(ViewerSlot) + 63) & ~size_t(63));
+}
+
+
+bool ViewerRing::map(bool creating){
+	close();
+	if (creating) mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, DWORD(viewerRingBytes), VIEWER_RING_NAME);  // Some 25 MB
+	else mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, VIEWER_RING_NAME);
+	bool existed = creating && mapping != NULL && GetLastError() == ERROR_ALREADY_EXISTS;
+	view = (mapping != NULL) ? (uchar*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, viewerRingBytes) : NULL;
+	if (view == NULL){
+		close();
+		return false;
+	}
+	if (existed && header()->magic == viewerRingMagic && header()->running){
+		cout << "Another VideoSpeedTracker run is using the viewer." << endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+
+bool ViewerRing::create(){
+// The run's end.  A viewer started ahead of the run, or left over from an earlier one, is kept.
+	if (!map(true)) return false;
+	publisher = true;
+	published = 0;
+	ViewerHeader* h = header();
+	LONG tick = (h->magic == viewerRingMagic) ? h->viewerTick : 0;
+	memset(h, 0, sizeof(ViewerHeader));
+	h->viewerTick = tick;
+	h->magic = viewerRingMagic;
+	InterlockedExchange(&h->running, 1);
+	return true;
+}
+
+
+bool ViewerRing::startViewer(){
+// Start a viewer, VideoSpeedTracker -view, in a console of its own.
+	char exePath[MAX_PATH];
+	if (GetModuleFileNameA(NULL, exePath, MAX_PATH) == 0) return false;
+	string commandLine = "\"" + string(exePath) + "\" -view";
+	STARTUPINFOA startup = { sizeof(STARTUPINFOA) };
+	PROCESS_INFORMATION process;
+	if (!CreateProcessA(NULL, &commandLine[0], NULL, NULL, FALSE, CREATE_NEW_CONSOLE, NULL, NULL, &startup, &process)){
+		cout << "Can't start the viewer.  Start it with  VideoSpeedTracker -view" << endl;
+		return false;
+	}
+	CloseHandle(process.hThread);
+	CloseHandle(process.hProcess);
+	return true;
+}
+
+
+bool ViewerRing::attach(){
+// The viewer's end.  False until a run has created the ring.
+	if (!map(false)) return false;
+	if (header()->magic != viewerRingMagic){
+		close();
+		return false;
+	}
+	publisher = false;
+	taken = 0;
+	checkIn();
+	return true;
+}
+
+
+void ViewerRing::close(){
+	if (view != NULL){
+		if (publisher) InterlockedExchange(&header()->running, 0);  // Lets the viewer know it's over.
+		UnmapViewOfFile(view);
+	}
+	if (mapping != NULL) CloseHandle(mapping);
+	view = NULL;
+	mapping = NULL;
+	publisher = false;
+}
+
+
+bool ViewerRing::isOpen(){
+	return view != NULL;
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * R u n   s i d e * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+bool ViewerRing::isWatched(){
+	if (view == NULL) return false;
+	DWORD tick = DWORD(header()->viewerTick);
+	return tick != 0 && (GetTickCount() - tick) < DWORD(VIEWER_TIMEOUT_MSEC);
+}
+
+
+bool ViewerRing::publish(const Mat &analysisFrame, const Mat &mask, const ViewerState &state){
+// Copy the pair into the oldest slot, and make it the newest.  Never waits on the viewer.
+	if (!isWatched() || analysisFrame.type() != CV_8UC3 || analysisFrame.total() > VIEWER_MAX_PIXELS
+		|| (!mask.empty() && (mask.type() != CV_8UC1 || mask.total() > VIEWER_MAX_PIXELS))) return false;
+	long sequence = ++published;
+	ViewerSlot* s = slot(sequence);
+	InterlockedExchange(&s->sequence, 0);
+	s->frameNumber = state.frameNumber;
+	s->objectDetected = state.objectDetected;
+	s->L2RInTrack = state.L2RInTrack;
+	s->R2LInTrack = state.R2LInTrack;
+	s->speedAttempts = state.speedAttempts;
+	s->lastL2RSpeed = state.lastL2RSpeed;
+	s->lastR2LSpeed = state.lastR2LSpeed;
+	strncpy(s->fileName, state.fileName.c_str(), VIEWER_NAME_CHARS - 1);
+	s->fileName[VIEWER_NAME_CHARS - 1] = 0;
+	s->frameWidth = analysisFrame.cols;
+	s->frameHeight = analysisFrame.rows;
+	s->maskWidth = mask.cols;
+	s->maskHeight = mask.rows;
+	uchar* pixels = slotPixels(s);
+	Mat slotFrame(analysisFrame.size(), CV_8UC3, pixels);
+	analysisFrame.copyTo(slotFrame);  // Same size and type, so copied in place.
+	if (!mask.empty()){
+		Mat slotMask(mask.size(), CV_8UC1, pixels + analysisFrame.total() * 3);
+		mask.copyTo(slotMask);
+	}
+	InterlockedExchange(&s->sequence, sequence);
+	InterlockedExchange(&header()->latest, sequence);
+	return true;
+}
+
+
+int ViewerRing::takeKey(){
+// Next key pressed in the viewer, or -1 if none is waiting.
+	if (view == NULL) return -1;
+	ViewerHeader* h = header();
+	if (h->keysTaken == h->keysSent) return -1;
+	int key = h->keys[h->keysTaken % VIEWER_KEYS];
+	InterlockedIncrement(&h->keysTaken);
+	return key;
+}
+
+
+// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * V i e w e r   s i d e * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+
+void ViewerRing::checkIn(){
+// Done every time the viewer looks for a pair.  A run publishes only while the viewer keeps checking in.
+	if (view == NULL) return;
+	DWORD tick = GetTickCount();
+	InterlockedExchange(&header()->viewerTick, LONG((tick == 0) ? 1 : tick));
+}
+
+
+bool ViewerRing::isRunning(){
+	return view != NULL && header()->running != 0;
+}
+
+
+bool ViewerRing::takeLatest(Mat &analysisFrame, Mat &mask, ViewerState &state){
+// The newest pair, if there's one newer than the last taken.  False, too, if the run overwrote it while it was being copied.
+	if (view == NULL) return false;
+	long sequence = header()->latest;
+	if (sequence == 0 || sequence == taken) return false;
+	ViewerSlot* s = slot(sequence);
+	if (s->sequence != sequence) return false;
+	state.frameNumber = s->frameNumber;
+	state.objectDetected = (s->objectDetected != 0);
+	state.L2RInTrack = s->L2RInTrack;
+	state.R2LInTrack = s->R2LInTrack;
+	state.speedAttempts = s->speedAttempts;
+	state.lastL2RSpeed = s->lastL2RSpeed;
+	state.lastR2LSpeed = s->lastR2LSpeed;
+	state.fileName = string(s->fileName, strnlen(s->fileName, VIEWER_NAME_CHARS));
+	int frameWidth = s->frameWidth, frameHeight = s->frameHeight, maskWidth = s->maskWidth, maskHeight = s->maskHeight;
+	if (frameWidth * frameHeight > VIEWER_MAX_PIXELS || maskWidth * maskHeight > VIEWER_MAX_PIXELS) return false;
+	uchar* pixels = slotPixels(s);
+	Mat(frameHeight, frameWidth, CV_8UC3, pixels).copyTo(analysisFrame);
+	if (maskWidth * maskHeight > 0) Mat(maskHeight, maskWidth, CV_8UC1, pixels + size_t(frameWidth) * frameHeight * 3).copyTo(mask);
+	else mask.release();
+	MemoryBarrier();
+	if (s->sequence != sequence) return false;  // Rewritten while being copied
+	taken = sequence;
+	return true;
+}
+
+
+void ViewerRing::sendKey(int key){
+// Queue a key for the run.  Dropped if the run has fallen VIEWER_KEYS keys behind.
+	if (view == NULL) return;
+	ViewerHeader* h = header();
+	if (h->keysSent - h->keysTaken >= VIEWER_KEYS) return;
+	h->keys[h->keysSent % VIEWER_KEYS] = key;
+	InterlockedIncrement(&h->keysSent);
+}
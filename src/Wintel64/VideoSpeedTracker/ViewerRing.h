@@ -0,0 +1,97 @@
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+#pragma once
+#include <opencv\cv.h>
+#include <string>
+
+using namespace std;
+using namespace cv;
+
+// A ViewerRing is a shared memory ring through which a VideoSpeedTracker run hands its video to a separate viewer process
+// (VideoSpeedTracker -view), so that showing the video never slows the analysis down.  After each frame pair, the run publishes its
+// annotated AnalysisFrame, the pair's motion mask and a little tracker state into the next of VIEWER_SLOTS slots, overwriting the
+// oldest.  The viewer shows the newest pair each time it looks, and simply never sees the ones it was too slow for.  Keys pressed in
+// the viewer's windows come back through a small queue in the ring.  Nothing is copied into the ring unless a viewer has checked in
+// within the last VIEWER_TIMEOUT_MSEC.
+//
+// A slot's sequence number is zeroed while the slot is being written, so a viewer that reads one while it is rewritten can tell, and
+// throws the copy away.
+
+const char VIEWER_RING_NAME[] = "Local\\VideoSpeedTrackerViewer";
+const int VIEWER_SLOTS = 3;						// Pairs in the ring
+const int VIEWER_MAX_PIXELS = 1920 * 1080;		// Largest AnalysisFrame (and mask) a slot can hold
+const int VIEWER_KEYS = 16;						// Keys queued from the viewer
+const int VIEWER_TIMEOUT_MSEC = 2000;			// A viewer not heard from for this long is gone.
+const int VIEWER_NAME_CHARS = 128;
+
+struct ViewerState  // What the tracker was up to at the pair shown
+{
+	int frameNumber = 0;
+	bool objectDetected = false;
+	int L2RInTrack = 0;			// Vehicles in track
+	int R2LInTrack = 0;
+	int speedAttempts = 0;		// Vehicles that have crossed the first speed line, this file
+	int lastL2RSpeed = 0;		// Latest speeds measured, this file;  0 for none yet
+	int lastR2LSpeed = 0;
+	string fileName;
+};
+
+struct ViewerHeader;  // Ring layout;  see ViewerRing.cpp
+struct ViewerSlot;
+
+class ViewerRing
+{
+public:
+	ViewerRing();
+	~ViewerRing();
+
+	bool create();
+	static bool startViewer();
+	bool attach();
+	void close();
+	bool isOpen();
+
+// Used by the run being viewed
+	bool isWatched();
+	bool publish(const Mat &analysisFrame, const Mat &mask, const ViewerState &state);
+	int takeKey();
+
+// Used by the viewer
+	void checkIn();
+	bool isRunning();
+	bool takeLatest(Mat &analysisFrame, Mat &mask, ViewerState &state);
+	void sendKey(int key);
+
+private:
+
+	bool map(bool creating);
+	ViewerHeader* header();
+	ViewerSlot* slot(long sequence);
+
+	void* mapping = NULL;		// Windows handle
+	uchar* view = NULL;			// The whole ring
+	bool publisher = false;		// This end publishes pairs (rather than viewing them).
+	long published = 0;			// Sequence number of the last pair published
+	long taken = 0;				// Sequence number of the last pair the viewer took
+};
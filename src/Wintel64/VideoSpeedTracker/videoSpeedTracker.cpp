@@ -1,1254 +1,1314 @@
-//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
-//                                     All rights reserved.
-
-//                                     License Agreement
-//                                For VideoSpeedTracker (VST)
-//                                 (3 - clause BSD License)
-
-// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
-// conditions are met :
-
-// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
-// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
-//      in the documentation and / or other materials provided with the distribution.
-// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-
-// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
-// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
-// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
-// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
-// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
-// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
-
-// ================
-//Thank you Kyle Hounslow for your helpful Youtube videos on motion tracking in B/W
-// ================
-
-//***********************************************************************************************************************
-//   This program processes video images of a typical two lane bidirectional street, tracks vehicles passing along that street,
-// and forms an estimate of each vehicle's speed.  Speadsheet data, in the form of a csv file, is produced by this porgram.  Each
-// entry in the csv file captures vehicle direction, frames in which the vehicle was analyzed for speed, the vehicle's profile area,
-// and the vehicle's estimated speed. 
-//   This program identifies vehicles in a video stream using what is classically known as "frame differencing", wherein
-// two consecutive video frames are differenced, against a relatively static background, in order to detect where motion has
-// occurred.  Often the shape arising in this differencing method approximates the shape of the vehicle.  More importantly, the
-// leading and trailing edges of the vehicle can generally be discerned.  A sequence of frame differences can be used to approximate
-// vehicle position over time, and therefore its velocity.
-//   Frame differencing can be noisy.  Glare off of windshields, shadows, similarly colored objects in the background and other artifacts
-// can make validity of a single frame difference questionable.  However, over time, most sequences of frame differences will produce
-// sufficient useful information to allow for reliable tracking of motion.  As is done in most radar systems, tracking reliability can
-// be enhanced significantly through the employment of a predictive tracking filter.  VST uses such a method to separately track
-// both the front edge of a vehicle and its trailing edge, and to predict where useful data about the vehicle will appear in a
-// subsequent frame difference.  The filtering/tracking method used in VST is a piecewise linear least squares method, which has
-// proven reliable under many circumstances in many tracking applications.
-//   VST is not perfect.  Mistracking can occur in the event frame difference data is too noisy to produce useful tracking, and therefore
-// speed estimation information.  VST produces an optional highlights video, which is intended to be used as a quality checker.  Before
-// making any results from VST public, the highlights video should be inspected manually for quality.
-//  A feature of VST that I have not seen in similar tools in the public domain before is handling of bidirectional traffic.  VST predicts
-// when two vehicles will pass and engages dead-reckoning to move the vehicle through conditions where raw data (frame difference images)
-// yield little useful data (without significant image shape analysis, which itself can be easily fooled by noisy data).  Dead-reckoning
-// of passing vehicles is working quite well in VST, based on my own observations of its ability to maintain track on the front bumper
-// of vehicle as it passes another.  Your experience may vary depending on conditions I can't control.
-//*****************************************************************************************************************************
-
-
-#include <opencv\cv.h>
-#include "opencv2\highgui\highgui.hpp"
-#include "Globals.h""
-#include <iostream>
-#include <fstream>
-#include <queue>
-#include "VehicleDynamics.h"
-#include "Projection.h"
-#include "Snapshot.h"
-
-
-
-using namespace std;
-using namespace cv;
-
-const int MAX_NUM_OBJECTS = 30; // Max number of objects allowed to be retunred by contours
-const int MIN_OBJECT_AREA = 30 * 35;  // Very sensitive to pedestrians, bicyclists and other small things.
-int numObjects = 0;  // 
-Rect coalescedRectangle;  //  The collection of blobs that represent a vehicles projected area.
-
-vector<VehicleDynamics> vehiclesGoingRight;
-vector<VehicleDynamics> vehiclesGoingLeft;
-
-bool bailing = false;
-
-
-
-// ........................................................ Globals shared between setup() and main() ................................................
-ofstream traceFile;
-ofstream statsFile;
-ifstream directoryList;
-ifstream filesList;
-VideoCapture capture;  //video capture object.
-bool moreFilesToDo = true;  //  Used to control file processing loop in main.
-string yesNoAll = "n";  // Indicates whetehr one file (Y) or multiple (*) are to be processed.
-string fileName;  // Name of avi file currently being processed.
-string dirPath; // path to fileName
-string fileMid; // The date part of the file name placed there by the Foscam camera
-int objDelay = 1250;  // delay to be used when objects are detected in ROI;  Can be changed through use of "f" and "s" keys while running
-bool pleaseTrace = false;  // If you want a trace file (lots of debug info)
-bool highLightsPlease = false;
-int speedLimit = 25;  // User supplied speed limit, used for color choice when posting speed
-int egregiousSpeedLowerBound = 35;    // User supplied egregious speed lower bound, used for color choice when posting speed
-int crazySpeed = 55;
-int highLightsSpeedLower = 35; // Default lower threshold for including vehicles in the highlights file
-int highLightsSpeedUpper = 100; // Default upper threshold for including vehicles in the highlights file
-int minimumProfileArea = 100;  // Default lower bound on size of large vehicle to be added to highlights if speeding over speed limit.
-int frameNumber; // Current framenumber being processed, relative to beginning of file "fileName"
-double startFrame = 0.0;
-Rect AnalysisBox;  // the coordinates and extents of the region beng analyzed for vehicle motion.  Subregion of frames read in.
-VideoWriter hiLiteVideo; // For writing highlights...the Scofflaws
-Globals g;
-
-Mat frame1, frame2; // Frames read by main, to use in frame differencing, and for display.
-//......................................................................................................................................................
-
-//int to string helper function
-string intToString(int number){
-	std::stringstream ss;
-	ss << number;
-	return ss.str();
-}
-
-// Interact with the user via command line to gather setup information.
-// Also, call readconfig() to read in (from file VST.cfg) and assign configuration data.
-void setup(){
-
-// Get configuration values from VST.cfg and set corresponding objects in Globals.h to read-in values.
-	if (!g.readConfig()){
-		cout << "Reading of config file appears to have failed.   Exiting" << endl;
-		exit(-1);
-	}
-// PixelLeft is always zero relative to AnalysisBoxLeft;  PixelRight depends on AnalysisBoxWidth/
-	g.pixelRight = g.AnalysisBoxWidth; // index of rightmost pixel in AnalysisBox.
-	AnalysisBox = Rect(g.AnalysisBoxLeft, g.AnalysisBoxTop, g.AnalysisBoxWidth, g.AnalysisBoxHeight);  // For use when performing speed analysis in cropped region
-
-	Mat frame;
-	string dirName;
-	string camPath = g.dataPathPrefix + "\\IPCam\\";
-
-	cout << endl << endl;
-
-// Get directory containing file(s) to be processed
-	string toSysString = "dir " + camPath + " /b > " + camPath + "directories.txt";
-	const char * toSysStringC = toSysString.c_str();
-//	system("dir g:\\LocustData\\IPCam /b > g:\\LocustData\\IPCam\\directories.txt");
-	system(toSysStringC);
-	string yesNo = "n";
-	while (yesNo == "n"){
-		directoryList.open(camPath + "directories.txt");
-		while (getline(directoryList, dirName)){
-			cout << "Want the directory " << dirName.substr(0, 4) + " " + dirName.substr(4, 2) + " " + dirName.substr(6, 2) << "  (y/n) [n]: ";
-			getline(cin, yesNo);
-			if (yesNo == "y") break;
-		}
-		directoryList.close();
-	}
-
-// Go through the file names in the selected directory for the user.
-	dirPath = camPath + dirName;
-	string sysString = "dir " + dirPath + "\\*.avi /b > " + dirPath + "\\files.txt";
-	const char * c = sysString.c_str();
-	system(c); // copy the file names from the chosen directory to file "files.txt" in the same directory.
-
-	// Get file user wants
-	while (yesNoAll == "n"){
-		filesList.open(dirPath + "\\files.txt");
-		while (getline(filesList, fileName)){
-			cout << "Want the file " << fileName.substr(0, 15) + "_" + fileName.substr(15, 10) << "  (y/n/*) [n]: ";
-			getline(cin, yesNoAll);
-			if (yesNoAll == "y" || yesNoAll == "*") break;  // User has chosen one file, or all in directory
-		}
-		filesList.close();
-	}
-
-	// Do a one-time setup of region of interest, obstructions and speed posts
-	string FullName = dirPath + "\\" + fileName;
-	capture.open(FullName);
-	if (!capture.isOpened()){
-		cout << "ERROR ACQUIRING VIDEO FEED\n";
-		getchar();
-		return;
-	}
-	capture.read(frame);
-	cv::line(frame, Point(g.AnalysisBoxLeft, g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth, g.AnalysisBoxTop), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft, g.AnalysisBoxTop + g.AnalysisBoxHeight), Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth, g.AnalysisBoxTop + g.AnalysisBoxHeight), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft, g.AnalysisBoxTop), Point(g.AnalysisBoxLeft, g.AnalysisBoxTop + g.AnalysisBoxHeight), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth, g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth, g.AnalysisBoxTop + g.AnalysisBoxHeight), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + g.speedLineLeft, 85 + g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.speedLineLeft, 160 + g.AnalysisBoxTop), Scalar(CVWhite), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + g.speedLineRight, 85 + g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.speedLineRight, 160 + g.AnalysisBoxTop), Scalar(CVWhite), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + g.obstruction[0], 85 + g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.obstruction[0], 160 + g.AnalysisBoxTop), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + g.obstruction[1], 85 + g.AnalysisBoxTop), Point(g.AnalysisBoxLeft + g.obstruction[1], 160 + g.AnalysisBoxTop), Scalar(CVYellow), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + 10, g.AnalysisBoxTop + g.R2LStreetY), Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth - 20, g.AnalysisBoxTop + g.R2LStreetY), Scalar(CVOrange), 2);
-	cv::line(frame, Point(g.AnalysisBoxLeft + 10, g.AnalysisBoxTop + g.L2RStreetY), Point(g.AnalysisBoxLeft + g.AnalysisBoxWidth - 20, g.AnalysisBoxTop + g.L2RStreetY), Scalar(CVPurple), 2);
-
-	switch (waitKey(20)){};
-	cv::imshow("Full Frame", frame);
-	switch (waitKey(20)){};
-
-	cout << endl << "Are Analysis Box, Speed Measuring Zone, " << endl << "    Obstruction Framing, and Hubcap Lines OK (y|n) [y] ?  ";
-	getline(cin, yesNo);
-	if (!yesNo.empty() & (yesNo == "n")){ 
-		cout << "You'll need to change values in VST.cfg.  Terminating.   Hit enter to exit program." << endl;
-		getline(cin, yesNo);
-		cv::destroyWindow("Full Frame");
-		capture.release();
-		exit(-1);
-	}
-	else{
-		if (yesNo.substr(0, 1) == "y")
-			cout << "Glad you're happy." << endl;;
-	}
-	cv::destroyWindow("Full Frame");
-
-	filesList.open(dirPath + "\\files.txt"); // Done for main() to access files contained therein
-
-// Want a trace file?
-	pleaseTrace = false;
-	cout << endl << "Want a trace file (y/n) [n]? : ";
-	getline(cin, yesNo);
-	if (!yesNo.empty()) pleaseTrace = (yesNo == "y");
-
-// Open trace file (if requested) and stats file
-	if (yesNoAll == "*"){ // give trace and stats files names based on directory name
-		if (pleaseTrace) traceFile.open(g.dataPathPrefix + "\\trace\\trace_" + dirName + ".txt");
-		statsFile.open(g.dataPathPrefix + "\\stats\\stats_" + dirName + ".csv");
-	}
-	else{ // yesNoAll == "y" which means only one file to process; give it name corresponding to input file name
-		fileMid = fileName.substr(7, 14);
-		if (pleaseTrace) traceFile.open(g.dataPathPrefix + "\\trace\\trace_" + fileMid.substr(0, 8) + "_" + fileMid.substr(8, 6) + ".txt");
-		statsFile.open(g.dataPathPrefix + "\\stats\\stats_" + fileMid.substr(0, 8) + "_" + fileMid.substr(8, 6) + ".csv");
-	}
-
-	statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
-
-	string answer;
-	cout << endl << "Speed Limit: (int) [" + intToString(speedLimit) + "]: ";
-	getline(cin, answer);
-	if (!answer.empty()) speedLimit = stoi(answer);
-	cout << endl;
-
-	egregiousSpeedLowerBound = speedLimit + 10;
-	cout << "Egregious Speed Lower Bound: (int) [" + intToString(egregiousSpeedLowerBound) + "]: ";
-	getline(cin, answer);
-	if (!answer.empty()) egregiousSpeedLowerBound = max(stoi(answer), speedLimit);
-	cout << endl;
-
-	crazySpeed = egregiousSpeedLowerBound + 20;  // Stats reporting will flag anything faster than this.
-
-// What frame number would you like to start with in the first file?
-
-	startFrame = 0.0;
-	cout << "Frame number to start with in first file (int) [0]? : ";
-	getline(cin, answer);
-	if (!answer.empty()) startFrame = stod(answer);
-
-// Want a highlights file?
-	highLightsPlease = false;
-	cout << endl << "Want a highlights file (y/n) [n]? : ";
-	getline(cin, yesNo);
-	if (!yesNo.empty()) highLightsPlease = (yesNo == "y");
-
-// What lower threshold speed for being added to highlights?
-	if (highLightsPlease){
-		cout << endl << "Threshold lower speed for highlights file: (int) [" + intToString(highLightsSpeedLower) + "]: ";
-		getline(cin, answer);
-		if (!answer.empty()) highLightsSpeedLower = stoi(answer);
-// What upper threshold speed for being added to highlights?
-		cout << endl << "Threshold upper bound on speed for highlights file: (int) [" + intToString(highLightsSpeedUpper) + "]: ";
-		getline(cin, answer);
-		if (!answer.empty()) highLightsSpeedUpper = stoi(answer);
-// What minimum profile area should be used for adding speeding vehicles to highlights?
-		cout << endl << "Min area of large speeding vehicle to be added to highlights (int) [" + intToString(minimumProfileArea) + "]: ";
-		getline(cin, answer);
-		if (!answer.empty()) minimumProfileArea = stoi(answer);
-		cout << endl;
-		if (yesNoAll == "*"){ // give trace and stats files names based on directory name
-			hiLiteVideo.open(g.dataPathPrefix + "\\HiLites\\Hilites_" + dirName + ".avi",
-//				CV_FOURCC('X', '2', '6', '4'), capture.get(CV_CAP_PROP_FPS), Size(1280, 720), true);
-			-1, capture.get(CV_CAP_PROP_FPS), Size(1280, 720), true); // bug in OpenCV open function.  x264 has to be picked from list.  Argh.
-		}
-		else{ // yesNoAll == "y" which means only one file to process; give it name corresponding to input file name
-			fileMid = fileName.substr(7, 14);
-			hiLiteVideo.open(g.dataPathPrefix + "\\HiLites\\Hilites_" + fileMid.substr(0, 8) + "_" + fileMid.substr(8, 6) + ".avi",
-//				CV_FOURCC('X', '2', '6', '4'), capture.get(CV_CAP_PROP_FPS), Size(1280, 720), true);
-			-1, capture.get(CV_CAP_PROP_FPS), Size(1280, 720), true); // bug in OpenCV open function.  x264 has to be picked from list.  Argh.
-			
-		}
-		if (!hiLiteVideo.isOpened()){
-			cout << "ERROR Opening HiLites File\n";
-			getchar();
-			return;
-		}
-	}
-	capture.release();
-	return;
-}
-
-
-
-string vStateString(vehicleStatus inState){
-	// {entering, inMiddle, exiting, exited};
-	if (inState == entering) return "entering";
-	else if (inState == inMiddle) return "inMiddle";
-	else if (inState == exiting) return "exiting";
-	else return "exited";
-}
-
-
-string statusString(statusTypes inStatus){
-	// statusTypes {ImOK, deleteWithStats, lostTrack, negVelocity }
-	if (inStatus == ImOK) return "ImOK";
-	else if (inStatus == deleteWithStats) return "deleteWithStats";
-	else if (inStatus == lostTrack) return "lostTrack";
-	else return "negVelocity";
-
-}
-
-
-string overlapString(OverlapType inOverlap){
-	//	none, rearOnly, frontOnly, bothOverlap
-	if (inOverlap == none) return "none";
-	else if (inOverlap == rearOnly) return "rearOnly";
-	else if (inOverlap == frontOnly) return "frontOnly";
-	else return "bothOverlap";
-}
-
-
-
-void hesitate(int code){  // easy breakpoint for debugging when you don't want to fire up a debugger.
-	cout << frameNumber << "  Program paused, input value is: " << code << "   Press 'p' to resume" << endl;
-	while (waitKey() != 112);
-}
-
-
-
-Rect coalesce(Rect rectangles[], int numRects, int loX, int hiX, grabType how){
-	// For a specified region of interest, put a single rectangle around all of the external contours the contours funtion found.
-	Rect retRect;
-	int firstOK = -1;
-	for (int i = 0; i < numRects; i++){ // find first if any rectangle that is in spec'd bounds
-		if (rectangles[i].x <= hiX && (rectangles[i].x + rectangles[i].width) >= loX){ // Any overlap at all?
-			retRect = rectangles[i];
-			if (how == strict) {  // Keep it inside LoX...HiX
-				retRect.x = max(rectangles[i].x, loX);
-				retRect.width = min(rectangles[i].x + rectangles[i].width, (loX + hiX)) - retRect.x;
-			}
-			firstOK = i;
-			break;
-		}
-	}
-	if (firstOK == -1){
-		if(pleaseTrace) traceFile << "<" << frameNumber << "> Coalesce finds no acceptable objects between loX:  " << loX << " and  hiX:  " << hiX << endl;
-		return Rect{ -1, 0, 0, 0 };
-	}
-	for (int i = (firstOK + 1); i < numRects; i++){
-		if (rectangles[i].x <= hiX && (rectangles[i].x + rectangles[i].width) >= loX){    // overlap with requested bounded area
-			int leftMore = min(retRect.x, rectangles[i].x);
-			int rightMore = max(retRect.x + retRect.width, rectangles[i].x + rectangles[i].width);
-			if (how == strict) {  // Keep it inside LoX...HiX
-				leftMore = max(leftMore, loX);
-				rightMore = min(rightMore, (loX + hiX));
-			}
-			retRect.x = leftMore;
-			retRect.width = rightMore - retRect.x;
-
-			int topMore = min(retRect.y, rectangles[i].y);
-			int bottomMore = max(retRect.y + retRect.height, rectangles[i].y + rectangles[i].height);
-			retRect.y = topMore;
-			retRect.height = bottomMore - retRect.y;
-		}
-	}
-	if (pleaseTrace) traceFile << "<" << frameNumber << "> Coalesce finds object in [" << loX << ", " << hiX << "] --> Rect:   " << retRect.x << ", "
-		<< retRect.y << ", " << retRect.width << ",   " << retRect.height;// << endl;
-	return retRect;
-
-}
-
-bool meetsHLRCriterion(int inSpeed, int inArea){ // Does the vehicle speed meet criterion for HiLites reel?
-	return highLightsPlease 
-		&& (   ((inSpeed >= highLightsSpeedLower) && (inSpeed <= highLightsSpeedUpper))
-		||    /* ((inSpeed >= (highLightsSpeedLower - 8)) && */ (inArea >= g.largeVehicleArea) /*)*/);
-}
-
-void displayAnalysisGoingRight(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed){
-// Display the green rectangle with the leading blue vertical line (hopefully on the front bumper) representng the *predicted*
-// area occupied by the vehicle.  Also display the velocity of the vehicle after it has has passed its second white post delineating the end
-// of the L2R speed measuring zone.  Also, save frame until it's known whether this vehicle will be added to highlights video.
-	int x = rectangle.x;
-	int y = rectangle.y;
-	int wd = rectangle.width;
-	int ht = rectangle.height;
-	cv::line(AnalysisFrame, Point(x, y), Point(x + wd, y), Scalar(CVGreen), 2);
-	cv::line(AnalysisFrame, Point(x, y + ht), Point(x + wd, y + ht), Scalar(CVGreen), 2);
-	if (Olap == rearOnly || Olap == bothOverlap)
-		cv::line(AnalysisFrame, Point(x, y), Point(x, y + ht), Scalar(CVRed), 2);
-	else
-		cv::line(AnalysisFrame, Point(x, y), Point(x, y + ht), Scalar(CVGreen), 2);
-	if (Olap == frontOnly || Olap == bothOverlap)
-		cv::line(AnalysisFrame, Point(x + wd, y), Point(x + wd, y + ht), Scalar(CVRed), 2);
-	else
-		cv::line(AnalysisFrame, Point(x + wd, y), Point(x + wd, y + ht), Scalar(CVBlue), 2);
-	if (estSpeed > 0)  
-		if (estSpeed <= speedLimit)  
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelRight-180, 30), 2, 1, Scalar(CVGreen), 2);
-		else if (estSpeed < egregiousSpeedLowerBound) 
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelRight-180, 30), 2, 1, Scalar(CVYellow), 2);
-		else                         
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelRight-180, 30), 2, 1, Scalar(CVRed), 2);
-	if (highLightsPlease){
-		if (vehiclesGoingRight[index].getTrackStartPixel() == 0)
-			vehiclesGoingRight[index].holdFrame(AnalysisFrame); // if vehicle hasnt passed start post yet, keep last frame in case about to cross into speed zone.
-		else {  // past the start post,
-			if (vehiclesGoingRight[index].getNumberSavedFrames() == 0) // First time to save a frame for hilites reel?
-				vehiclesGoingRight[index].saveFrame(vehiclesGoingRight[index].getHeldFrame()); // then start up saving frames to possibly copy to hilites file later on.
-			if (estSpeed <= 0) vehiclesGoingRight[index].saveFrame(AnalysisFrame); // Be saving frames past the start post.
-			else  // estSpeed is > 0 meaning vehicle has passed end post
-				if (meetsHLRCriterion(estSpeed, vehiclesGoingRight[index].getArea()) && vehiclesGoingRight[index].getTrackEndFrame() == frameNumber) // No use saving frames if vehicle doesn't meet hilites Reel criterion
-					vehiclesGoingRight[index].saveFrame(AnalysisFrame);
-		}
-	}
-	if (pleaseTrace) traceFile << "<" << frameNumber << "> DisplayGoingRight... Rect:  " << x << ", " << y << ", " << wd << ",  " << ht
-		<<endl << endl;
-}
-
-
-void displayAnalysisGoingLeft(int inFrameNum, int index, Rect rectangle, OverlapType Olap, Mat &AnalysisFrame, int estSpeed){
-// Display the green rectangle with the leading blue vertical line (hopefully on the front bumper) representng the *predicted*
-// area occupied by the vehicle.  Also display the velocity of the vehicle after it has has passed its second white post, delineating the end
-// of the R2L speed measuring zone.  Also, save frame until it's known whether this vehicle will be added to highlights video.
-	int x = rectangle.x;
-	int y = rectangle.y;
-	int wd = rectangle.width;
-	int ht = rectangle.height;
-	cv::line(AnalysisFrame, Point(x, y), Point(x + wd, y), Scalar(CVGreen), 2);
-	cv::line(AnalysisFrame, Point(x, y + ht), Point(x + wd, y + ht), Scalar(CVGreen), 2);
-	if (Olap == frontOnly || Olap == bothOverlap)
-		cv::line(AnalysisFrame, Point(x, y), Point(x, y + ht), Scalar(CVRed), 2);
-	else
-		cv::line(AnalysisFrame, Point(x, y), Point(x, y + ht), Scalar(CVBlue), 2);
-	if (Olap == rearOnly || Olap == bothOverlap)
-		cv::line(AnalysisFrame, Point(x + wd, y), Point(x + wd, y + ht), Scalar(CVRed), 2);
-	else
-		cv::line(AnalysisFrame, Point(x + wd, y), Point(x + wd, y + ht), Scalar(CVGreen), 2);
-	if (estSpeed > 0)
-		if(estSpeed <= speedLimit) 
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelLeft, 30), 2, 1, Scalar(CVGreen), 2);
-		else if (estSpeed < egregiousSpeedLowerBound)
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelLeft, 30), 2, 1, Scalar(CVYellow), 2);
-		else 
-			putText(AnalysisFrame, intToString(estSpeed) + " MPH", Point(g.pixelLeft, 30), 2, 1, Scalar(CVRed), 2);
-	if (highLightsPlease){
-		if (vehiclesGoingLeft[index].getTrackStartPixel() == 0) 
-			vehiclesGoingLeft[index].holdFrame(AnalysisFrame); // if vehicle hasnt passed start post yet, keep last frame in case about to cross into speed zone.
-		else {  // past the start post,
-			if (vehiclesGoingLeft[index].getNumberSavedFrames() == 0) // First time to save a frame for hilites reel?
-				vehiclesGoingLeft[index].saveFrame(vehiclesGoingLeft[index].getHeldFrame()); // then start up saving frames to possibly copy to hilites file later on.
-			if (estSpeed <= 0) vehiclesGoingLeft[index].saveFrame(AnalysisFrame); // Be saving frames past the start post.
-			else  // estSpeed is > 0 meaning vehicle has passed end post
-				if (meetsHLRCriterion(estSpeed, vehiclesGoingLeft[index].getArea()) && vehiclesGoingLeft[index].getTrackEndFrame() == frameNumber) // No use saving frames after end post if vehicle doesn't meet hilites Reel criterion
-					vehiclesGoingLeft[index].saveFrame(AnalysisFrame);
-		}
-	}
-	if (pleaseTrace) traceFile << "<" << frameNumber << "> DisplayGoingLeft... Rect:  " << x << ", " << y << ", " << wd << ",  " << ht
-		<< endl << endl;
-}
-
-
-
-
-
-
-
-void logL2Rstats(bool isOK, int index){
-// Final entries for L2R vehicle just completing speed analysis are placed in trace file and in stats files.  Video output to highlights
-//	file for qualifying vehicles is performed.
-	int frames = max(vehiclesGoingRight[index].getTrackEndFrame() - vehiclesGoingRight[index].getTrackStartFrame(), 1);
-	int estSpeed = vehiclesGoingRight[index].getFinalSpeed();
-	if (pleaseTrace) traceFile << "<" << frameNumber << ">   Entry frame: " << vehiclesGoingRight[index].getTrackStartFrame()
-		<< "   Exit frame : " << vehiclesGoingRight[index].getTrackEndFrame()
-		<< "   # frames: " << (vehiclesGoingRight[index].getTrackEndFrame() - vehiclesGoingRight[index].getTrackStartFrame())
-		<< endl
-		<< "         Entry pixel: " << vehiclesGoingRight[index].getTrackStartPixel()
-		<< "   Exit pixel: " << vehiclesGoingRight[index].getTrackEndPixel()
-		<< "   # Pixels: " << vehiclesGoingRight[index].getTrackEndPixel() - vehiclesGoingRight[index].getTrackStartPixel()
-		<< "             Est speed: " << estSpeed
-		<< endl << "> > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > >"
-		<< endl << endl << endl;
-	if ((estSpeed >= 18.0) && isOK){
-		statsFile << fileName.substr(7, 8) << ", " << fileName.substr(15, 6) << ", "
-			<< frameNumber << ", " << g.L2RDirection << ", " << vehiclesGoingRight[index].getTrackStartFrame() << ", "
-			<< vehiclesGoingRight[index].getTrackEndFrame() << ", "
-			<< frames << ", "
-			<< vehiclesGoingRight[index].getTrackStartPixel() << ", "
-			<< vehiclesGoingRight[index].getTrackEndPixel() << ", "
-			<< vehiclesGoingRight[index].getTrackEndPixel() - vehiclesGoingRight[index].getTrackStartPixel() << ", "
-			<< vehiclesGoingRight[index].getArea() << ", , "
-			<< estSpeed;
-		if (estSpeed < 0 || estSpeed > crazySpeed) statsFile << ", *****";
-		statsFile << endl;
-		if (meetsHLRCriterion(estSpeed, vehiclesGoingRight[index].getArea())){
-			Mat zero = Mat::zeros(Size(1280, 720), frame1.type());
-			int speedleft = AnalysisBox.x + g.speedLineLeft; // Left boundary may have moved right for ROI boundary.
-			int speedRight = AnalysisBox.x + g.speedLineRight;
-			int arrowY = AnalysisBox.y - 32;
-			frame1(Rect(0, 0, 240, 29)).copyTo(zero(Rect(500, 440, 240, 29))); // Get date/time from input frame and copy it to just below the ROI.
-			arrowedLine(zero, Point(speedleft + 10, arrowY), Point(speedleft + 60, arrowY), Scalar(CVPurple), 5);
-			for (int i = 0; i < 5; i++){
-				vehiclesGoingRight[index].getSavedFrame(0).copyTo(zero(AnalysisBox));
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			arrowedLine(zero, Point(speedleft + 10, arrowY), Point(speedleft + 60, arrowY), Scalar(CVBlack), 5);
-			int midPoint = (speedleft + speedRight) / 2;
-			arrowedLine(zero, Point(midPoint - 25, arrowY), Point(midPoint + 25, arrowY), Scalar(CVPurple), 5);
-			for (int i = 0; i <= vehiclesGoingRight[index].getNumberSavedFrames() - 1; i++){
-				vehiclesGoingRight[index].getSavedFrame(i).copyTo(zero(AnalysisBox));
-				if (i == vehiclesGoingRight[index].getNumberSavedFrames() - 1){
-					arrowedLine(zero, Point(midPoint - 25, arrowY), Point(midPoint + 25, arrowY), Scalar(CVBlack), 5);
-					arrowedLine(zero, Point(speedRight - 60, arrowY), Point(speedRight - 10, arrowY), Scalar(CVPurple), 5);
-					if (estSpeed >= egregiousSpeedLowerBound) 
-						putText(zero, intToString(estSpeed) + " MPH", Point(speedRight - 125, AnalysisBox.y - 55), 2, 1, Scalar(CVRed), 2);
-					else if (estSpeed > speedLimit)
-						putText(zero, intToString(estSpeed) + " MPH", Point(speedRight - 125, AnalysisBox.y - 55), 2, 1, Scalar(CVYellow), 2);
-					else putText(zero, intToString(estSpeed) + " MPH", Point(speedRight - 125, AnalysisBox.y - 55), 2, 1, Scalar(CVGreen), 2);
-				}
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			for (int i = 0; i < 5; i++){
-				vehiclesGoingRight[index].getSavedFrame(vehiclesGoingRight[index].getNumberSavedFrames() - 1).copyTo(zero(AnalysisBox));
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			hiLiteVideo.write(Mat::zeros(Size(1280, 720), frame1.type())); //  write a partition between vehicles for HiLites processor to detect.
-		}
-	}
-}
-
-void logR2Lstats(bool isOK, int index){
-// Final entries for R2L vehicle just completing speed analysis are placed in trace file and in stats files.  Video output to highlights
-//	file for qualifying vehicles is performed.
-	int frames = max(vehiclesGoingLeft[index].getTrackEndFrame() - vehiclesGoingLeft[index].getTrackStartFrame(), 1);
-	int estSpeed = vehiclesGoingLeft[index].getFinalSpeed();
-	if (pleaseTrace) traceFile
-		<< "<" << frameNumber << ">   Start frame: " << vehiclesGoingLeft[index].getTrackStartFrame()
-		<< "   End frame : " << vehiclesGoingLeft[index].getTrackEndFrame()
-		<< "   # frames: " << (vehiclesGoingLeft[index].getTrackEndFrame() - vehiclesGoingLeft[index].getTrackStartFrame())
-		<< endl
-		<< "          Start pixel: " << vehiclesGoingLeft[index].getTrackStartPixel()
-		<< "   End pixel: " << vehiclesGoingLeft[index].getTrackEndPixel()
-		<< "   # Pixels: " << vehiclesGoingLeft[index].getTrackStartPixel() - vehiclesGoingLeft[index].getTrackEndPixel()
-		<< "             Est speed: " << estSpeed
-		<< endl << "< < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < < <"
-		<< endl << endl << endl;
-	if ((estSpeed >= 18.0) && isOK){
-		statsFile << fileName.substr(7, 8) << ", " << fileName.substr(15, 6) << ", "
-			<< frameNumber << ", " << g.R2LDirection << ", " << vehiclesGoingLeft[index].getTrackStartFrame() << ", "
-			<< vehiclesGoingLeft[index].getTrackEndFrame() << ", "
-			<< frames << ", "
-			<< vehiclesGoingLeft[index].getTrackStartPixel() << ", "
-			<< vehiclesGoingLeft[index].getTrackEndPixel() << ", "
-			<< vehiclesGoingLeft[index].getTrackStartPixel() - vehiclesGoingLeft[index].getTrackEndPixel() << ", "
-			<< vehiclesGoingLeft[index].getArea() << ", , "
-			<< estSpeed;
-		if (estSpeed < 0 || estSpeed > crazySpeed) statsFile << ", *****";
-		statsFile << endl;
-		if (meetsHLRCriterion(estSpeed, vehiclesGoingLeft[index].getArea())){
-			Mat zero = Mat::zeros(Size(1280, 720), frame1.type());
-			int speedleft = AnalysisBox.x + g.speedLineLeft;
-			int speedRight = AnalysisBox.x + g.speedLineRight;
-			int arrowY = AnalysisBox.y - 32;
-			frame1(Rect(0, 0, 240, 29)).copyTo(zero(Rect(500, 440, 240, 29))); // Get date/time from input frame and copy it to just below the ROI.
-			arrowedLine(zero, Point(speedRight - 10, arrowY), Point(speedRight - 60, arrowY), Scalar(CVOrange), 5);
-			for (int i = 0; i < 5; i++){
-				vehiclesGoingLeft[index].getSavedFrame(0).copyTo(zero(AnalysisBox));
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			arrowedLine(zero, Point(speedRight - 10, arrowY), Point(speedRight - 60, arrowY), Scalar(CVBlack), 5);
-			int midPoint = (speedleft + speedRight) / 2;
-			arrowedLine(zero, Point(midPoint + 25, arrowY), Point(midPoint - 25, arrowY), Scalar(CVOrange), 5);
-			for (int i = 0; i <= vehiclesGoingLeft[index].getNumberSavedFrames() - 1; i++){
-				vehiclesGoingLeft[index].getSavedFrame(i).copyTo(zero(AnalysisBox));
-				if (i == vehiclesGoingLeft[index].getNumberSavedFrames() - 1){
-					arrowedLine(zero, Point(midPoint + 25, arrowY), Point(midPoint - 25, arrowY), Scalar(CVBlack), 5);
-					arrowedLine(zero, Point(speedleft + 60, arrowY), Point(speedleft + 10, arrowY), Scalar(CVOrange), 5);
-					if (estSpeed >= egregiousSpeedLowerBound)
-						putText(zero, intToString(estSpeed) + " MPH", Point(speedleft, AnalysisBox.y - 55), 2, 1, Scalar(CVRed), 2);
-					else if (estSpeed > speedLimit)
-						putText(zero, intToString(estSpeed) + " MPH", Point(speedleft, AnalysisBox.y - 55), 2, 1, Scalar(CVYellow), 2);
-					else putText(zero, intToString(estSpeed) + " MPH", Point(speedleft, AnalysisBox.y - 55), 2, 1, Scalar(CVGreen), 2);
-				}
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			for (int i = 0; i < 5; i++){
-				vehiclesGoingLeft[index].getSavedFrame(vehiclesGoingLeft[index].getNumberSavedFrames() - 1).copyTo(zero(AnalysisBox));
-				hiLiteVideo.write(zero);
-				waitKey(10);
-			}
-			hiLiteVideo.write(Mat::zeros(Size(1280, 720), frame1.type())); //  write a partition between vehicles for HiLites processor to detect.
-		}
-	}
-}
-
-
-OverlapType doesL2ROverlapAnyR2L(int L2RIndex, vector<Projection> vehiclesL2R, vector<Projection> vehiclesR2L, int projectedR2LSize){
-// Function name tells it all.  Does a selected L2R vehicle overlap any R2L vehicles?  Indicate which bumpers overlap.
-	bool frontOverlap = false;
-	bool rearOverlap = false;
-	int L2RRearBumper = max(vehiclesL2R[L2RIndex].getBox().x - (4 * g.SLOP), g.pixelLeft);
-	int L2RFrontBumper = min(L2RRearBumper + vehiclesL2R[L2RIndex].getBox().width + (5 * g.SLOP), g.pixelRight);  // 5x makes up for SLOP subtracted from rear bumper.
-	for (int R2LIndex = 0; R2LIndex < projectedR2LSize; R2LIndex++){
-		int R2LFrontBumper = vehiclesR2L[R2LIndex].getBox().x;
-		int R2LRearBumper = R2LFrontBumper + vehiclesR2L[R2LIndex].getBox().width;
-		if ((L2RFrontBumper >= R2LFrontBumper) && (L2RFrontBumper <= R2LRearBumper)) frontOverlap = true;
-		if ( ( (L2RRearBumper >= R2LFrontBumper) && (L2RRearBumper <= R2LRearBumper) )
-		/*	|| ((L2RRearBumper <= R2LFrontBumper) && (L2RFrontBumper >= R2LRearBumper)) */ ) rearOverlap = true;  // Handle full obstruction case
-	}
-	// none, rearOnly, frontOnly, bothOverlap
-	if (frontOverlap && rearOverlap) return bothOverlap;
-	if (frontOverlap) return frontOnly;
-	if (rearOverlap) return rearOnly;
-	return none;
-}
-
-
-OverlapType doesR2LOverlapAnyL2R(int R2LIndex, vector<Projection> vehiclesR2L, vector<Projection> vehiclesL2R, int projectedL2RSize){
-// Function name tells it all.  Does a selected R2L vehicle overlap any L2R vehicles?  Indicate which bumpers overlap.
-	bool frontOverlap = false;
-	bool rearOverlap = false;
-	int R2LFrontBumper = max(vehiclesR2L[R2LIndex].getBox().x - g.SLOP, g.pixelLeft);
-	int R2LRearBumper = min(R2LFrontBumper + vehiclesR2L[R2LIndex].getBox().width + (5 * g.SLOP), g.pixelRight);  // 4x makes up for SLOP subtracted from front bumper.
-	for (int L2RIndex = 0; L2RIndex < projectedL2RSize; L2RIndex++){
-		int L2RRearBumper = vehiclesL2R[L2RIndex].getBox().x;
-		int L2RFrontBumper = L2RRearBumper + vehiclesL2R[L2RIndex].getBox().width;
-		if ( (R2LFrontBumper <= L2RFrontBumper) && (R2LFrontBumper >= L2RRearBumper)) frontOverlap = true;
-		if ( ( (R2LRearBumper <= L2RFrontBumper) && (R2LRearBumper >= L2RRearBumper) ) 
-		/*	|| ((R2LRearBumper >= L2RFrontBumper) && (R2LFrontBumper <= L2RRearBumper)) */  ) rearOverlap = true;   // Handle full obstruction case
-	}
-	// none, rearOnly, frontOnly, bothOverlap
-	if (frontOverlap && rearOverlap) return bothOverlap;
-	if (frontOverlap) return frontOnly;
-	if (rearOverlap) return rearOnly;
-	return none;
-}
-
-
-
-//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  * 
-// Given next differential image, use projections of all known in-track vehicles, as well as information about newly entering vehicles, to identify and process
-// all that are 1) exiting, deleted, entering, overtaking, occluding, occluded, or simply moving forward.  If objects are detected in the region of interest, they
-// are bracketed and associated with entering or already known vehicles, and this new information is preserved for each vehicle in a call to addSnap(), one call for
-// each vehicle maintained in a direction sensitive vector of known to be in track vehicles.  The preservation of observed information enables predictive filter
-// based tracking, done elsewhere.
-//
-//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  * 
-
-bool manageMovers(Mat wholeScenethreshImage, Mat &AnalysisFrame){
-
-/// < < < < < < < < < < < < < < < < < < < < < < < < < < G e t   P r o j e c t i o n s   f o r   v e h s   a l r e a d y   i n   t r a c k  > > > > > > > > > > > > > > > > 
-// Get all L2R vehicle projections
-	vector<Projection> projectedL2R;  // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-	for (int index = 0; index < vehiclesGoingRight.size(); index++){
-		projectedL2R.push_back(vehiclesGoingRight[index].getBestProjection(g, frameNumber));
-		if (pleaseTrace) traceFile << endl << "<" << frameNumber << "> Project >>L2R>> vehicle[" << index << "]  Rect xywh: [" << projectedL2R[index].getBox().x << ", "
-			<< projectedL2R[index].getBox().y << ", " << projectedL2R[index].getBox().width << ",  " << projectedL2R[index].getBox().height
-			<< "]   vState: " << vStateString(projectedL2R[index].getVState())
-			<< "  Overlap: " << overlapString(vehiclesGoingRight[index].getOverlapStatus())
-			<< ",   pixDelta: " << projectedL2R[index].getVelocity() << endl
-			<< "     FBSlope (+): " << vehiclesGoingRight[index].getFBSlope() << "   FBIntcpt:  " << vehiclesGoingRight[index].getFBIntercept()
-			<< "  RBSlope: " << vehiclesGoingRight[index].getRBSlope() << "  RBIntcpt: " << vehiclesGoingRight[index].getRBIntercept()
-			<< "      projected FB: " << int(vehiclesGoingRight[index].getNextFrontBumper())
-			<< "  projected width: " << projectedL2R[index].getBox().width 
-			<< "  projected RB: " << int(vehiclesGoingRight[index].getNextRearBumper())
-			<< endl;
-	}
-
-// Get all R2L vehicle projections
-	vector<Projection> projectedR2L;  // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-	for (int index = 0; index < vehiclesGoingLeft.size(); index++){
-		projectedR2L.push_back(vehiclesGoingLeft[index].getBestProjection(g, frameNumber));
-		if (pleaseTrace) traceFile << endl << "<" << frameNumber << "> Project <<R2L<< vehicle[" << index << "]  Rect xywh: [" << projectedR2L[index].getBox().x << ", "
-			<< projectedR2L[index].getBox().y << ", " << projectedR2L[index].getBox().width << ",  " << projectedR2L[index].getBox().height
-			<< "]   vState: " << vStateString(projectedR2L[index].getVState())
-			<< "  Overlap: " << overlapString(vehiclesGoingLeft[index].getOverlapStatus())
-			<< ",   pixDelta: " << projectedR2L[index].getVelocity() << endl
-			<< "     FBSlope (-): " << vehiclesGoingLeft[index].getFBSlope() << "   FBIntcpt:  " << vehiclesGoingLeft[index].getFBIntercept()
-			<< "  RBSlope: " << vehiclesGoingLeft[index].getRBSlope() << "  RBIntcpt: " << vehiclesGoingLeft[index].getRBIntercept()
-			<< "      projected FB: " << int(vehiclesGoingLeft[index].getNextFrontBumper())
-			<< "  projected width: " << projectedR2L[index].getBox().width 
-			<< "      projected RB: " << int(vehiclesGoingLeft[index].getNextRearBumper())
-			<< endl;
-	}
-
-
-//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Get rid of all exited and deleted vehicles *  *  *  *  *  *  *  *  *  * 
-
-// If front L2R vehicle is exited, remove it from consideration
-	if ((vehiclesGoingRight.size() > 0) && (projectedL2R.front().getVState() == exited)){
-		if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle just exited." << endl;
-//		cout << "<" << frameNumber << ">   # # # # # # # L2R vehicle just exited." << endl;
-		logL2Rstats(true, 0); //
-		vehiclesGoingRight.erase(vehiclesGoingRight.begin());
-		projectedL2R.erase(projectedL2R.begin());
-	}
-
-// If front R2L vehicle is exited, remove it from consideration
-	if ((vehiclesGoingLeft.size() > 0) && (projectedR2L.front().getVState() == exited)){
-		if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle just exited." << endl;
-//		cout << "<" << frameNumber << ">   # # # # # # # R2L vehicle just exited." << endl;
-		logR2Lstats(true, 0);
-		vehiclesGoingLeft.erase(vehiclesGoingLeft.begin());
-		projectedR2L.erase(projectedR2L.begin());
-	}
-
-
-// Check for deleted L2R vehicles
-
-	for (int index = vehiclesGoingRight.size() - 1; index > -1; index--){
-		if (vehiclesGoingRight[index].getAmIOK() != ImOK) {
-			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingRight[index].getAmIOK()) << endl;
-//			cout << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingRight[index].getAmIOK()) << endl;
-			if (vehiclesGoingRight[index].getTrackEndPixel() > 0) logL2Rstats(true, index);
-			else logL2Rstats(false, /*vehiclesGoingRight[index].getAmIOK() == deleteWithStats*/ index);
-			vehiclesGoingRight.erase(vehiclesGoingRight.begin() + index);
-			projectedL2R.erase(projectedL2R.begin() + index);
-		}
-	}
-
-// Check for deleted R2L vehicles
-
-	for (int index = vehiclesGoingLeft.size() - 1; index > -1; index--){
-		if (vehiclesGoingLeft[index].getAmIOK() != ImOK) {
-			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingLeft[index].getAmIOK()) << endl;
-//			cout << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted: " << statusString(vehiclesGoingLeft[index].getAmIOK()) << endl;
-			if (vehiclesGoingLeft[index].getTrackEndPixel() > 0) logR2Lstats(true, index);
-			else logR2Lstats(false, /*vehiclesGoingLeft[index].getAmIOK() == deleteWithStats,*/ index);
-			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin() + index);
-			projectedR2L.erase(projectedR2L.begin() + index);
-		}
-	}
-
-// Check for L2R overrunning, as in a vehicle starting to pass a bicyclist; bail if overrunning detected.
-// This could be modified to delete the overrun vehicle instead, but leapfrogging would have to be dealt with.
-
-	for (int index = vehiclesGoingRight.size() - 1; index > 0; index--){
-		if (index > 0 && (projectedL2R[index].getBox().x + projectedL2R[index].getBox().width) > (projectedL2R[index - 1].getBox().x - 200) ) {
-			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is being deleted for overrunning: " << endl;
-			cout << "<" << frameNumber << ">   # # # # # # # L2R vehicle[" << index << "] is overrunning: "  << endl;
-			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
-			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
-			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
-			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
-			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
-			bailing = true;
-			cv::line(AnalysisFrame, Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed), 2);
-			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because of overrunning.   All current vehicles being dropped." << endl;
-		}
-	}
-
-// Check for R2L overrunning, as in a vehicle starting to pass a bicyclist; bail if overrunning detected.
-// This could be modified to delete the overrun vehicle instead, but leapfrogging would have to be dealt with.
-
-	for (int index = vehiclesGoingLeft.size() - 1; index > 0; index--){
-		if (index > 0 && ((projectedR2L[index - 1].getBox().x + projectedR2L[index - 1].getBox().width) > (projectedR2L[index].getBox().x - 200))) {
-			if (pleaseTrace) traceFile << endl << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is being deleted for overrunning: " << endl;
-			cout << "<" << frameNumber << ">   # # # # # # # R2L vehicle[" << index << "] is overrunning: " << endl;
-			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
-			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
-			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
-			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
-			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
-			bailing = true;
-			cv::line(AnalysisFrame, Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed), 2);
-			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because of overrunning.   All current vehicles being dropped." << endl;
-		}
-	}
-	
-
-
-//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Detect places of motion  *  *  *  *  *  *  *  *  *  * 
-	vector< vector<Point> > contours; // for findContours output
-	vector<Vec4i> hierarchy;  // for findContours output
-
-	int numOKSizeObjectsL2R = 0; // Used to count how many detected objects are in selected region of interest
-	Mat tempForL2R = wholeScenethreshImage(Rect(g.pixelLeft, 0, g.pixelRight, g.L2RStreetY)); // L2RStreetY is the lowest needed to go to see a rightbound vehicle
-	Rect objectBoundingRectangleL2R[MAX_NUM_OBJECTS]; // bounding rectangles, from top of ROI to L2R lane, captured in a given frame
-
-	findContours(tempForL2R, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);// retrieves external contours
-	// found some objects?
-	if (contours.size() > 0){   // Are both of
-		if (hierarchy.size() > 0) {  // these necessary?
-			numObjects = hierarchy.size();
-			//if number of objects greater than MAX_NUM_OBJECTS may need to adjust noise filter
-			if (numObjects < MAX_NUM_OBJECTS){
-				for (int index = 0; index >= 0; index = hierarchy[index][0]) {
-					objectBoundingRectangleL2R[numOKSizeObjectsL2R] = boundingRect(contours.at(index)); 		//make bounding rectangle 
-					if ((objectBoundingRectangleL2R[numOKSizeObjectsL2R].width * objectBoundingRectangleL2R[numOKSizeObjectsL2R].height) >= MIN_OBJECT_AREA)
-						numOKSizeObjectsL2R++;
-				} // for
-			} // if
-			else {
-				cout << "Too many L2R objects!" << endl;
-				numOKSizeObjectsL2R = 0;
-			}
-		} // if
-	} // if
-
-
-	int numOKSizeObjectsR2L = 0; // Used to count how many detected objects are in selected region of interest
-	Mat tempForR2L = wholeScenethreshImage(Rect(g.pixelLeft, 0, g.pixelRight, g.R2LStreetY)); // R2LStreetY is the lowest needed to go for leftbound vehicle
-	Rect objectBoundingRectangleR2L[MAX_NUM_OBJECTS]; // bounding rectangles captured in a given frame
-
-	contours.erase(contours.begin(), contours.end()); // Clear contours vector
-	hierarchy.erase(hierarchy.begin(), hierarchy.end());  // Clear hierarchy vector
-	//find external contours of filtered image using openCV findContours function
-	findContours(tempForR2L, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);// retrieves external contours
-	// found some objects?
-	if (contours.size() > 0){   // Are both of
-		if (hierarchy.size() > 0) {  // these necessary?
-			numObjects = hierarchy.size();
-			//if number of objects greater than MAX_NUM_OBJECTS may need to adjust noise filter
-			if (numObjects < MAX_NUM_OBJECTS){
-				for (int index = 0; index >= 0; index = hierarchy[index][0]) {
-					objectBoundingRectangleR2L[numOKSizeObjectsR2L] = boundingRect(contours.at(index)); 		//make bounding rectangle 
-					if ((objectBoundingRectangleR2L[numOKSizeObjectsR2L].width * objectBoundingRectangleR2L[numOKSizeObjectsR2L].height) >= MIN_OBJECT_AREA)
-						numOKSizeObjectsR2L++;
-				} // for
-			} // if
-			else {
-				cout << "Too many R2L objects!" << endl;
-				numOKSizeObjectsR2L = 0;
-			}
-		} // if
-	} // if
-
-
-
-// At this point objectBoundingRectanglexxx[] has numOKSizeObjectsxxx acceptable rectangles in it, possibly zero.  The rectangles are independent, non-overlapping.
-
-
-// This bailing code is used in circumstances where the scene is overwhelming.
-
-	if (((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0) && bailing){
-		cv::line(AnalysisFrame, Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed), 2);
-		if (pleaseTrace) traceFile << "<" << frameNumber << "> Still bailing." << endl;
-		return true;
-	}
-	else if(bailing){ // bailing with no objects detected.
-		bailing = false;
-		if (pleaseTrace) traceFile << "<" << frameNumber << "> Returning to analyzing traffic." << endl;
-	}
-
-
-
-//  Visual bracketing of the left/right ends of the range where speed measuring takes place.
-
-	cv::line(AnalysisFrame, Point(g.speedLineLeft, 180), Point(g.speedLineLeft, 25), Scalar(CVWhite), 2);
-	cv::line(AnalysisFrame, Point(g.speedLineRight, 180), Point(g.speedLineRight, 25), Scalar(CVWhite), 2);
-
-
-	if ((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0) { // rectangles found in areas checked, i.e. motion detected;  See what's up...
-
-//		cout << "<" << frameNumber << "> Num OK objects: " << numOKSizeObjects << "  L2R vehicles: " << vehiclesGoingRight.size() << "  R2L vehicles: " << vehiclesGoingLeft.size() << endl;
-		if (pleaseTrace) traceFile << "<" << frameNumber << "> Num OK L2R objects: " << numOKSizeObjectsL2R
-			<< " Num OK R2L objects: " << numOKSizeObjectsR2L << "  L2R vehicles: " << vehiclesGoingRight.size() << "  R2L vehicles: " << vehiclesGoingLeft.size() << endl;
-
-
-//  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  *  Safe to look for newly entering vehicles at the left and right ends of the analysis box? *  *  *  *  *  *  *  *
-//                                                       =========================================================================================
-
-// Left end is safe to check if there are no entering L2R vehicles and no R2L vehicles w/in a couple of frames of exiting left.
-//  > > > > > > > > > > > > > > > > > 
-		int safeL2RZone = g.pixelRight - g.pixelLeft;
-		int safeR2LZone = g.pixelRight - g.pixelLeft;
-		// "6" and "2" in following if statements can be tweaked.  I'm happy with their current values.
-		if (projectedR2L.size() > 0) safeR2LZone = max(projectedR2L.front().getBox().x - (2 * g.maxL2RDistOnEntry), 0);  // Identify safe range to front of oncoming car.
-		if (projectedL2R.size() > 0) safeL2RZone = max(projectedL2R.back().getBox().x - (6 * g.maxL2RDistOnEntry), 0);  // Identify safe range to rear of preceding car.
-
-		if (safeL2RZone > 0 && safeR2LZone > 0){
-			coalescedRectangle = coalesce(objectBoundingRectangleL2R, numOKSizeObjectsL2R,
-				g.pixelLeft, min(min(safeR2LZone, safeL2RZone), (g.pixelLeft + g.pixelRight) / 2), strict);  // Look for vehicle from left (-20 covers projection slop)
-			if (coalescedRectangle.x != -1){ // at least one object is present in coalesced rectangle(s)
-				vehiclesGoingRight.push_back(VehicleDynamics(L2R));
-				vehiclesGoingRight[vehiclesGoingRight.size() - 1].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
-				if (coalescedRectangle.x + coalescedRectangle.width >= g.speedLineLeft)
-					     vehiclesGoingRight[vehiclesGoingRight.size() - 1].markInvalidSpeed();
-				if (pleaseTrace) traceFile << endl << endl << "<" << frameNumber
-					<< ">    >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> Just added rightbound vehicle[" << vehiclesGoingRight.size() - 1 << "] >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>" << endl;
-				displayAnalysisGoingRight(frameNumber, vehiclesGoingRight.size() - 1, coalescedRectangle, none, AnalysisFrame, -1);
-			}
-		}
-
-// Right end is safe if there are no entering R2L vehicles and no L2R vehicles w/in a couple of frames of exiting left.
-// < < < < < < < < < < < < < < < < < < 
-		safeL2RZone = g.pixelRight - g.pixelLeft;
-		safeR2LZone = g.pixelRight - g.pixelLeft;
-		 // "6" and "2" in following if statements can be tweaked.  I'm happy with their current values.
-		if (projectedR2L.size() > 0)  safeR2LZone = max(g.pixelRight - (projectedR2L.back().getBox().x + projectedR2L.back().getBox().width + (6 * g.maxR2LDistOnEntry)), 0);   // Identify safe range to rear of preceding car.
-		if (projectedL2R.size() > 0) safeL2RZone = max(g.pixelRight - (projectedL2R.front().getBox().x + projectedL2R.front().getBox().width + (2 * g.maxR2LDistOnEntry)), 0);  // Identify safe range to front of oncoming car.
-
-		if (safeR2LZone > 0 && safeL2RZone > 0){
-			coalescedRectangle = coalesce(objectBoundingRectangleR2L, numOKSizeObjectsR2L,
-				     max(  max(g.pixelRight - safeL2RZone, g.pixelRight - safeR2LZone),
-				          (g.pixelLeft + g.pixelRight) / 2), g.pixelRight, strict);  // Look for vehicle from right
-			if (coalescedRectangle.x != -1){
-				vehiclesGoingLeft.push_back(VehicleDynamics(R2L));
-				vehiclesGoingLeft[vehiclesGoingLeft.size() - 1].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
-				if (coalescedRectangle.x <= g.speedLineRight)
-					     vehiclesGoingLeft[vehiclesGoingLeft.size() - 1].markInvalidSpeed();
-				if (pleaseTrace) traceFile << endl << endl << "<" << frameNumber
-					<< ">     <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< Just added leftbound vehicle[" << vehiclesGoingLeft.size() - 1 << "] <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl;
-				displayAnalysisGoingLeft(frameNumber, vehiclesGoingLeft.size() - 1, coalescedRectangle, none, AnalysisFrame, -1);
-			}
-		}
-
-
-// * * * * * * * * * * * * * * * * * * * * * * * *  P r o c e s s    a l l    p r o j e c t e d    v e h i c l e s * * * * * * * * * * * * * * * * * * * *
-//                                                 ================================================================
-
-// ---------------More than three in analysis zone with opposing traffic......
-		if ((vehiclesGoingRight.size() * vehiclesGoingLeft.size()) > 2){ // Bail on mixed direction, four or more vehicles total (includes just entered vehs)
-			// For now, erase all ongoing vehicle records and wait for scene to go quiescent.  Then start analyzing again.
-			vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());
-			vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());
-			projectedL2R.erase(projectedL2R.begin(), projectedL2R.end());
-			projectedR2L.erase(projectedR2L.begin(), projectedR2L.end());
-			bailing = true;
-			cv::line(AnalysisFrame, Point(g.pixelLeft + 1, 20), Point(g.pixelRight - 1, 20), Scalar(CVRed), 2);
-			if (pleaseTrace) traceFile << "<" << frameNumber << "> Starting to bail because  > 3 bi-directional traffic detected.  All current vehicles being dropped." << endl;
-		}
-
-
-		else {  // Ok, scene is one that can be handled. Clear past info about passing vehicles, and then check for passing vehicles now.
-			if(vehiclesGoingRight.size() > 0)
-				for (int i = 0; i < vehiclesGoingRight.size(); i++) 
-					vehiclesGoingRight[i].setOverlapStatus(none); // Reset any past L2R overlap determinations.
-			if (vehiclesGoingLeft.size() > 0)
-				for (int i = 0; i < vehiclesGoingLeft.size(); i++)
-					vehiclesGoingLeft[i].setOverlapStatus(none); // Reset any past R2L overlap determinations.
-// -------------- Two or three vehicles in analysis zone, a least one in each direction......
-			if ((projectedL2R.size() * projectedR2L.size()) >= 1) { // Two vehs currently in track (ignoring just entered vehicles now), one in each direction;
-				for (int i = 0; i < projectedL2R.size(); i++)
-					vehiclesGoingRight[i].setOverlapStatus(doesL2ROverlapAnyR2L(i, projectedL2R, projectedR2L, projectedR2L.size()));
-				for (int i = 0; i < projectedR2L.size(); i++)
-					vehiclesGoingLeft[i].setOverlapStatus(doesR2LOverlapAnyL2R(i, projectedR2L, projectedL2R, projectedL2R.size()));
-			}
-
-		}
-
-// > > > > > > > > > > > >  All *current* vehicles from left case (any newly added L2R vehicle not considered) > > > > > > > > > > > > > > > > > > > 
-//		                   ===================================================================================
-//  > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > > >
-
-		Rect objectBoundingRectangle[MAX_NUM_OBJECTS]; // bounding rectangles, formed in a direction sensitive manner
-
-		if (projectedL2R.size() > 0){ // All bidirectional cases considered by the time control gets here.
-			for (int index = 0; index < projectedL2R.size(); index++){
-            // First, focus the search for detected blobs to the region the vehicle is projected to occupy
-				//find external contours of filtered image using openCV findContours function
-				contours.erase(contours.begin(), contours.end()); // Clear contours vector
-				hierarchy.erase(hierarchy.begin(), hierarchy.end());  // Clear hierarchy vector
-				int tempX = max(projectedL2R[index].getBox().x - 80, g.pixelLeft);  // look behind the predicted rear bumper
-				int tempWidth = min(projectedL2R[index].getBox().width + 100, g.pixelRight - tempX); // Look a little beyond the front bumper;
-				Mat ROIL2R = wholeScenethreshImage(Rect(tempX, 0, tempWidth, g.L2RStreetY));
-				findContours(ROIL2R, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);// retrieves external contours
-				int numOKSizeL2RObjects = 0; // Used to count how many detected objects are in selected region of interest
-				// found some objects?
-				if (contours.size() > 0){   // Are both of
-					if (hierarchy.size() > 0) {  // these necessary?
-						for (int index = 0; index >= 0; index = hierarchy[index][0]) {
-							objectBoundingRectangle[numOKSizeL2RObjects] = boundingRect(contours.at(index)); 		//make bounding rectangle 
-							if ((objectBoundingRectangle[numOKSizeL2RObjects].width * objectBoundingRectangle[numOKSizeL2RObjects].height) >= MIN_OBJECT_AREA){
-								objectBoundingRectangle[numOKSizeL2RObjects].x += tempX;
-								numOKSizeL2RObjects++;
-							}
-						} // for
-					} // if
-				} // if
-			if(pleaseTrace) traceFile << "    Number of L2R objects is: " << numOKSizeL2RObjects << "  inside rect[x,y,wid,ht] "
-				<< tempX << ", " << 0 << ", " << tempWidth << ", " << g.L2RStreetY << endl;
-
-			// Get the best bounding rectangle possible for the vehicle being considered; if no objects were found, skip to display of projected data
-				if (numOKSizeL2RObjects > 0){
-					int projFrontBumper = projectedL2R[index].getBox().x + projectedL2R[index].getBox().width;
-					int projRearBumper = projectedL2R[index].getBox().x;
-					grabType grabRestriction = greedy;
-					if (vehiclesGoingRight[index].getOverlapStatus() == rearOnly)
-						grabRestriction = strict;
-					if (projectedL2R[index].getVState() == entering)
-						// Look a few pixels beyond projections in each direction
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, max(g.pixelLeft, (projRearBumper - 10)), (projFrontBumper + 20), grabRestriction);
-					else if (projectedL2R[index].getVState() == exiting)  // Look a few pixels beyond projections in each direction
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, (projRearBumper - 10), min((projFrontBumper + 10), g.pixelRight), grabRestriction);
-					else  // somewhere in the middle
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeL2RObjects, max((projRearBumper - 50),
-						g.pixelLeft), min((projFrontBumper + 10), g.pixelRight), grabRestriction);
-
-					// If no coalesced objects have been found, record no snapshot.
-					//                                        =======================
-					if (coalescedRectangle.x >= 0){    					// Coalesced objects found...
-						vehiclesGoingRight[index].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
-						// draw a purple rectangle around the area where objects related to the vehicle were found ("actual data")
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y), Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y), Scalar(CVPurple), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y + coalescedRectangle.height),
-							Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVPurple), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y), Point(coalescedRectangle.x, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVPurple), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y),
-							Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVPurple), 2);
-						if (pleaseTrace) traceFile << "  Observed FB: " << coalescedRectangle.x + coalescedRectangle.width
-							<< "   Observed width: " << coalescedRectangle.width 
-							<< "  Observed RB: " << coalescedRectangle.x
-							<< endl;
-					}
-				}
-
-				displayAnalysisGoingRight(frameNumber, index, projectedL2R[index].getBox(), vehiclesGoingRight[index].getOverlapStatus(), AnalysisFrame, vehiclesGoingRight[index].getFinalSpeed());
-			}
-		}
-
-//  < < < < < < < < < < < < < < < <   All *current* vehicles from right case (any newly added R2L vehicle not considered) < < < < < < < < < < < < < < < < < < < < < <
-//		                              ===================================================================================
-//  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < <  < < < < < < < < < < < < < < < < 
-
-
-		if (0 < projectedR2L.size()) { 
-			for (int index = 0; index < projectedR2L.size(); index++){
-				// First, focus the search for detected blobs to the region the vehicle is projectyed to occupy
-				//find external contours of filtered image using openCV findContours function
-				contours.erase(contours.begin(), contours.end()); // Clear contours vector
-				hierarchy.erase(hierarchy.begin(), hierarchy.end());  // Clear hierarchy vector
-				int tempX = max(projectedR2L[index].getBox().x - 20, g.pixelLeft);  // look a little ahead of the predicted front bumper
-				int tempWidth = min(projectedR2L[index].getBox().width + 100, g.pixelRight - tempX); // Look behind the rear bumper;
-				Mat ROIR2L = wholeScenethreshImage(Rect(tempX, 0, tempWidth, g.R2LStreetY));
-				findContours(ROIR2L, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);// retrieves external contours
-				int numOKSizeR2LObjects = 0; // Used to count how many detected objects are in selected region of interest
-				// found some objects?
-				if (contours.size() > 0){   // Are both of
-					if (hierarchy.size() > 0) {  // these necessary?
-						for (int index = 0; index >= 0; index = hierarchy[index][0]) {
-							objectBoundingRectangle[numOKSizeR2LObjects] = boundingRect(contours.at(index)); 		//make bounding rectangle 
-							if ((objectBoundingRectangle[numOKSizeR2LObjects].width * objectBoundingRectangle[numOKSizeR2LObjects].height) >= MIN_OBJECT_AREA){
-								objectBoundingRectangle[numOKSizeR2LObjects].x += tempX;
-								numOKSizeR2LObjects++;
-							}
-						} // for
-					} // if
-				} // if
-				if (pleaseTrace) traceFile << "    Number of R2L objects is: " << numOKSizeR2LObjects << "  inside rect[x,y,wid,ht] "
-					<< tempX << ", " << 0 << ", " << tempWidth << ", " << g.R2LStreetY << endl;
-
-
-
-				// Get the best bounding rectangle possible
-				if (numOKSizeR2LObjects > 0){ // Get the best bounding rectangle possible for the vehicle being considered; if no objects were found, skip to display of projected data
-					int projFrontBumper = projectedR2L[index].getBox().x;
-					int projRearBumper = projFrontBumper + projectedR2L[index].getBox().width;
-					grabType grabRestriction = greedy;
-					if (vehiclesGoingLeft[index].getOverlapStatus() == rearOnly)
-						grabRestriction = strict;
-					if (projectedR2L[index].getVState() == entering)
-						// Look a few pixels beyond projections in each direction
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, (projFrontBumper - 20), min((projRearBumper + 10), g.pixelRight), grabRestriction); // minus for R2L vehicle
-					else if (projectedR2L[index].getVState() == exiting)  // Look a few pixels beyond projections in each direction
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, max((projFrontBumper - 10), g.pixelLeft), (projRearBumper + 10), grabRestriction);
-					else  // somewhere in the middle
-						coalescedRectangle = coalesce(objectBoundingRectangle, numOKSizeR2LObjects, max((projFrontBumper - 20), g.pixelLeft),
-						min(projRearBumper + 50, g.pixelRight), grabRestriction);
-
-					// If no coalesced objects have been found, record no snapshot.
-					//                                        =======================
-					if (coalescedRectangle.x >= 0){  					// Coalesced objects found...
-						vehiclesGoingLeft[index].addSnapshot(Snapshot(coalescedRectangle, frameNumber));
-						// draw an orange rectangle around the area where objects related to the vehicle were found ("actual data")
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y), Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y), Scalar(CVOrange), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y + coalescedRectangle.height),
-							Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVOrange), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x, coalescedRectangle.y), Point(coalescedRectangle.x, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVOrange), 2);
-						line(AnalysisFrame, Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y),
-							Point(coalescedRectangle.x + coalescedRectangle.width, coalescedRectangle.y + coalescedRectangle.height), Scalar(CVOrange), 2);
-						if (pleaseTrace) traceFile << "  Observed FB: " << coalescedRectangle.x
-							<< "   Observed width: " << coalescedRectangle.width 
-							<< "   Observed RB: " << coalescedRectangle.x + coalescedRectangle.width
-							<< endl;
-					}
-				}
-				displayAnalysisGoingLeft(frameNumber, index, projectedR2L[index].getBox(), vehiclesGoingLeft[index].getOverlapStatus(), AnalysisFrame, vehiclesGoingLeft[index].getFinalSpeed());
-
-			}
-		}
-	}
-
-	else; // cout << "<" << frameNumber << ">  . . ." << endl; // This happens if numOKObjects == 0;
-
-	return ((numOKSizeObjectsL2R + numOKSizeObjectsR2L) > 0);
-}
-
-
-// ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^  M a i n  ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ 
-// ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^  M a i n  ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ 
-//
-//  Process image data per user request.  Key call halfway down is this:
-//                                                    objectDetected = manageMovers(thresholdImage, ROIFr2);
-// which causes processing of all known and newly entered vehicls to occur at time "frameNumber."  This one call exercises most of the code above
-// and most all of the code in vehicleDynamics.
-
-int main(){
-
-	bool objectDetected = false;
-	bool pause = false;  	 // toggle using "p"
-	bool showVideo = true;  // turning this off should make processing run faster.  toggled with a "v"
-	Mat grayImage1, grayImage2; // for absdiff() function
-	Mat differenceImage;
-	Mat thresholdImage;  	//thresholded difference image (for use in findContours() function)
-
-	setup();  // Get config data and user preferences for files to process, tracing, debugging, start frame and others
-
-//  * * * * * * * * * * * * * * * * * * * * * *  M a i n   L o o p   o v e r   o n e   o r   m o r e   i n p u t   f i l e s  * * * * * * * * * * * * * * * *
-
-
-	while (moreFilesToDo){
-
-		if (yesNoAll == "*"){
-			if (getline(filesList, fileName)){
-				cout << endl << "Now processing cam input file: " << fileName << endl;
-				if (pleaseTrace) traceFile << endl << "Now processing cam input file: " << fileName << endl;
-				vehiclesGoingRight.erase(vehiclesGoingRight.begin(), vehiclesGoingRight.end());  // Reinitialize
-				vehiclesGoingLeft.erase(vehiclesGoingLeft.begin(), vehiclesGoingLeft.end());   // Reinitialize  
-				bailing = false;  // Reinitialize
-				startFrame = 0.0;
-			}
-			else{
-				cout << endl << "Done processing all input files: " << fileName << endl;
-				if (pleaseTrace) traceFile << endl << "Done processing all input files: " << fileName << endl;
-				moreFilesToDo = false;
-				filesList.close();
-				break; 
-			}
-		}
-		else {  // yesNoAll must == "y";  "fileName" is the name of the file to process
-			moreFilesToDo = false;
-			filesList.close();
-		}
-
-
-		// dirName is the directory name (only) in which input files reside.  Its name is expected to be of the form: yyyymmdd
-		// dirPath is the path to the directory in which input (.avi) files are located; it includes dirName at the end, but no trailing reverse slashes 
-		// fileName is the name of the current avi file to be processed.  Its form is "manual_" <yyyymmddhhmmss> ".avi"   <<-- no spaces
-
-		string FName = dirPath + "\\" + fileName;
-		cout << "Trying to capture from " + FName << endl;
-		capture.open(FName);
-
-		if (!capture.isOpened()){
-			cout << "ERROR ACQUIRING VIDEO FEED\n";
-			getchar();
-			return -1;
-		}
-
-		double frameWidth = capture.get(CV_CAP_PROP_FRAME_WIDTH);
-		if (frameWidth != 1280.0){
-			cout << "Frame width is not 1280.  Bailing";
-			return - 1;
-		}
-		double FPS = capture.get(CV_CAP_PROP_FPS);
-		if (FPS != 30.0){
-			cout << "Frame rate is not 30.  Bailing";
-			return -1;
-		}
-
-		capture.set(CV_CAP_PROP_POS_FRAMES, startFrame);  // Set frame number to start at, in first file to be processed;  Remaining files will start at zero.
-		frameNumber = int(startFrame);
-		int delay = 10;   //at least 10ms delay is necessary for proper operation of this program <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-
-		//work through frame pairs looking for differences
-		while (capture.get(CV_CAP_PROP_POS_FRAMES) < capture.get(CV_CAP_PROP_FRAME_COUNT) - 2){ // minus 2 to prevent reading empty frame at end.
-			capture.read(frame1);
-			Mat ROIFr1 = frame1(AnalysisBox).clone();  			// Carve out the analysis box for motion detection
-			cv::cvtColor(ROIFr1, grayImage1, COLOR_BGR2GRAY);  //convert ROIFr1 to gray scale for frame differencing
-			capture.read(frame2);
-			Mat ROIFr2 = frame2(AnalysisBox).clone();   		   // Carve out the analysis box for motion detection
-			cv::cvtColor(ROIFr2, grayImage2, COLOR_BGR2GRAY);   //convert ROIFr2 to gray scale for frame differencing
-			cv::absdiff(grayImage1, grayImage2, differenceImage);   			//perform frame differencing
-			cv::threshold(differenceImage, thresholdImage, g.SENSITIVITY_VALUE, 255, THRESH_BINARY);  //threshold intensity image at a given sensitivity value
-			cv::blur(thresholdImage, thresholdImage, cv::Size(g.BLUR_SIZE, g.BLUR_SIZE));  //blur the image to reduce noise.
-			cv::threshold(thresholdImage, thresholdImage, g.SENSITIVITY_VALUE, 255, THRESH_BINARY);	//threshold again to obtain binary image from blur output
-
-			if (showVideo)	imshow("Final Threshold Image", thresholdImage);
-			else cv::destroyWindow("Final Threshold Image");
-
-		// ************************************************* Vehicle motion analysis *****************************************************
-			objectDetected = manageMovers(thresholdImage, ROIFr2);
-
-			frameNumber += 2;  // Note: frames are used in frame differencing operations only once each, so frame count jumps by two, not one.
-			                  // One could argue that using each frame as the second frame in a differencing operation, and then using it a second time
-			                  // as the first frame in the next differencing operation would increase resolution.  It probably would.  However,
-			                  // doubling frame differencing operations will increase processing times, and probably not add much to speed estimations quality.
-			                  // Look at the function computeFinalSpeed() in vehicleDynamics.cpp where I analyze distances of front bumper from the speed zone
-			                  // lines to decide whether or not to add or subtract one frame from the total number of frames a vehicle took to pass
-			                  // through the speed measuring zone.   I contend performing the +/-1 analysis brings back the accuracy that doubling frame
-			                  // differencing operations would provide, but at half the computational cost.
-
-			//show captured frame
-			 if (showVideo)imshow("Whole Scene", ROIFr2);
-
-			if (!showVideo)
-				delay = 1;
-			else if (objectDetected) 
-				delay = objDelay;
-			else 
-				delay = 10;
-
-			switch (waitKey(delay)){
-			case 27: //'esc'     exit program.
-				return 0;
-			case 102: // 'f'    make display go faster;
-				if (objDelay > 10) objDelay = objDelay / 5;
-				cout << "<" << frameNumber << ">  Delay:" << objDelay << endl;
-				break;
-			case 112: //'p'     pause/resume.
-				pause = !pause;
-				if (pause == true){
-					cout << "Code paused, press 'p' again to resume" << endl;
-					while (pause == true){
-						//wait for another p
-						switch (waitKey()){
-						case 112:
-							pause = false;
-							cout << "<" << frameNumber << ">  Code Resumed" << endl;
-							break;
-						} // switch
-					} // while paused
-				} // if pause
-				break;
-			case 115: // 's'      slow down display rate
-				if (objDelay <1250) objDelay = 5* objDelay;
-				cout << "<" << frameNumber << ">  Delay:" << objDelay << endl;
-				break;
-			case 118:  // 'v'  turn video on/off
-				showVideo = !showVideo;
-				break;
-			} // switch
-
-		} // main loop for processing one input file
-
-		capture.release();
-
-	} // looping over input files loop end
-
-//	if (highLightsPlease) hiLiteVideo.release();
-	if (pleaseTrace) traceFile.close();
-	if (highLightsPlease) hiLiteVideo.release();
-	statsFile.close();
-	return 0;
-
-}
-
+//                  Copyright Paul Reynolds, Locust Avenue, Charlottesville, Va,  2016
+//                                     All rights reserved.
+
+//                                     License Agreement
+//                                For VideoSpeedTracker (VST)
+//                                 (3 - clause BSD License)
+
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+// conditions are met :
+
+// 1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// 2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+//      in the documentation and / or other materials provided with the distribution.
+// 3) Neither the name of the copyright holder nor the names of the contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+
+// This software is provided by the copyright holder and contributors as is and any express or implied warranties, including,
+// but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed.In no event
+// shall copyright holders or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential
+// damages(including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business
+// interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort(including negligence
+// or otherwise) arising in any way out ofthe use of this software, even if advised of the possibility of such damage.
+
+// ================
+//Thank you Kyle Hounslow for your helpful Youtube videos on motion tracking in B/W
+// ================
+
+//***********************************************************************************************************************
+//   This program processes video images of a typical two lane bidirectional street, tracks vehicles passing along that street,
+// and forms an estimate of each vehicle's speed.  Speadsheet data, in the form of a csv file, is produced by this porgram.  Each
+// entry in the csv file captures vehicle direction, frames in which the vehicle was analyzed for speed, the vehicle's profile area,
+// and the vehicle's estimated speed. 
+//   This program identifies vehicles in a video stream using what is classically known as "frame differencing", wherein
+// two consecutive video frames are differenced, against a relatively static background, in order to detect where motion has
+// occurred.  Often the shape arising in this differencing method approximates the shape of the vehicle.  More importantly, the
+// leading and trailing edges of the vehicle can generally be discerned.  A sequence of frame differences can be used to approximate
+// vehicle position over time, and therefore its velocity.
+//   Frame differencing can be noisy.  Glare off of windshields, shadows, similarly colored objects in the background and other artifacts
+// can make validity of a single frame difference questionable.  However, over time, most sequences of frame differences will produce
+// sufficient useful information to allow for reliable tracking of motion.  As is done in most radar systems, tracking reliability can
+// be enhanced significantly through the employment of a predictive tracking filter.  VST uses such a method to separately track
+// both the front edge of a vehicle and its trailing edge, and to predict where useful data about the vehicle will appear in a
+// subsequent frame difference.  The filtering/tracking method used in VST is a piecewise linear least squares method, which has
+// proven reliable under many circumstances in many tracking applications.
+//   VST is not perfect.  Mistracking can occur in the event frame difference data is too noisy to produce useful tracking, and therefore
+// speed estimation information.  VST produces an optional highlights video, which is intended to be used as a quality checker.  Before
+// making any results from VST public, the highlights video should be inspected manually for quality.
+//  A feature of VST that I have not seen in similar tools in the public domain before is handling of bidirectional traffic.  VST predicts
+// when two vehicles will pass and engages dead-reckoning to move the vehicle through conditions where raw data (frame difference images)
+// yield little useful data (without significant image shape analysis, which itself can be easily fooled by noisy data).  Dead-reckoning
+// of passing vehicles is working quite well in VST, based on my own observations of its ability to maintain track on the front bumper
+// of vehicle as it passes another.  Your experience may vary depending on conditions I can't control.
+//*****************************************************************************************************************************
+
+
+#include <opencv\cv.h>
+#include "opencv2\highgui\highgui.hpp"
+#include "Globals.h""
+#include <iostream>
+#include <fstream>
+#include <queue>
+#include "VehicleDynamics.h"
+#include "Projection.h"
+#include "Snapshot.h"
+#include "DetectionLog.h"
+#include "SpeedTracker.h"
+#include "MotionMask.h"
+#include "VideoFile.h"
+#include "ParameterSweep.h"
+#include "LaneTracks.h"
+#include "LiveStream.h"
+#include "RawVideo.h"
+#include "SiteEngine.h"
+#include "CameraWatch.h"
+#include "Checkpoint.h"
+#include "ClipCopier.h"
+#include "ViewerRing.h"
+#include "MotionScreen.h"
+#include <ctime>
+#include <thread>
+#include <chrono>
+
+
+
+using namespace std;
+using namespace cv;
+
+// ........................................................ Globals shared between setup() and main() ................................................
+ifstream directoryList;
+ifstream filesList;
+VideoFile capture;  //video capture object.  Keeps its own frame position, and seeks via a cached keyframe index.
+bool moreFilesToDo = true;  //  Used to control file processing loop in main.
+string yesNoAll = "n";  // Indicates whetehr one file (Y) or multiple (*) are to be processed.
+string fileName;  // Name of avi file currently being processed.
+string dirPath; // path to fileName
+string fileMid; // The date part of the file name placed there by the Foscam camera
+string runName; // Directory name, or yyyymmdd_hhmmss of the single file, used to name the stats, trace and sweep output files
+int objDelay = 1250;  // delay to be used when objects are detected in ROI;  Can be changed through use of "f" and "s" keys while running
+int frameNumber; // Current framenumber being processed, relative to beginning of file "fileName"
+double startFrame = 0.0;
+Globals g;
+
+Mat frame1, frame2; // Frames read by main, to use in frame differencing, and for display.
+DetectionLog detectionLog;  // Detections being recorded or replayed for the current input file.
+bool maskCachePlease = false;  // Read motion masks from, or write them to, a .vsm cache next to each input avi.
+MaskCache maskCache;  // Motion masks being read or written for the current input file.
+bool probePlease = false;  // Skip full processing of frame pairs the cheap motion probe finds idle, while nothing is in track.
+bool validateProbe = false;  // Process every pair anyway, and count the pairs the probe would have skipped wrongly.
+bool screenPlease = false;  // Screen each input file by its motion vectors first, and seek past stretches with no motion in the lane bands.
+MotionScreen motionScreen;  // Stretches of the current input file with motion in them
+SpeedTracker tracker;  // Tracks the vehicles, and writes the stats, trace and highlights outputs.
+bool sweepPlease = false;  // Evaluate the parameter grid in sweep.cfg instead of a single VST.cfg run.
+ParameterSweep sweep;
+bool lanesPlease = false;  // Track the lanes listed in lanes.cfg, each group of them with its own tracker, instead of VST.cfg's two.
+LaneTracks laneTracks;
+bool liveMode = false;  // Analyze a camera, pipe or URL as frames arrive, instead of recorded files.
+string liveSource;  // Camera number, pipe name or URL
+LiveStream liveStream;
+bool rawMode = false;  // Live input is raw planar YUV from stdin or a named pipe (given on the command line), not through OpenCV.
+RawVideo rawVideo;
+double rawFPS = 30.0;  // Raw video carries no frame rate or timestamps.
+Size hiLiteSize;  // Frame size of the highlights file, if one is being written.  Only input of the matching size adds to it.
+bool checkpointPlease = false;  // Checkpoint this run, so it can be resumed if cut short.
+bool resuming = false;  // Taking up an interrupted run from its checkpoint (-resume).
+Checkpoint checkpoint;
+time_t lastCheckpoint = 0;
+bool viewerPlease = false;  // Show the video in a separate viewer process (VideoSpeedTracker -view), not in VST's own windows.
+ViewerRing viewer;  // Pairs handed to the viewer, and keys pressed in it
+Mat viewerMask;  // The pair's motion mask, as it was before manageMovers() altered it
+//......................................................................................................................................................
+
+Globals scaledFor(double width, double height, double FPS){
+// VST.cfg's configuration, fitted to video of this frame size and rate, at ProcessingScale.
+	Globals scaled = g;
+	scaled.scaleTo(int(width), int(height), FPS, g.ProcessingScale);
+	return scaled;
+}
+
+
+string checkpointPath(){
+// The latest checkpointed run's.  A run that finishes deletes it.
+	return g.dataPathPrefix + "\\stats\\checkpoint.txt";
+}
+
+
+string hiLitePathFor(string name){
+	return g.dataPathPrefix + "\\HiLites\\Hilites_" + name + ".avi";
+}
+
+
+// Interact with the user via command line to gather setup information.
+// Also, call readconfig() to read in (from file VST.cfg) and assign configuration data.
+void setup(){
+
+// Get configuration values from VST.cfg and set corresponding objects in Globals.h to read-in values.
+	if (!g.readConfig()){
+		cout << "Reading of config file appears to have failed.   Exiting" << endl;
+		exit(-1);
+	}
+// PixelLeft is always zero relative to AnalysisBoxLeft;  PixelRight depends on AnalysisBoxWidth/
+	g.pixelRight = g.AnalysisBoxWidth; // index of rightmost pixel in AnalysisBox.
+	tracker.configure(g);
+	tracker.detectionLog = &detectionLog;
+
+	Checkpoint unfinished;
+	if (unfinished.load(checkpointPath())){
+		cout << endl << "Run " << unfinished.runName << " was cut short at frame " << unfinished.frameNumber << " of " << unfinished.fileName << "." << endl
+			<< "Run \"VideoSpeedTracker -resume\" to finish it.  Starting a new run instead gives up on it." << endl;
+	}
+
+	Mat frame;
+	string dirName;
+	string camPath = g.dataPathPrefix + "\\IPCam\\";
+
+	cout << endl << endl;
+
+// Analyze a live source as it arrives, instead of recorded files?  A file named here is played back in real time, as a stand-in.
+	string yesNo = "n";
+	if (!rawMode){  // Raw video input was already opened from the command line.
+		cout << "Live source (camera number, pipe, URL or file) [none]: ";
+		getline(cin, liveSource);
+		liveMode = !liveSource.empty();
+	}
+	if (liveMode){
+		if (!rawMode && !liveStream.open(liveSource)){
+			cout << "ERROR ACQUIRING LIVE FEED\n";
+			getchar();
+			exit(-1);
+		}
+		if (rawMode) tracker.configure(scaledFor(rawVideo.getFrameWidth(), rawVideo.getFrameHeight(), rawFPS));
+		else tracker.configure(scaledFor(liveStream.getFrameWidth(), liveStream.getFrameHeight(), liveStream.getFPS()));
+		time_t now = time(0);
+		char stamp[15];
+		strftime(stamp, sizeof(stamp), "%Y%m%d%H%M%S", localtime(&now));
+		fileName = "stream_" + string(stamp) + ".avi";  // Named like a camera file, so stats and output names carry the start date and time.
+		yesNoAll = "y";
+	}
+	else{
+	// Re-run the tracker from previously recorded detections?  No video is decoded in that case.
+		yesNo = "n";
+		cout << "Replay recorded detections instead of video (y/n) [n]? : ";
+		getline(cin, yesNo);
+		tracker.replayDetections = (yesNo == "y");
+		string inputExtension = tracker.replayDetections ? ".vsd" : ".avi";
+
+	// Get directory containing file(s) to be processed
+		string toSysString = "dir " + camPath + " /b > " + camPath + "directories.txt";
+		const char * toSysStringC = toSysString.c_str();
+	//	system("dir g:\\LocustData\\IPCam /b > g:\\LocustData\\IPCam\\directories.txt");
+		system(toSysStringC);
+		yesNo = "n";
+		while (yesNo == "n"){
+			directoryList.open(camPath + "directories.txt");
+			while (getline(directoryList, dirName)){
+				cout << "Want the directory " << dirName.substr(0, 4) + " " + dirName.substr(4, 2) + " " + dirName.substr(6, 2) << "  (y/n) [n]: ";
+				getline(cin, yesNo);
+				if (yesNo == "y") break;
+			}
+			directoryList.close();
+		}
+
+	// Go through the file names in the selected directory for the user.
+		dirPath = camPath + dirName;
+		string sysString = "dir " + dirPath + "\\*" + inputExtension + (tracker.replayDetections ? "" : " " + dirPath + "\\*.y4m " + dirPath + "\\*.gray")  // Pre-decoded video too
+		+ " /b > " + dirPath + "\\files.txt";
+		const char * c = sysString.c_str();
+		system(c); // copy the file names from the chosen directory to file "files.txt" in the same directory.
+
+		// Get file user wants
+		while (yesNoAll == "n"){
+			filesList.open(dirPath + "\\files.txt");
+			while (getline(filesList, fileName)){
+				cout << "Want the file " << fileName.substr(0, 15) + "_" + fileName.substr(15, 10) << "  (y/n/*) [n]: ";
+				getline(cin, yesNoAll);
+				if (yesNoAll == "y" || yesNoAll == "*") break;  // User has chosen one file, or all in directory
+			}
+			filesList.close();
+		}
+
+		// Do a one-time setup of region of interest, obstructions and speed posts (needs video, so not possible when replaying detections)
+		if (!tracker.replayDetections){
+			string FullName = dirPath + "\\" + fileName;
+			capture.open(FullName);
+			if (!capture.isOpened()){
+				cout << "ERROR ACQUIRING VIDEO FEED\n";
+				getchar();
+				return;
+			}
+			capture.read(frame);
+			tracker.configure(scaledFor(capture.getFrameWidth(), capture.getFrameHeight(), capture.getFPS()));  // Sizes the highlights file.
+			Globals shown = g;  // VST.cfg's lines, at this video's size
+			shown.scaleTo(frame.cols, frame.rows, capture.getFPS(), 1.0);
+			int top85 = int(85 * shown.scaleY), top160 = int(160 * shown.scaleY);  // Extent of the posts drawn
+			cv::line(frame, Point(shown.AnalysisBoxLeft, shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth, shown.AnalysisBoxTop), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft, shown.AnalysisBoxTop + shown.AnalysisBoxHeight), Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth, shown.AnalysisBoxTop + shown.AnalysisBoxHeight), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft, shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft, shown.AnalysisBoxTop + shown.AnalysisBoxHeight), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth, shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth, shown.AnalysisBoxTop + shown.AnalysisBoxHeight), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + shown.speedLineLeft, top85 + shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.speedLineLeft, top160 + shown.AnalysisBoxTop), Scalar(CVWhite), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + shown.speedLineRight, top85 + shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.speedLineRight, top160 + shown.AnalysisBoxTop), Scalar(CVWhite), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + shown.obstruction[0], top85 + shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.obstruction[0], top160 + shown.AnalysisBoxTop), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + shown.obstruction[1], top85 + shown.AnalysisBoxTop), Point(shown.AnalysisBoxLeft + shown.obstruction[1], top160 + shown.AnalysisBoxTop), Scalar(CVYellow), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + 10, shown.AnalysisBoxTop + shown.R2LStreetY), Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth - 20, shown.AnalysisBoxTop + shown.R2LStreetY), Scalar(CVOrange), 2);
+			cv::line(frame, Point(shown.AnalysisBoxLeft + 10, shown.AnalysisBoxTop + shown.L2RStreetY), Point(shown.AnalysisBoxLeft + shown.AnalysisBoxWidth - 20, shown.AnalysisBoxTop + shown.L2RStreetY), Scalar(CVPurple), 2);
+
+			switch (waitKey(20)){};
+			cv::imshow("Full Frame", frame);
+			switch (waitKey(20)){};
+
+			cout << endl << "Are Analysis Box, Speed Measuring Zone, " << endl << "    Obstruction Framing, and Hubcap Lines OK (y|n) [y] ?  ";
+			getline(cin, yesNo);
+			if (!yesNo.empty() & (yesNo == "n")){ 
+				cout << "You'll need to change values in VST.cfg.  Terminating.   Hit enter to exit program." << endl;
+				getline(cin, yesNo);
+				cv::destroyWindow("Full Frame");
+				capture.release();
+				exit(-1);
+			}
+			else{
+				if (yesNo.substr(0, 1) == "y")
+					cout << "Glad you're happy." << endl;;
+			}
+			cv::destroyWindow("Full Frame");
+		}
+
+		filesList.open(dirPath + "\\files.txt"); // Done for main() to access files contained therein
+	}
+
+// Want to compare a grid of parameter values (from sweep.cfg) over this footage instead of a normal run?
+	sweepPlease = false;
+	if (!tracker.replayDetections && !liveMode){
+		cout << endl << "Run parameter sweep from sweep.cfg (y/n) [n]? : ";
+		getline(cin, yesNo);
+		if (!yesNo.empty()) sweepPlease = (yesNo == "y");
+	}
+
+// Want the lanes listed in lanes.cfg tracked, instead of VST.cfg's one lane each way?
+	lanesPlease = false;
+	if (!tracker.replayDetections && !liveMode && !sweepPlease){
+		cout << endl << "Track the lanes listed in lanes.cfg (y/n) [n]? : ";
+		getline(cin, yesNo);
+		lanesPlease = (yesNo == "y");
+	}
+
+// Want a trace file?
+	tracker.pleaseTrace = false;
+	if (!sweepPlease && !lanesPlease){
+		cout << endl << "Want a trace file (y/n) [n]? : ";
+		getline(cin, yesNo);
+		if (!yesNo.empty()) tracker.pleaseTrace = (yesNo == "y");
+	}
+
+// Want the video shown by a separate viewer, so that watching doesn't slow the analysis down?
+	viewerPlease = false;
+	if (!sweepPlease){
+		cout << endl << "Show video in a separate viewer, analyzing at full speed (y/n) [n]? : ";
+		getline(cin, yesNo);
+		viewerPlease = (yesNo == "y");
+	}
+
+// Want detections recorded, so the tracker can be re-run later without decoding video?
+	if (!tracker.replayDetections && !sweepPlease && !lanesPlease && !liveMode){
+		tracker.recordDetections = false;
+		cout << endl << "Record detections for later replay (y/n) [n]? : ";
+		getline(cin, yesNo);
+		if (!yesNo.empty()) tracker.recordDetections = (yesNo == "y");
+	}
+
+// Want motion masks cached, so later runs with the same AnalysisBox, SENSITIVITY_VALUE and BLUR_SIZE needn't decode video?
+	maskCachePlease = false;
+	if (!tracker.replayDetections && !liveMode){
+		cout << endl << "Use motion mask cache (y/n) [n]? : ";
+		getline(cin, yesNo);
+		if (!yesNo.empty()) maskCachePlease = (yesNo == "y");
+	}
+
+// Want idle frame pairs (no motion, nothing in track) skipped?  "v" runs the full pipeline regardless and reports where skipping would have mattered.
+	probePlease = false;
+	validateProbe = false;
+	if (!tracker.replayDetections && !sweepPlease && !liveMode){
+		cout << endl << "Skip idle frame pairs using motion probe (y/n/v) [n]? : ";
+		getline(cin, yesNo);
+		probePlease = (yesNo == "y" || yesNo == "v");
+		validateProbe = (yesNo == "v");
+	}
+
+// Want stretches with no motion vectors in the lane bands skipped without decoding them?  Needs H.264 or MPEG-4 video, and FFmpeg.
+	screenPlease = false;
+	if (!tracker.replayDetections && !sweepPlease && !liveMode && !validateProbe){
+		cout << endl << "Skip idle stretches found from motion vectors (y/n) [n]? : ";
+		getline(cin, yesNo);
+		screenPlease = (yesNo == "y");
+	}
+
+// Open trace file (if requested) and stats file
+	if (yesNoAll == "*"){ // give trace and stats files names based on directory name
+		runName = dirName;
+	}
+	else{ // yesNoAll == "y" which means only one file to process; give it name corresponding to input file name
+		fileMid = fileName.substr(7, 14);
+		runName = fileMid.substr(0, 8) + "_" + fileMid.substr(8, 6);
+	}
+	if (tracker.pleaseTrace) tracker.traceFile.open(g.dataPathPrefix + "\\trace\\trace_" + runName + ".txt");
+	if (!sweepPlease && !lanesPlease) tracker.statsFile.open(g.dataPathPrefix + "\\stats\\stats_" + runName + ".csv");  // A sweep writes one stats file per configuration, lanes one per group, instead.
+
+	if (!sweepPlease && !lanesPlease) tracker.statsFile << ", , Frame, Direction, StartFrame, EndFrame, # Frames, StartPix, EndPix, DeltaPix, VehicleArea, , estSpeed" << endl;
+
+	string answer;
+	cout << endl << "Speed Limit: (int) [" + intToString(tracker.speedLimit) + "]: ";
+	getline(cin, answer);
+	if (!answer.empty()) tracker.speedLimit = stoi(answer);
+	cout << endl;
+
+	tracker.egregiousSpeedLowerBound = tracker.speedLimit + 10;
+	cout << "Egregious Speed Lower Bound: (int) [" + intToString(tracker.egregiousSpeedLowerBound) + "]: ";
+	getline(cin, answer);
+	if (!answer.empty()) tracker.egregiousSpeedLowerBound = max(stoi(answer), tracker.speedLimit);
+	cout << endl;
+
+	tracker.crazySpeed = tracker.egregiousSpeedLowerBound + 20;  // Stats reporting will flag anything faster than this.
+
+	if (sweepPlease){
+		if (!sweep.readSweepConfig("sweep.cfg", g) || !sweep.open(g.dataPathPrefix + "\\stats\\sweep_" + runName, tracker)){
+			cout << "Sweep setup failed.   Exiting" << endl;
+			exit(-1);
+		}
+	}
+	if (lanesPlease){
+		if (!laneTracks.readLanesConfig("lanes.cfg", g)
+			|| !laneTracks.open(g.dataPathPrefix + "\\stats\\stats_" + runName, g.dataPathPrefix + "\\stats\\summary_", tracker)){
+			cout << "Lane setup failed.   Exiting" << endl;
+			exit(-1);
+		}
+	}
+
+// What frame number would you like to start with in the first file?
+
+	startFrame = 0.0;
+	if (!liveMode){
+		cout << "Frame number to start with in first file (int) [0]? : ";
+		getline(cin, answer);
+		if (!answer.empty()) startFrame = stod(answer);
+	}
+
+// Want a highlights file?  (Highlights need video frames, so none when replaying detections.)
+	tracker.highLightsPlease = false;
+	if (!tracker.replayDetections && !sweepPlease && !lanesPlease){
+		cout << endl << "Want a highlights file (y/n) [n]? : ";
+		getline(cin, yesNo);
+		if (!yesNo.empty()) tracker.highLightsPlease = (yesNo == "y");
+	}
+
+// What lower threshold speed for being added to highlights?
+	if (tracker.highLightsPlease){
+		cout << endl << "Threshold lower speed for highlights file: (int) [" + intToString(tracker.highLightsSpeedLower) + "]: ";
+		getline(cin, answer);
+		if (!answer.empty()) tracker.highLightsSpeedLower = stoi(answer);
+// What upper threshold speed for being added to highlights?
+		cout << endl << "Threshold upper bound on speed for highlights file: (int) [" + intToString(tracker.highLightsSpeedUpper) + "]: ";
+		getline(cin, answer);
+		if (!answer.empty()) tracker.highLightsSpeedUpper = stoi(answer);
+// What minimum profile area should be used for adding speeding vehicles to highlights?
+		cout << endl << "Min area of large speeding vehicle to be added to highlights (int) [" + intToString(tracker.minimumProfileArea) + "]: ";
+		getline(cin, answer);
+		if (!answer.empty()) tracker.minimumProfileArea = stoi(answer);
+// Whole frames, or just the analysis box and a caption?
+		cout << endl << "Compact highlights, analysis box only (y/n) [n]? : ";
+		getline(cin, yesNo);
+		tracker.compactHiLites = (yesNo == "y");
+// Highlights made now, or listed to be made by a second pass over the input files?
+		tracker.deferHiLites = false;
+		if (!liveMode){
+			cout << endl << "Defer highlights to a later VideoSpeedTracker -hilites pass (y/n) [n]? : ";
+			getline(cin, yesNo);
+			tracker.deferHiLites = (yesNo == "y");
+		}
+		cout << endl;
+		double inputFPS = tracker.g.inputFPS;
+		hiLiteSize = Size(tracker.g.frameWidth, tracker.g.frameHeight);  // The first input's.
+		if (tracker.deferHiLites){
+			tracker.deferredHiLites.dirPath = dirPath;
+			tracker.deferredHiLites.speedLimit = tracker.speedLimit;
+			tracker.deferredHiLites.egregiousSpeedLowerBound = tracker.egregiousSpeedLowerBound;
+			tracker.deferredHiLites.compactHiLites = tracker.compactHiLites;
+			if (!tracker.deferredHiLites.open(DeferredHiLites::pathFor(hiLitePathFor(runName)), false)){
+				getchar();
+				return;
+			}
+		}
+		else if (!tracker.openHiLites(hiLitePathFor(runName),  // Named as the stats file is:  directory name, or that of the single file
+//			CV_FOURCC('X', '2', '6', '4'), capture.getFPS(), Size(1280, 720));
+			-1, inputFPS, tracker.hiLiteFrameSize())){ // bug in OpenCV open function.  x264 has to be picked from list.  Argh.
+			cout << "ERROR Opening HiLites File\n";
+			getchar();
+			return;
+		}
+	}
+	capture.release();
+	return;
+}
+
+
+
+bool resumeHiLites(){
+// An avi can be neither cut short nor appended to, so the frames the interrupted highlights file had at the checkpoint are copied
+// into a new one, which the resumed run carries on writing.  The clips in them are listed again in the new file's index.
+	string hiLitePath = hiLitePathFor(runName);
+	string interruptedPath = hiLitePathFor(runName + "_interrupted");
+	remove(interruptedPath.c_str());
+	if (rename(hiLitePath.c_str(), interruptedPath.c_str()) != 0 && checkpoint.hiLiteFrames > 0){
+		cout << "Can't find the highlights file " << hiLitePath << endl;
+		return false;
+	}
+	vector<HiLiteClip> clips;  // Listed in the interrupted file's index
+	HiLiteIndex::read(HiLiteIndex::pathFor(hiLitePath), clips);
+	tracker.configure(scaledFor(hiLiteSize.width, hiLiteSize.height, checkpoint.hiLiteFPS));  // For the size of compact highlights
+	if (!tracker.openHiLites(hiLitePath, -1, checkpoint.hiLiteFPS, tracker.hiLiteFrameSize())){ // x264 has to be picked from list, as in setup().
+		cout << "ERROR Opening HiLites File\n";
+		return false;
+	}
+	VideoCapture interrupted(interruptedPath);
+	Mat frame;
+	while (tracker.hiLiteFramesWritten < checkpoint.hiLiteFrames && interrupted.read(frame)){
+		tracker.hiLiteVideo.write(frame);
+		tracker.hiLiteFramesWritten++;
+	}
+	interrupted.release();
+	for (int i = 0; i < clips.size() && clips[i].lastFrame < tracker.hiLiteFramesWritten; i++) tracker.hiLiteIndex.add(clips[i]);
+	if (tracker.hiLiteFramesWritten < checkpoint.hiLiteFrames)  // The writer hadn't got them to disk, or the file's index is missing.
+		cout << "Only " << tracker.hiLiteFramesWritten << " of the " << checkpoint.hiLiteFrames << " highlight frames could be read back.  "
+		<< interruptedPath << " is kept." << endl;
+	else remove(interruptedPath.c_str());
+	return true;
+}
+
+
+bool resumeSetup(){
+// Take up an interrupted run where its last checkpoint left it, with the answers given to setup() when it was started.
+	if (!g.readConfig()){
+		cout << "Reading of config file appears to have failed.   Exiting" << endl;
+		return false;
+	}
+	g.pixelRight = g.AnalysisBoxWidth;
+	tracker.configure(g);
+	tracker.detectionLog = &detectionLog;
+	if (!checkpoint.load(checkpointPath())){
+		cout << "No usable checkpoint to resume from in " << checkpointPath() << endl;
+		return false;
+	}
+	dirPath = checkpoint.dirPath;
+	yesNoAll = checkpoint.yesNoAll;
+	runName = checkpoint.runName;
+	fileName = checkpoint.fileName;
+	startFrame = checkpoint.frameNumber;
+	tracker.pleaseTrace = checkpoint.pleaseTrace;
+	tracker.highLightsPlease = checkpoint.highLightsPlease;
+	tracker.compactHiLites = checkpoint.compactHiLites;
+	tracker.deferHiLites = checkpoint.deferHiLites;
+	tracker.recordDetections = checkpoint.recordDetections;
+	maskCachePlease = checkpoint.maskCachePlease;
+	probePlease = checkpoint.probePlease;
+	validateProbe = checkpoint.validateProbe;
+	screenPlease = checkpoint.screenPlease;
+	tracker.speedLimit = checkpoint.speedLimit;
+	tracker.egregiousSpeedLowerBound = checkpoint.egregiousSpeedLowerBound;
+	tracker.crazySpeed = checkpoint.crazySpeed;
+	tracker.highLightsSpeedLower = checkpoint.highLightsSpeedLower;
+	tracker.highLightsSpeedUpper = checkpoint.highLightsSpeedUpper;
+	tracker.minimumProfileArea = checkpoint.minimumProfileArea;
+
+// Cut the outputs back to their lengths at the checkpoint, and carry on writing them from there.
+	string statsPath = g.dataPathPrefix + "\\stats\\stats_" + runName + ".csv";
+	string tracePath = g.dataPathPrefix + "\\trace\\trace_" + runName + ".txt";
+	if (!Checkpoint::truncateFile(statsPath, checkpoint.statsBytes)
+		|| (tracker.pleaseTrace && !Checkpoint::truncateFile(tracePath, checkpoint.traceBytes))){
+		cout << "The stats or trace file of run " << runName << " is missing or shorter than at the checkpoint." << endl;
+		return false;
+	}
+	tracker.statsFile.open(statsPath, ios::in | ios::out);  // Not ios::trunc
+	tracker.statsFile.seekp(0, ios::end);
+	if (tracker.pleaseTrace){
+		tracker.traceFile.open(tracePath, ios::in | ios::out);
+		tracker.traceFile.seekp(0, ios::end);
+	}
+	string deferredPath = DeferredHiLites::pathFor(hiLitePathFor(runName));
+	if (tracker.highLightsPlease && tracker.deferHiLites){  // The list is cut back as the stats file is, and carried on.
+		hiLiteSize = Size(checkpoint.hiLiteWidth, checkpoint.hiLiteHeight);
+		if (!Checkpoint::truncateFile(deferredPath, checkpoint.deferredBytes) || !tracker.deferredHiLites.open(deferredPath, true)){
+			cout << "The deferred highlights list " << deferredPath << " is missing or shorter than at the checkpoint." << endl;
+			return false;
+		}
+	}
+	else if (tracker.highLightsPlease){
+		hiLiteSize = Size(checkpoint.hiLiteWidth, checkpoint.hiLiteHeight);
+		if (!resumeHiLites()) return false;
+	}
+
+// Files before the checkpoint's are done.
+	if (yesNoAll == "*"){
+		filesList.open(dirPath + "\\files.txt");
+		string listed;
+		while (getline(filesList, listed) && listed != fileName);
+		if (listed != fileName){
+			cout << fileName << " is no longer in " << dirPath + "\\files.txt" << endl;
+			return false;
+		}
+	}
+	cout << "Resuming run " << runName << " at frame " << checkpoint.frameNumber << " of " << fileName << endl;
+	return true;
+}
+
+
+void startCheckpoints(){
+// Runs over recorded video are checkpointed.  (Replays are fast to redo;  live input can't be gone back to;  lane groups' trackers aren't saved.)
+	checkpointPlease = !liveMode && !sweepPlease && !lanesPlease && !tracker.replayDetections;
+	if (!checkpointPlease || resuming) return;  // A resumed run carries on with its checkpoint's answers.
+	checkpoint.dirPath = dirPath;
+	checkpoint.yesNoAll = yesNoAll;
+	checkpoint.runName = runName;
+	checkpoint.pleaseTrace = tracker.pleaseTrace;
+	checkpoint.highLightsPlease = tracker.highLightsPlease;
+	checkpoint.compactHiLites = tracker.compactHiLites;
+	checkpoint.deferHiLites = tracker.deferHiLites;
+	checkpoint.recordDetections = tracker.recordDetections;
+	checkpoint.maskCachePlease = maskCachePlease;
+	checkpoint.probePlease = probePlease;
+	checkpoint.validateProbe = validateProbe;
+	checkpoint.screenPlease = screenPlease;
+	checkpoint.speedLimit = tracker.speedLimit;
+	checkpoint.egregiousSpeedLowerBound = tracker.egregiousSpeedLowerBound;
+	checkpoint.crazySpeed = tracker.crazySpeed;
+	checkpoint.highLightsSpeedLower = tracker.highLightsSpeedLower;
+	checkpoint.highLightsSpeedUpper = tracker.highLightsSpeedUpper;
+	checkpoint.minimumProfileArea = tracker.minimumProfileArea;
+	checkpoint.hiLiteWidth = hiLiteSize.width;
+	checkpoint.hiLiteHeight = hiLiteSize.height;
+	checkpoint.hiLiteFPS = tracker.g.inputFPS;  // The first input's, as setup() opened the highlights file with.
+}
+
+
+void saveCheckpoint(){
+// Note how far the run has got.  Only called between vehicles, so there is no vehicle in track to save.
+	checkpoint.fileName = fileName;
+	checkpoint.frameNumber = frameNumber;
+	tracker.statsFile.flush();
+	checkpoint.statsBytes = tracker.statsFile.tellp();
+	if (tracker.pleaseTrace){
+		tracker.traceFile.flush();
+		checkpoint.traceBytes = tracker.traceFile.tellp();
+	}
+	checkpoint.hiLiteFrames = tracker.hiLiteFramesWritten;
+	checkpoint.deferredBytes = tracker.deferredHiLites.length();
+	checkpoint.summary = tracker.summary;
+	if (!checkpoint.save(checkpointPath())) cout << "Warning: can't write checkpoint " << checkpointPath() << endl;
+	lastCheckpoint = time(0);
+}
+
+
+void checkpointIfDue(){
+// Within a file, only with nothing in track.  Nor can a detection log or mask cache being written be taken up part way through.
+	if (checkpointPlease && tracker.isIdle() && !tracker.recordDetections && !maskCache.isWriting()
+		&& difftime(time(0), lastCheckpoint) >= CHECKPOINT_SECONDS) saveCheckpoint();
+}
+
+
+void hesitate(int code){  // easy breakpoint for debugging when you don't want to fire up a debugger.
+	cout << frameNumber << "  Program paused, input value is: " << code << "   Press 'p' to resume" << endl;
+	while (waitKey() != 112);
+}
+
+
+
+
+int nextKey(int delay){
+// A key pressed in VST's own windows, or in the viewer's;  -1 if none came within delay msec.  A delay of 0 waits for one.
+	if (!viewer.isOpen()) return waitKey(delay);
+	int key = viewer.takeKey();
+	int step = (delay > 0) ? min(delay, 10) : 10;
+	for (int waited = 0; key < 0 && (delay <= 0 || waited < delay); waited += step){
+		key = waitKey(step);
+		if (key < 0) key = viewer.takeKey();
+	}
+	return key;
+}
+
+
+bool userControl(int delay, bool &showVideo){
+// Wait for display, and act on any key the user pressed.  Returns false if the user wants to exit.
+	bool pause = false;  	 // toggle using "p"
+	switch (nextKey(delay)){
+	case 27: //'esc'     exit program.
+		return false;
+	case 102: // 'f'    make display go faster;
+		if (objDelay > 10) objDelay = objDelay / 5;
+		cout << "<" << frameNumber << ">  Delay:" << objDelay << endl;
+		break;
+	case 112: //'p'     pause/resume.
+		pause = !pause;
+		if (pause == true){
+			cout << "Code paused, press 'p' again to resume" << endl;
+			while (pause == true){
+				//wait for another p
+				switch (nextKey(viewer.isOpen() ? 250 : 0)){  // With a viewer, look up now and then to see it's still there.
+				case 112:
+					pause = false;
+					cout << "<" << frameNumber << ">  Code Resumed" << endl;
+					break;
+				case -1:
+					if (viewer.isOpen() && !viewer.isWatched() && !showVideo){  // The viewer was closed, and with it the only way to press 'p'.
+						pause = false;
+						cout << "<" << frameNumber << ">  Viewer gone;  Code Resumed" << endl;
+					}
+					break;
+				} // switch
+			} // while paused
+		} // if pause
+		break;
+	case 115: // 's'      slow down display rate
+		if (objDelay <1250) objDelay = 5* objDelay;
+		cout << "<" << frameNumber << ">  Delay:" << objDelay << endl;
+		break;
+	case 118:  // 'v'  turn video on/off
+		showVideo = !showVideo;
+		break;
+	} // switch
+	return true;
+}
+
+
+bool allIdle(){
+// Nothing in track, in the tracker or in any lane group's.
+	return lanesPlease ? laneTracks.isIdle() : tracker.isIdle();
+}
+
+
+void drawAnnotations(Mat &AnalysisFrame){
+	if (lanesPlease) laneTracks.drawAnnotations(AnalysisFrame);
+	else tracker.drawAnnotations(AnalysisFrame);
+}
+
+
+void publishPair(Mat &AnalysisFrame, bool objectDetected, bool watched){
+// Hand the pair just analyzed to the viewer, if one was watching when the pair was prepared (watched:  asked once per pair, so that
+// a viewer arriving part way through never gets annotations drawn on a frame that wasn't made for showing).  The viewer shows it,
+// or drops it if it's busy;  either way the run goes straight on.
+	if (!watched) return;
+	drawAnnotations(AnalysisFrame);
+	ViewerState state;
+	state.frameNumber = frameNumber;
+	state.objectDetected = objectDetected;
+	state.L2RInTrack = lanesPlease ? laneTracks.getNumInTrack(L2R) : tracker.getNumInTrack(L2R);
+	state.R2LInTrack = lanesPlease ? laneTracks.getNumInTrack(R2L) : tracker.getNumInTrack(R2L);
+	state.speedAttempts = lanesPlease ? laneTracks.getSpeedAttempts() : tracker.getSpeedAttempts();
+	state.lastL2RSpeed = lanesPlease ? laneTracks.getLastSpeed(L2R) : tracker.getLastSpeed(L2R);
+	state.lastR2LSpeed = lanesPlease ? laneTracks.getLastSpeed(R2L) : tracker.getLastSpeed(R2L);
+	state.fileName = lanesPlease ? laneTracks.getFileName() : tracker.fileName;
+	viewer.publish(AnalysisFrame, viewerMask, state);
+}
+
+
+int runViewer(int argc, char* argv[]){
+// VideoSpeedTracker -view  shows the video of a run that was asked to show it in a separate viewer, from a console of its own.
+// It shows the newest pair each time it looks, lingering on pairs with motion, so it never holds the run up.  'p' pauses the run,
+// esc ends it, 'f' and 's' make the viewer linger less or more, and 'v' closes the viewer, leaving the run to carry on unwatched.
+	ViewerRing ring;
+	cout << "Waiting for a VideoSpeedTracker run to show." << endl;
+	while (!ring.attach()) this_thread::sleep_for(chrono::milliseconds(500));
+	cout << "Showing the run.  p pauses it, esc ends it, f and s linger less or more on motion, v closes the viewer." << endl;
+	Mat frame, mask;
+	ViewerState state;
+	int linger = 250;  // msec a pair with motion in it stays up
+	while (ring.isRunning()){
+		ring.checkIn();
+		int delay = 10;
+		if (ring.takeLatest(frame, mask, state)){
+			imshow("Whole Scene", frame);
+			if (!mask.empty()) imshow("Final Threshold Image", mask);
+			cout << "\r<" << state.frameNumber << "> " << state.fileName << "   In track:  L2R " << state.L2RInTrack << ", R2L " << state.R2LInTrack
+				<< "   Speeds tried: " << state.speedAttempts << "   Last:  L2R " << state.lastL2RSpeed << ", R2L " << state.lastR2LSpeed << "      " << flush;
+			if (state.objectDetected) delay = linger;
+		}
+		switch (waitKey(delay)){
+		case 27: // 'esc'  end the run, and the viewer
+			ring.sendKey(27);
+			return 0;
+		case 112: // 'p'  pause/resume the run
+			ring.sendKey(112);
+			break;
+		case 102: // 'f'  linger less
+			if (linger > 10) linger = linger / 5;
+			break;
+		case 115: // 's'  linger more
+			if (linger < 1250) linger = 5 * linger;
+			break;
+		case 118:  // 'v'  close the viewer
+			return 0;
+		}
+	}
+	cout << endl << "The run has ended." << endl;
+	return 0;
+}
+
+
+int runSites(int argc, char* argv[]){
+// VideoSpeedTracker -sites <sites file> [threads]  analyzes every site listed in the sites file at once, without questions or windows.
+	int numThreads = 0;  // One per core
+	if (argc > 3 && (!readInt(argv[3], numThreads) || numThreads < 0)){
+		cout << "Usage: VideoSpeedTracker -sites <sites file> [threads]" << endl;
+		return -1;
+	}
+	SiteEngine engine;
+	if (!engine.readSitesConfig(argv[2])){
+		cout << "Site setup failed.   Exiting" << endl;
+		return -1;
+	}
+	return engine.run(numThreads) ? 0 : -1;
+}
+
+
+int runWatch(int argc, char* argv[]){
+// VideoSpeedTracker -watch [speed limit [highlights speed]]  analyzes camera files in <dataPathPrefix>\IPCam as the camera finishes
+// them, until esc is pressed.  Configuration comes from VST.cfg;  there are no questions or windows.
+	int speedLimit = 25, hiLiteSpeed = 0;  // 0:  no highlights
+	if ((argc > 2 && (!readInt(argv[2], speedLimit) || speedLimit <= 0)) || (argc > 3 && (!readInt(argv[3], hiLiteSpeed) || hiLiteSpeed < 0))){
+		cout << "Usage: VideoSpeedTracker -watch [speed limit [highlights speed]]" << endl;
+		return -1;
+	}
+	if (!g.readConfig()){
+		cout << "Reading of config file appears to have failed.   Exiting" << endl;
+		return -1;
+	}
+	CameraWatch watch;
+	if (!watch.open(g.dataPathPrefix + "\\IPCam\\", g, speedLimit, hiLiteSpeed)) return -1;
+	watch.run();
+	watch.close();
+	return 0;
+}
+
+
+int runSummary(int argc, char* argv[]){
+// Merge the speed summaries matching argv[2] (e.g. g:\locustdata\stats\summary_*20160114*.vss), and report them as csv,
+// to the file argv[3] if given.
+	SpeedSummary merged;
+	int numMerged = merged.mergeFiles(argv[2]);
+	if (numMerged == 0){
+		cout << "No speed summaries match " << argv[2] << endl;
+		return -1;
+	}
+	cout << "Merged " << numMerged << " speed summaries." << endl;
+	if (argc < 4){
+		merged.report(cout);
+		return 0;
+	}
+	ofstream reportFile(argv[3]);
+	if (!reportFile.is_open()){
+		cout << "Can't open " << argv[3] << endl;
+		return -1;
+	}
+	merged.report(reportFile);
+	return 0;
+}
+
+
+int runDeferred(int argc, char* argv[]){
+// VideoSpeedTracker -hilites <list>  makes the highlights file a run with deferred highlights listed clips for, beside the list and
+// named as it is, ending in .avi.  Each clip's frames are read again from its input file, in the directory the list names.
+	if (!g.readConfig()){
+		cout << "Reading of config file appears to have failed.   Exiting" << endl;
+		return -1;
+	}
+	string listPath = argv[2];
+	DeferredHiLites list;
+	vector<DeferredClip> clips;
+	if (!list.read(listPath, clips)){
+		cout << "Can't read deferred highlights list " << listPath << endl;
+		return -1;
+	}
+	tracker.speedLimit = list.speedLimit;
+	tracker.egregiousSpeedLowerBound = list.egregiousSpeedLowerBound;
+	tracker.compactHiLites = list.compactHiLites;
+	tracker.headless = true;
+	string hiLitePath = listPath.substr(0, listPath.find_last_of('.')) + ".avi";
+	VideoFile source;
+	string sourceName;
+	int numWritten = 0;
+	for (int c = 0; c < clips.size(); c++){
+		if (clips[c].sourceFile != sourceName){  // Clips are listed in input file order.
+			source.release();
+			sourceName = clips[c].sourceFile;
+			if (!source.open(list.dirPath + "\\" + sourceName)) cout << "Can't open " << list.dirPath + "\\" + sourceName << ".  Its clips are skipped." << endl;
+			else{
+				tracker.configure(scaledFor(source.getFrameWidth(), source.getFrameHeight(), source.getFPS()));
+				tracker.startFile(sourceName);  // Clips take date and time from the file name.
+			}
+		}
+		if (!source.isOpened()) continue;
+		Size inputSize(tracker.g.frameWidth, tracker.g.frameHeight);
+		if (hiLiteSize.area() == 0){  // Opened at the first input's size, as setup() would have.
+			if (!tracker.openHiLites(hiLitePath, -1, tracker.g.inputFPS, tracker.hiLiteFrameSize())){ // x264 has to be picked from list.
+				cout << "ERROR Opening HiLites File\n";
+				return -1;
+			}
+			hiLiteSize = inputSize;
+		}
+		if (inputSize != hiLiteSize) cout << sourceName << ":  frame size differs from the highlights file's.  Clip skipped." << endl;
+		else if (tracker.writeDeferredClip(clips[c], source)) numWritten++;
+		else cout << sourceName << ":  frames of the clip tracked from frame " << clips[c].trackStartFrame << " can't be read.  Skipped." << endl;
+	}
+	source.release();
+	if (hiLiteSize.area() > 0) tracker.closeHiLites();
+	cout << "Wrote " << numWritten << " of " << clips.size() << " clips to " << hiLitePath << endl;
+	return 0;
+}
+
+
+int runClips(int argc, char* argv[]){
+// VideoSpeedTracker -clips <list>  cuts the clips a run with deferred highlights listed straight out of their input files, with no
+// re-encoding, into <list name>_clip_<n>.avi beside the list.  <list name>_clips.csv lists them, and <list name>_clip_<n>.csv
+// gives what would have been drawn on each frame of clip n, in the input's pixels.
+	if (!g.readConfig()){
+		cout << "Reading of config file appears to have failed.   Exiting" << endl;
+		return -1;
+	}
+	string listPath = argv[2];
+	DeferredHiLites list;
+	vector<DeferredClip> clips;
+	if (!list.read(listPath, clips)){
+		cout << "Can't read deferred highlights list " << listPath << endl;
+		return -1;
+	}
+	string clipStem = listPath.substr(0, listPath.find_last_of('.'));
+	ofstream clipIndex(clipStem + "_clips.csv");
+	clipIndex << "Clip, SourceFile, Direction, Speed, VehicleArea, TrackStartFrame, SourceFirstFrame, SourceLastFrame" << endl;
+	ClipCopier source;
+	string sourceName;
+	int numCopied = 0;
+	for (int c = 0; c < clips.size(); c++){
+		int firstMark = 0;
+		while (firstMark < clips[c].marks.size() && clips[c].marks[firstMark].frame < 0) firstMark++;  // Unset marks name no frame.
+		if (firstMark == clips[c].marks.size()) continue;
+		if (clips[c].sourceFile != sourceName){  // Clips are listed in input file order.
+			source.release();
+			sourceName = clips[c].sourceFile;
+			if (!source.open(list.dirPath + "\\" + sourceName)) cout << "Can't open " << list.dirPath + "\\" + sourceName
+				<< " for copying (VST has to be built with FFmpeg to copy clips).  Its clips are skipped." << endl;
+			else tracker.configure(scaledFor(source.getFrameWidth(), source.getFrameHeight(), source.getFPS()));  // For the boxes' input pixels
+		}
+		if (!source.isOpened()) continue;
+		string clipName = clipStem + "_clip_" + intToString(c + 1);
+		int clipFirst, clipLast;
+		if (!source.copy(clips[c].marks[firstMark].frame, clips[c].marks.back().frame, clipName + ".avi", clipFirst, clipLast)){
+			cout << sourceName << ":  the clip tracked from frame " << clips[c].trackStartFrame << " can't be copied.  Skipped." << endl;
+			continue;
+		}
+		numCopied++;
+		clipIndex << c + 1 << ", " << sourceName << ", " << ((clips[c].dir == L2R) ? tracker.g.L2RDirection : tracker.g.R2LDirection) << ", "
+			<< clips[c].speed << ", " << clips[c].area << ", " << clips[c].trackStartFrame << ", " << clipFirst << ", " << clipLast << endl;
+		ofstream sidecar(clipName + ".csv");
+		sidecar << "ClipFrame, SourceFrame, Left, Top, Width, Height, Overlap, Speed" << endl;
+		Rect in = tracker.inputBox, box = tracker.AnalysisBox;  // Marks are in AnalysisBox pixels, at processing scale.
+		for (int m = firstMark; m < clips[c].marks.size(); m++){
+			const HiLiteMark &mark = clips[c].marks[m];
+			if (m > firstMark && mark.frame == clips[c].marks[m - 1].frame) continue;  // Already given
+			sidecar << mark.frame - clipFirst << ", " << mark.frame << ", "
+				<< in.x + mark.box.x * in.width / box.width << ", " << in.y + mark.box.y * in.height / box.height << ", "
+				<< mark.box.width * in.width / box.width << ", " << mark.box.height * in.height / box.height << ", "
+				<< overlapString(mark.olap) << ", " << mark.estSpeed << endl;
+		}
+	}
+	source.release();
+	cout << "Copied " << numCopied << " of " << clips.size() << " clips to " << clipStem << "_clip_*.avi" << endl;
+	return 0;
+}
+
+
+bool openRawInput(int argc, char* argv[]){
+// VideoSpeedTracker -raw I420|NV12 <width>x<height> [fps] [pipe]  reads raw video from the named pipe, or from stdin if none is given.
+	if (argc < 3 || string(argv[1]) != "-raw") return false;
+	string layoutName = argv[2];
+	int width = 0, height = 0;
+	if ((layoutName != "I420" && layoutName != "NV12") || argc < 4 || sscanf(argv[3], "%dx%d", &width, &height) != 2
+		|| (argc > 4 && (!readDouble(argv[4], rawFPS) || rawFPS <= 0.0))){  // Frame times and calibration are divided by fps.
+		cout << "Usage: VideoSpeedTracker -raw I420|NV12 <width>x<height> [fps] [pipe]" << endl;
+		exit(-1);
+	}
+	string source = (argc > 5) ? argv[5] : "-";
+	if (!rawVideo.open(source, (layoutName == "NV12") ? NV12 : I420, width, height)){
+		cout << "ERROR ACQUIRING RAW VIDEO FEED\n";
+		exit(-1);
+	}
+	liveSource = (source == "-") ? "stdin" : source;
+	return true;
+}
+
+
+// ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^  M a i n  ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ 
+// ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^  M a i n  ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ ^ 
+//
+//  Process image data per user request.  Key call halfway down is this:
+//                                                    objectDetected = tracker.manageMovers(thresholdImage, AnalysisFrame, frameNumber);
+// which causes processing of all known and newly entered vehicls to occur at time "frameNumber."  This one call exercises most of the code in SpeedTracker
+// and most all of the code in vehicleDynamics.
+
+int main(int argc, char* argv[]){
+
+	bool objectDetected = false;
+	bool showVideo = true;  // turning this off should make processing run faster.  toggled with a "v"
+	Mat thresholdImage;  	//thresholded difference image (for use in findContours() function)
+
+	if (argc > 2 && string(argv[1]) == "-sites") return runSites(argc, argv);  // Several streets at once;  nothing interactive.
+	if (argc > 1 && string(argv[1]) == "-watch") return runWatch(argc, argv);  // Camera files as they are finished, indefinitely.
+	if (argc > 2 && string(argv[1]) == "-summary") return runSummary(argc, argv);  // Speed summaries merged, from any runs.
+	if (argc > 2 && string(argv[1]) == "-hilites") return runDeferred(argc, argv);  // Highlights a run deferred, made from its list.
+	if (argc > 2 && string(argv[1]) == "-clips") return runClips(argc, argv);  // The same clips, copied from the input unannotated.
+	if (argc > 1 && string(argv[1]) == "-view") return runViewer(argc, argv);  // Another run's video, shown without slowing it.
+	resuming = (argc > 1 && string(argv[1]) == "-resume");  // Carry on from the last checkpoint, without asking anything.
+	if (resuming){
+		if (!resumeSetup()) return -1;
+	}
+	else{
+		rawMode = liveMode = openRawInput(argc, argv);  // Before setup():  raw video on stdin moves the setup questions to the console.
+		setup();  // Get config data and user preferences for files to process, tracing, debugging, start frame and others
+	}
+	startCheckpoints();
+	if (viewerPlease && viewer.create()){  // The viewer shows the video;  VST's own windows stay closed.
+		showVideo = false;
+		ViewerRing::startViewer();
+	}
+	if (!sweepPlease && !lanesPlease) tracker.summaryPrefix = g.dataPathPrefix + "\\stats\\summary_";  // A sweep's trackers don't summarize;  lane groups' do, on their own.
+
+//  * * * * * * * * * * * * * * * * * * * * * *  M a i n   L o o p   o v e r   o n e   o r   m o r e   i n p u t   f i l e s  * * * * * * * * * * * * * * * *
+
+
+	while (moreFilesToDo){
+
+		if (yesNoAll == "*"){
+			if (resuming){  // resumeSetup() left fileName and startFrame at the checkpoint.
+				cout << endl << "Now processing cam input file: " << fileName << " from frame " << int(startFrame) << endl;
+			}
+			else if (getline(filesList, fileName)){
+				cout << endl << "Now processing cam input file: " << fileName << endl;
+				if (tracker.pleaseTrace) tracker.traceFile << endl << "Now processing cam input file: " << fileName << endl;
+				startFrame = 0.0;
+			}
+			else{
+				cout << endl << "Done processing all input files: " << fileName << endl;
+				if (tracker.pleaseTrace) tracker.traceFile << endl << "Done processing all input files: " << fileName << endl;
+				moreFilesToDo = false;
+				filesList.close();
+				break; 
+			}
+		}
+		else {  // yesNoAll must == "y";  "fileName" is the name of the file to process
+			moreFilesToDo = false;
+			filesList.close();
+		}
+
+
+		// dirName is the directory name (only) in which input files reside.  Its name is expected to be of the form: yyyymmdd
+		// dirPath is the path to the directory in which input (.avi) files are located; it includes dirName at the end, but no trailing reverse slashes 
+		// fileName is the name of the current avi file to be processed.  Its form is "manual_" <yyyymmddhhmmss> ".avi"   <<-- no spaces
+
+		string FName = dirPath + "\\" + fileName;
+		tracker.startFile(fileName);  // Reinitialize vehicles in track
+		bool resumedFile = resuming;  // startFrame is the checkpoint's, and must be reached exactly.
+		if (resuming){  // Speeds logged from this file before the checkpoint
+			tracker.summary = checkpoint.summary;
+			resuming = false;
+		}
+		if (sweepPlease) sweep.startFile(fileName);
+		if (lanesPlease) laneTracks.startFile(fileName);
+
+		if (tracker.replayDetections){  // Re-run the tracker from recorded detections; no video involved.
+			cout << "Replaying detections from " + FName << endl;
+			if (!detectionLog.openForReplay(FName, tracker.g)){  // Replay assumes the reference frame size and rate.
+				cout << "ERROR OPENING DETECTION LOG\n";
+				getchar();
+				return -1;
+			}
+			Mat AnalysisFrame = Mat::zeros(tracker.AnalysisBox.size(), CV_8UC3);  // Nothing to see but the tracker's annotations, when shown.
+			Mat noThresholdImage;  // findBlobs() answers from the log.
+			int pairsReplayed = 0;
+			viewerMask.release();  // No masks to show
+			while (detectionLog.nextPair(frameNumber)){
+				if (frameNumber < int(startFrame)) continue;
+				bool watched = viewer.isWatched();  // Asked once per pair;  see publishPair().
+				if (showVideo || watched) AnalysisFrame.setTo(Scalar(CVBlack));
+				objectDetected = tracker.manageMovers(noThresholdImage, AnalysisFrame, frameNumber);
+				publishPair(AnalysisFrame, objectDetected, watched);
+				if (showVideo){
+					tracker.drawAnnotations(AnalysisFrame);
+					imshow("Whole Scene", AnalysisFrame);
+					if (!userControl(objectDetected ? objDelay : 10, showVideo)) return 0;
+				}
+				else if ((++pairsReplayed % 1000) == 0){  // Without video, check the keyboard only now and then; waitKey() would dominate replay time.
+					if (!userControl(1, showVideo)) return 0;
+				}
+			}
+			detectionLog.close();
+			continue;
+		}
+
+		if (rawMode){  // Raw YUV:  difference the Y planes in place.  Chroma is converted only for highlights, which need color.
+			cout << "Analyzing raw " << rawVideo.getFrameWidth() << "x" << rawVideo.getFrameHeight() << " video from " + liveSource << endl;
+			Mat raw1, raw2;  // Whole raw frames, luma then chroma
+			Mat AnalysisFrame = Mat::zeros(tracker.AnalysisBox.size(), CV_8UC3);  // Annotations only, when shown without highlights.
+			frameNumber = 0;
+			while (rawVideo.read(raw1) && rawVideo.read(raw2)){
+				bool watched = viewer.isWatched();  // Asked once per pair;  see publishPair().
+				tracker.differenceLuma(rawVideo.luma(raw1), rawVideo.luma(raw2), tracker.inputBox, thresholdImage);
+				if (tracker.highLightsPlease){  // Highlights keep color frames, and the date/time stamp from frame1.
+					rawVideo.toBGR(raw1, frame1);
+					rawVideo.toBGR(raw2, frame2);
+					tracker.frame1 = frame1;
+					AnalysisFrame = atProcessingScale(frame2(tracker.inputBox), tracker.AnalysisBox.size()).clone();
+				}
+				else if (showVideo || watched)
+					cv::cvtColor(atProcessingScale(rawVideo.luma(raw2)(tracker.inputBox), tracker.AnalysisBox.size()), AnalysisFrame, COLOR_GRAY2BGR);
+				if (showVideo)	imshow("Final Threshold Image", thresholdImage);
+				else cv::destroyWindow("Final Threshold Image");
+				if (watched) thresholdImage.copyTo(viewerMask);
+				objectDetected = tracker.manageMovers(thresholdImage, AnalysisFrame, frameNumber, frameNumber * 1000.0 / rawFPS);  // Every frame arrives, so counting gives the time.
+				publishPair(AnalysisFrame, objectDetected, watched);
+				frameNumber += 2;
+				if (showVideo){
+					tracker.drawAnnotations(AnalysisFrame);
+					imshow("Whole Scene", AnalysisFrame);
+				}
+				if (!userControl(1, showVideo)) break;  // The writer blocks while we linger.
+			}
+			cout << "Raw video input ended after " << frameNumber << " frames." << endl;
+			rawVideo.close();
+			continue;
+		}
+
+		if (liveMode){  // Analyze pairs as they arrive.  Frames that arrive faster than they can be analyzed are dropped, never queued up.
+			cout << "Analyzing live input from " + liveSource << endl;
+			double msec1, msec2;  // Presentation times of the pair
+			Mat AnalysisFrame;
+			frameNumber = 0;
+			while (liveStream.readPair(frame1, msec1, frame2, msec2)){
+				tracker.frame1 = frame1;  // Its date/time stamp goes into highlights.
+				tracker.differencePair(frame1, frame2, thresholdImage, AnalysisFrame);
+				if (showVideo)	imshow("Final Threshold Image", thresholdImage);
+				else cv::destroyWindow("Final Threshold Image");
+				bool watched = viewer.isWatched();  // Asked once per pair;  see publishPair().
+				if (watched) thresholdImage.copyTo(viewerMask);
+				objectDetected = tracker.manageMovers(thresholdImage, AnalysisFrame, frameNumber, msec1);  // Speeds are timed by msec, so dropped frames don't skew them.
+				publishPair(AnalysisFrame, objectDetected, watched);
+				frameNumber += 2;
+				if (showVideo){
+					tracker.drawAnnotations(AnalysisFrame);
+					imshow("Whole Scene", AnalysisFrame);
+				}
+				if (!userControl(1, showVideo)) break;  // Never linger on a detection: the source won't wait.
+			}
+			cout << "Live input ended.  " << liveStream.getFramesDropped() << " frames were dropped to keep up." << endl;
+			liveStream.close();
+			continue;
+		}
+
+		if (sweepPlease){  // Every configuration in the sweep sees this file, decoded just once (or not at all, from mask caches).
+			if (!sweep.processFile(FName, int(startFrame), maskCachePlease)) return -1;
+			continue;
+		}
+
+	// Open the video first, for its frame size and rate:  VST.cfg is fitted to them.
+		cout << "Trying to capture from " + FName << endl;
+		capture.open(FName);
+		if (!capture.isOpened()){
+			cout << "ERROR ACQUIRING VIDEO FEED\n";
+			getchar();
+			return -1;
+		}
+		tracker.configure(scaledFor(capture.getFrameWidth(), capture.getFrameHeight(), capture.getFPS()));
+		if (lanesPlease) laneTracks.scaleTo(int(capture.getFrameWidth()), int(capture.getFrameHeight()), capture.getFPS());
+		if (hiLiteSize.area() > 0){  // Every frame of a highlights file is the same size.
+			tracker.highLightsPlease = (Size(tracker.g.frameWidth, tracker.g.frameHeight) == hiLiteSize);
+			if (!tracker.highLightsPlease) cout << "Frame size differs from the highlights file's.  No highlights from this file." << endl;
+		}
+
+	// Masks from a matching cache need no decoding at all.  Highlights do need video, so they always come from a decoding run.
+		bool colorFrames = tracker.highLightsPlease && !tracker.deferHiLites;  // Deferred highlights need just the marks the tracker keeps.
+		bool masksFromCache = maskCachePlease && !colorFrames
+			&& maskCache.openForRead(FName, tracker.AnalysisBox, tracker.g.SENSITIVITY_VALUE, tracker.g.BLUR_SIZE, int(startFrame));
+		Mat AnalysisFrame;  // What the tracker draws on: the newer frame of each pair, or a blank frame when masks come from the cache.
+
+		if (masksFromCache){
+			capture.release();
+			cout << "Reading motion masks from " + MaskCache::pathFor(FName, tracker.g.SENSITIVITY_VALUE, tracker.g.BLUR_SIZE) << endl;
+			AnalysisFrame = Mat::zeros(tracker.AnalysisBox.size(), CV_8UC3);
+		}
+		else{
+			capture.setLumaRows(tracker.inputBox.y, tracker.inputBox.height);  // readLuma() returns just the AnalysisBox rows.
+			// Set frame number to start at, in first file to be processed;  Remaining files will start at zero.  Exact, via keyframe index.
+			if (resumedFile && startFrame > 0 && !capture.seekIsExact()){
+				cout << "Can't seek exactly to frame " << int(startFrame) << " of " << FName << " (no keyframe index).  Resume aborted." << endl;
+				return -1;
+			}
+			if (!capture.seek(int(startFrame))){
+				cout << "Can't seek to frame " << int(startFrame) << " of " << FName << "." << (resumedFile ? "  Resume aborted." : "  Aborting.") << endl;
+				return -1;
+			}
+			if (maskCachePlease) maskCache.openForWrite(FName, tracker.AnalysisBox, tracker.g.SENSITIVITY_VALUE, tracker.g.BLUR_SIZE, int(startFrame));
+		}
+		frameNumber = int(startFrame);
+		if (tracker.recordDetections && !detectionLog.openForRecord(FName.substr(0, FName.find_last_of('.')) + ".vsd", tracker.g)){
+			cout << "ERROR OPENING DETECTION LOG\n";
+			getchar();
+			return -1;
+		}
+		int delay = 10;   //at least 10ms delay is necessary for proper operation of this program <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		int pairsProcessed = 0;
+		int pairsProbedQuiet = 0;  // Pairs the motion probe found idle.
+		int probeMisses = 0;  // Of those, pairs in which the full pipeline found something (validation only).
+		int bandsBottom = lanesPlease ? laneTracks.getBandsBottom() : max(tracker.g.L2RStreetY, tracker.g.R2LStreetY);
+		Rect probeRegion(tracker.inputBox.x, tracker.inputBox.y, tracker.inputBox.width,  // Lane bands, plus what blurring can pull into them, in input pixels.
+			min(int((bandsBottom + tracker.g.BLUR_SIZE) / g.ProcessingScale) + 1, tracker.inputBox.height));
+		Rect lumaBox(tracker.inputBox.x, 0, tracker.inputBox.width, tracker.inputBox.height);  // AnalysisBox, in readLuma() rows
+		Rect lumaProbeRegion = probeRegion - Point(0, tracker.inputBox.y);
+		Mat luma1, luma2;  // AnalysisBox rows of each frame, when there are no highlights to make
+		Mat blankFrame = Mat::zeros(tracker.AnalysisBox.size(), CV_8UC3);  // Stands in for AnalysisFrame when nothing is shown;  never drawn on.
+		bool screened = screenPlease && !masksFromCache && !maskCache.isWriting()  // The cache needs every mask.
+			&& capture.seekIsExact() && motionScreen.screen(FName, probeRegion);  // Seeking near an active frame, not to it, would mislabel every frame after.
+		if (screened) cout << "Motion vectors show motion in " << motionScreen.getActiveFrames() << " of " << motionScreen.getFrameCount() << " frames." << endl;
+		int framesScreenedOut = 0;  // Frames sought past, never decoded
+		bool decodeFailed = false;  // The index promised frames the file doesn't have (truncated or damaged)
+		if (checkpointPlease) saveCheckpoint();  // startFile() emptied the tracker.
+
+		//work through frame pairs looking for differences
+		while (masksFromCache ? maskCache.read(frameNumber, thresholdImage)
+			: capture.getPosition() < capture.getFrameCount() - 2){ // minus 2 to prevent reading empty frame at end.
+			pairsProcessed++;
+			bool quiet = false;  // Did the motion probe find this pair idle?
+			bool watched = viewer.isWatched();  // Once per pair:  blankFrame must never be drawn on, so a viewer arriving mid pair waits for the next.
+			if (masksFromCache){
+				if (frameNumber < int(startFrame)) continue;
+				if (showVideo || watched) AnalysisFrame.setTo(Scalar(CVBlack));
+			}
+			else{
+				if (screened && allIdle()){  // Seek past an idle stretch, unless it's too short to be worth the seek.
+					int next = motionScreen.nextActive(capture.getPosition());
+					int from = capture.getPosition();
+					if (next >= capture.getFrameCount() - 2){  // Idle to the end of the file
+						framesScreenedOut += capture.getFrameCount() - from;
+						break;
+					}
+					if (next - from >= SCREEN_MIN_SKIP_FRAMES){
+						if (capture.seek(next)){
+							framesScreenedOut += next - from;
+							frameNumber = next;
+						}
+						else{  // Go on decoding every frame, from wherever the seek gave up.
+							cout << "<" << frameNumber << ">  Can't seek to frame " << next << ".  No more screening in this file." << endl;
+							screened = false;
+							frameNumber = capture.getPosition();
+						}
+					}
+				}
+				if (colorFrames){  // Highlights are in color.
+					decodeFailed = !capture.read(frame1) || !capture.read(frame2);
+					tracker.frame1 = frame1;  // Its date/time stamp goes into highlights.
+				}
+				else  // Otherwise luma is all that's needed, and only the AnalysisBox rows of it.
+					decodeFailed = !capture.readLuma(luma1) || !capture.readLuma(luma2);
+				if (decodeFailed){
+					cout << "<" << frameNumber << ">  Can't decode frame " << capture.getPosition() << " of " << capture.getFrameCount() << ".  Rest of file skipped." << endl;
+					break;
+				}
+				quiet = probePlease && !maskCache.isWriting() && allIdle() && (colorFrames
+					? quietPair(frame1, frame2, probeRegion, tracker.g.SENSITIVITY_VALUE) : quietPair(luma1, luma2, lumaProbeRegion, tracker.g.SENSITIVITY_VALUE));
+				if (quiet) pairsProbedQuiet++;
+				if (quiet && !validateProbe){  // Idle street: nothing for manageMovers() to do.
+					frameNumber += 2;
+					checkpointIfDue();
+					if (!showVideo && (pairsProcessed % 1000) != 0) continue;
+					if (!userControl(showVideo ? 10 : 1, showVideo)) return 0;
+					continue;
+				}
+				if (colorFrames) tracker.differencePair(frame1, frame2, thresholdImage, AnalysisFrame);
+				else{
+					tracker.differenceLuma(luma1, luma2, lumaBox, thresholdImage);
+					if (showVideo || watched)  // Shown in gray;  there's no color to show.
+						cv::cvtColor(atProcessingScale(luma2(lumaBox), tracker.AnalysisBox.size()), AnalysisFrame, COLOR_GRAY2BGR);
+					else AnalysisFrame = blankFrame;
+				}
+				if (maskCache.isWriting()) maskCache.write(frameNumber, thresholdImage);  // Before manageMovers(); findContours() alters the mask.
+			}
+
+			if (showVideo)	imshow("Final Threshold Image", thresholdImage);
+			else cv::destroyWindow("Final Threshold Image");
+			if (watched) thresholdImage.copyTo(viewerMask);
+
+		// ************************************************* Vehicle motion analysis *****************************************************
+			if (tracker.recordDetections) detectionLog.beginPair(frameNumber);
+			if (lanesPlease) objectDetected = laneTracks.manageMovers(thresholdImage, frameNumber);  // Every lane group, in parallel
+			else objectDetected = tracker.manageMovers(thresholdImage, AnalysisFrame, frameNumber);
+			if (tracker.recordDetections) detectionLog.endPair();
+			publishPair(AnalysisFrame, objectDetected, watched);
+			if (validateProbe && quiet && (objectDetected || !allIdle())){  // Skipping this pair would have changed the results.
+				probeMisses++;
+				cout << "<" << frameNumber << ">  Motion probe missed motion the full pipeline found." << endl;
+			}
+
+			frameNumber += 2;  // Note: frames are used in frame differencing operations only once each, so frame count jumps by two, not one.
+			                  // One could argue that using each frame as the second frame in a differencing operation, and then using it a second time
+			                  // as the first frame in the next differencing operation would increase resolution.  It probably would.  However,
+			                  // doubling frame differencing operations will increase processing times, and probably not add much to speed estimations quality.
+			                  // Look at the function computeFinalSpeed() in vehicleDynamics.cpp where I analyze distances of front bumper from the speed zone
+			                  // lines to decide whether or not to add or subtract one frame from the total number of frames a vehicle took to pass
+			                  // through the speed measuring zone.   I contend performing the +/-1 analysis brings back the accuracy that doubling frame
+			                  // differencing operations would provide, but at half the computational cost.
+			checkpointIfDue();
+
+			//show captured frame
+			if (showVideo){
+				drawAnnotations(AnalysisFrame);  // Only now are the tracker's lines, boxes and speeds drawn.
+				imshow("Whole Scene", AnalysisFrame);
+			}
+
+			if (!showVideo)
+				delay = 1;
+			else if (objectDetected) 
+				delay = objDelay;
+			else 
+				delay = 10;
+
+			if (masksFromCache && !showVideo && (pairsProcessed % 1000) != 0) continue;  // As in replay, waitKey() would dominate cached runs.
+			if (!userControl(delay, showVideo)) return 0;
+
+		} // main loop for processing one input file
+
+		if (probePlease) cout << "Motion probe found " << pairsProbedQuiet << " of " << pairsProcessed << " frame pairs idle"
+			<< (validateProbe ? ", missing motion in " + intToString(probeMisses) + " of them." : ".") << endl;
+		if (screened) cout << "Motion vector screening skipped " << framesScreenedOut << " of " << motionScreen.getFrameCount() << " frames." << endl;
+		capture.release();
+		if (!decodeFailed) maskCache.finish();  // Reached the end of the file, so a cache being written is complete.
+		maskCache.close();
+		if (tracker.recordDetections) detectionLog.close();
+
+	} // looping over input files loop end
+
+//	if (highLightsPlease) hiLiteVideo.release();
+	if (sweepPlease) sweep.report(g.dataPathPrefix + "\\stats\\sweep_" + runName + ".csv");
+	if (lanesPlease) laneTracks.close();
+	if (tracker.pleaseTrace) tracker.traceFile.close();
+	if (hiLiteSize.area() > 0) tracker.closeHiLites();
+	tracker.finishFile();
+	tracker.statsFile.close();
+	if (checkpointPlease) remove(checkpointPath().c_str());  // Finished;  nothing to resume.
+	viewer.close();  // The viewer sees the run is over.
+	return 0;
+
+}
+